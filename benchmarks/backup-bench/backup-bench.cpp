@@ -0,0 +1,408 @@
+/*
+ * Standalone benchmark for the backup/restore pipeline.
+ *
+ * Generates a synthetic OBS config tree, then times each phase of a backup and
+ * a restore over it with the plugin's real Zip::Writer and Zip::Reader, and
+ * prints a JSON report. Run it before and after a change to the pipeline and
+ * diff the reports.
+ *
+ * EstimateBackup, CreateBackup and the Restore functions resolve their paths
+ * through the OBS frontend and settings, which do not exist outside a running
+ * OBS. The phases here hand the generated tree to the OBS-free cores those
+ * functions are built on instead: backup-archive.cpp for the walk, the media
+ * scan and the archive itself, restore-staging.cpp for the extract, checksum
+ * and replace per file, and backup-tree.cpp for what is left out and the reuse
+ * decision. Only the safety backup, the journal and the media path rewrite are
+ * not timed.
+ */
+
+#include "obs-tree-generator.hpp"
+#include "backup-archive.hpp"
+#include "backup-tree.hpp"
+#include "restore-staging.hpp"
+#include "zip-reader.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <cstdio>
+#include <functional>
+
+using namespace StreamUP;
+
+namespace {
+
+using FileList = QList<QPair<QString, QString>>;
+
+struct PhaseResult {
+	QString name;
+	qint64 elapsedMs = 0;
+	int files = 0;
+	qint64 bytes = 0;
+	bool ok = true;
+	QString error;
+
+	QJsonObject toJson() const
+	{
+		QJsonObject o;
+		o[QStringLiteral("name")] = name;
+		o[QStringLiteral("ms")] = elapsedMs;
+		o[QStringLiteral("files")] = files;
+		o[QStringLiteral("bytes")] = bytes;
+		o[QStringLiteral("mb_per_s")] =
+			elapsedMs > 0 ? (bytes / (1024.0 * 1024.0)) / (elapsedMs / 1000.0) : 0.0;
+		o[QStringLiteral("ok")] = ok;
+		if (!error.isEmpty())
+			o[QStringLiteral("error")] = error;
+		return o;
+	}
+};
+
+PhaseResult timePhase(const QString &name, const std::function<void(PhaseResult &)> &body)
+{
+	PhaseResult result;
+	result.name = name;
+	QElapsedTimer timer;
+	timer.start();
+	body(result);
+	result.elapsedMs = timer.elapsed();
+	return result;
+}
+
+/** The generated tree as ResolveLocations would report it. */
+Backup::Locations locationsOf(const Bench::GeneratedTree &tree)
+{
+	Backup::Locations loc;
+	loc.configDir = tree.configDir;
+	loc.profilesDir = tree.profilesDir;
+	loc.scenesDir = tree.scenesDir;
+	loc.pluginConfigDir = tree.pluginConfigDir;
+	return loc;
+}
+
+FileList configFiles(const Backup::Locations &loc, const Backup::Options &options)
+{
+	FileList files;
+	Backup::CollectConfigFiles(loc, options, files);
+	return files;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setApplicationName(QStringLiteral("streamup-backup-bench"));
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription(QStringLiteral("Times the StreamUP backup and restore pipeline over a "
+							"generated OBS config tree."));
+	parser.addHelpOption();
+
+	const Bench::TreeSpec defaults;
+	auto intOption = [&parser](const QString &name, const QString &help, qint64 value) {
+		QCommandLineOption option(name, help, QStringLiteral("n"), QString::number(value));
+		parser.addOption(option);
+		return option;
+	};
+	const QCommandLineOption profiles = intOption(QStringLiteral("profiles"), QStringLiteral("Profiles"),
+						      defaults.profiles);
+	const QCommandLineOption collections = intOption(QStringLiteral("collections"),
+							 QStringLiteral("Scene collections"), defaults.sceneCollections);
+	const QCommandLineOption scenes = intOption(QStringLiteral("scenes"), QStringLiteral("Scenes per collection"),
+						    defaults.scenesPerCollection);
+	const QCommandLineOption sources = intOption(QStringLiteral("sources"), QStringLiteral("Sources per scene"),
+						     defaults.sourcesPerScene);
+	const QCommandLineOption pluginFiles = intOption(QStringLiteral("plugin-files"),
+							 QStringLiteral("Files under plugin_config"),
+							 defaults.pluginConfigFiles);
+	const QCommandLineOption media = intOption(QStringLiteral("media"), QStringLiteral("Media files"),
+						   defaults.mediaFiles);
+	const QCommandLineOption mediaKb = intOption(QStringLiteral("media-kb"),
+						     QStringLiteral("Average media file size in KB"),
+						     defaults.mediaBytes / 1024);
+	const QCommandLineOption compressible(QStringLiteral("compressible"),
+					      QStringLiteral("Fraction of media that compresses well (0-1)"),
+					      QStringLiteral("share"), QString::number(defaults.compressibleShare));
+	parser.addOption(compressible);
+	const QCommandLineOption seed = intOption(QStringLiteral("seed"), QStringLiteral("Generator seed"),
+						  defaults.seed);
+	const QCommandLineOption workDir(QStringLiteral("work-dir"),
+					 QStringLiteral("Where to generate the tree (default: a temporary folder)"),
+					 QStringLiteral("path"));
+	parser.addOption(workDir);
+	const QCommandLineOption out(QStringLiteral("out"), QStringLiteral("Write the JSON report here as well"),
+				     QStringLiteral("path"));
+	parser.addOption(out);
+	parser.process(app);
+
+	Bench::TreeSpec spec;
+	spec.profiles = parser.value(profiles).toInt();
+	spec.sceneCollections = parser.value(collections).toInt();
+	spec.scenesPerCollection = parser.value(scenes).toInt();
+	spec.sourcesPerScene = parser.value(sources).toInt();
+	spec.pluginConfigFiles = parser.value(pluginFiles).toInt();
+	spec.mediaFiles = parser.value(media).toInt();
+	spec.mediaBytes = parser.value(mediaKb).toLongLong() * 1024;
+	spec.compressibleShare = qBound(0.0, parser.value(compressible).toDouble(), 1.0);
+	spec.seed = parser.value(seed).toUInt();
+
+	QTemporaryDir temp;
+	// Absolute, because the media scan only follows absolute paths, as OBS writes them
+	const QString root = parser.isSet(workDir) ? QDir(parser.value(workDir)).absolutePath() : temp.path();
+	if (root.isEmpty()) {
+		std::fprintf(stderr, "Could not create a working folder\n");
+		return 1;
+	}
+
+	QElapsedTimer generateTimer;
+	generateTimer.start();
+	const Bench::GeneratedTree tree = Bench::GenerateObsTree(root + QStringLiteral("/source"), spec);
+	const qint64 generateMs = generateTimer.elapsed();
+
+	const QString archivePath = root + QStringLiteral("/bench-backup.zip");
+	const QString staging = root + QStringLiteral("/staging");
+	const QString target = root + QStringLiteral("/restored");
+	QList<PhaseResult> phases;
+	QJsonArray plan;
+
+	const Backup::Locations loc = locationsOf(tree);
+	Backup::Options options;
+	options.collectMedia = true;
+
+	// EstimateBackup: walk and stat every config file, then parse every scene
+	// collection for the media it references.
+	phases << timePhase(QStringLiteral("estimate"), [&](PhaseResult &r) {
+		const Backup::Estimate estimate = Backup::EstimateTree(loc, options);
+		r.files = estimate.fileCount;
+		r.bytes = estimate.totalBytes;
+	});
+
+	// CreateBackup with media collected: the same walk and scan, every file
+	// through WriteArchive, a manifest, then the structural verify.
+	phases << timePhase(QStringLiteral("create"), [&](PhaseResult &r) {
+		FileList files = configFiles(loc, options);
+		for (const auto &entry : files) {
+			if (tree.excludedFiles.contains(entry.first)) {
+				r.ok = false;
+				r.error = QStringLiteral("%1 is not configuration but was collected").arg(entry.second);
+				return;
+			}
+		}
+		for (const Backup::MediaReference &ref : Backup::ScanMediaReferences(loc)) {
+			if (ref.exists)
+				files.append({ref.path, ref.archiveName});
+		}
+
+		QJsonObject manifest;
+		manifest[QStringLiteral("format")] = 1;
+		manifest[QStringLiteral("created")] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+		const Backup::ArchiveWritten written = Backup::WriteArchive(archivePath, files, manifest, options);
+		if (!written.success || !written.unreadable.isEmpty()) {
+			r.ok = false;
+			r.error = written.success ? QStringLiteral("Could not read %1").arg(written.unreadable.first().first)
+						  : written.error;
+			return;
+		}
+		r.files = written.fileCount;
+		for (const auto &entry : files)
+			r.bytes += QFileInfo(entry.first).size();
+	});
+
+	// Restore::Inspect: open, read the manifest, classify every entry.
+	phases << timePhase(QStringLiteral("inspect"), [&](PhaseResult &r) {
+		Zip::Reader reader;
+		if (!reader.open(archivePath)) {
+			r.ok = false;
+			r.error = reader.lastError();
+			return;
+		}
+		const QJsonObject manifest =
+			QJsonDocument::fromJson(reader.readFile(QStringLiteral("streamup-backup.json"))).object();
+		r.ok = manifest.contains(QStringLiteral("format"));
+
+		// The same prefix tests Inspect runs to build its per-area counts.
+		QMap<QByteArray, int> areas;
+		for (int i = 0; i < reader.entryCount(); ++i) {
+			const QByteArrayView name = reader.entryNameBytes(i);
+			for (const char *prefix : {"config/basic/scenes/", "config/basic/profiles/", "config/plugin_config/",
+						   "themes/", "media/"}) {
+				if (name.startsWith(prefix)) {
+					areas[prefix]++;
+					break;
+				}
+			}
+			r.files++;
+		}
+		r.bytes = QFileInfo(archivePath).size();
+	});
+
+	// Restore::Stage, minus the safety backup (that is the create phase) and
+	// the media path rewrite: extract every entry to staging and checksum it
+	// for the journal.
+	phases << timePhase(QStringLiteral("stage"), [&](PhaseResult &r) {
+		QDir(staging).removeRecursively();
+		Zip::Reader reader;
+		if (!reader.open(archivePath)) {
+			r.ok = false;
+			r.error = reader.lastError();
+			return;
+		}
+		const bool extracted = Restore::ExtractToStaging(
+			reader, staging, [&](const QString &name) -> QString { return target + QStringLiteral("/") + name; }, nullptr,
+			plan, &r.error);
+		if (!extracted) {
+			r.ok = false;
+			return;
+		}
+		r.files = plan.size();
+		for (int i = 0; i < reader.entryCount(); ++i) {
+			if (reader.entryName(i) != QStringLiteral("streamup-backup.json"))
+				r.bytes += static_cast<qint64>(reader.entryAt(i).uncompressedSize);
+		}
+	});
+
+	// Restore::ApplyPending: copy beside the target, then swap it in.
+	phases << timePhase(QStringLiteral("apply"), [&](PhaseResult &r) {
+		QDir(target).removeRecursively();
+		for (const QJsonValue value : plan) {
+			const QJsonObject item = value.toObject();
+			const QString dest = item.value(QStringLiteral("target")).toString();
+			QString applyError;
+			const Restore::ApplyOutcome outcome =
+				Restore::ApplyStagedFile(item.value(QStringLiteral("staged")).toString(), dest,
+							 item.value(QStringLiteral("sha1")).toString(), &applyError);
+			if (outcome == Restore::ApplyOutcome::Failed) {
+				r.ok = false;
+				r.error = QStringLiteral("Could not restore %1: %2").arg(dest, applyError);
+				return;
+			}
+			r.files++;
+			r.bytes += QFileInfo(dest).size();
+		}
+	});
+
+	// The deep verification automatic backups get on the next launch.
+	phases << timePhase(QStringLiteral("verify_deep"), [&](PhaseResult &r) {
+		const Zip::DeepVerifyResult deep = Zip::VerifyArchiveDeep(archivePath);
+		r.ok = deep.success;
+		r.error = deep.error;
+		r.files = deep.entriesChecked;
+		r.bytes = deep.bytesInflated;
+	});
+
+	// Restore::Stage straight after an automatic backup: the automatic backup
+	// records itself in our configs.json and OBS saves the scene collections
+	// again before the restore, and neither may stop the archive from standing
+	// in for the safety backup. A real settings change must. This is a check
+	// as much as a timing: the phase fails if the reuse decision is wrong.
+	phases << timePhase(QStringLiteral("reuse_check"), [&](PhaseResult &r) {
+		const QString autoPath = root + QStringLiteral("/bench-auto.zip");
+		const QString ownName = QStringLiteral("config/plugin_config/streamup/configs.json");
+		Backup::Options reuseOptions;
+		reuseOptions.includeCredentials = true;
+
+		const FileList files = configFiles(loc, reuseOptions);
+		QJsonObject manifest;
+		manifest[QStringLiteral("format")] = 1;
+		manifest[QStringLiteral("config_fingerprint")] = Backup::FingerprintFiles(files, reuseOptions, ownName);
+		manifest[QStringLiteral("options_fingerprint")] = Backup::OptionsFingerprint(reuseOptions);
+		const Backup::ArchiveWritten written = Backup::WriteArchive(autoPath, files, manifest, reuseOptions);
+		if (!written.success) {
+			r.ok = false;
+			r.error = written.error;
+			return;
+		}
+
+		auto rewriteJson = [](const QString &path, const std::function<void(QJsonObject &)> &edit) {
+			QFile file(path);
+			if (!file.open(QIODevice::ReadWrite))
+				return;
+			QJsonObject object = QJsonDocument::fromJson(file.readAll()).object();
+			edit(object);
+			file.resize(0);
+			file.write(QJsonDocument(object).toJson(QJsonDocument::Indented));
+		};
+		auto matches = [&]() {
+			Zip::Reader reader;
+			if (!reader.open(autoPath))
+				return false;
+			const QJsonObject recorded =
+				QJsonDocument::fromJson(reader.readFile(QStringLiteral("streamup-backup.json"))).object();
+			r.files += reader.entryCount();
+			return Backup::ArchiveMatchesTree(configFiles(loc, reuseOptions), reuseOptions, ownName, reader,
+							  recorded, QFileInfo(autoPath).lastModified());
+		};
+
+		// What RunAutomaticBackupIfDue and the pre-restore save do
+		rewriteJson(tree.ownSettingsPath, [&](QJsonObject &o) {
+			o[QStringLiteral("backup_last_auto")] = QDate::currentDate().toString(Qt::ISODate);
+			o[QStringLiteral("backup_pending_verify")] = autoPath;
+		});
+		const QString collection = tree.scenesDir + QStringLiteral("/Collection 1.json");
+		rewriteJson(collection, [](QJsonObject &) {});
+		if (!matches()) {
+			r.ok = false;
+			r.error = QStringLiteral("Unchanged config was not reused after the automatic backup recorded itself");
+			return;
+		}
+
+		rewriteJson(tree.ownSettingsPath, [](QJsonObject &o) { o[QStringLiteral("backup_keep_count")] = 3; });
+		if (matches()) {
+			r.ok = false;
+			r.error = QStringLiteral("A changed setting was taken as unchanged");
+		}
+		r.bytes = QFileInfo(autoPath).size();
+	});
+
+	QJsonObject specJson;
+	specJson[QStringLiteral("profiles")] = spec.profiles;
+	specJson[QStringLiteral("scene_collections")] = spec.sceneCollections;
+	specJson[QStringLiteral("scenes_per_collection")] = spec.scenesPerCollection;
+	specJson[QStringLiteral("sources_per_scene")] = spec.sourcesPerScene;
+	specJson[QStringLiteral("plugin_config_files")] = spec.pluginConfigFiles;
+	specJson[QStringLiteral("media_files")] = spec.mediaFiles;
+	specJson[QStringLiteral("media_bytes")] = spec.mediaBytes;
+	specJson[QStringLiteral("compressible_share")] = spec.compressibleShare;
+	specJson[QStringLiteral("seed")] = static_cast<qint64>(spec.seed);
+
+	QJsonObject treeJson;
+	treeJson[QStringLiteral("files")] = tree.fileCount;
+	treeJson[QStringLiteral("bytes")] = tree.totalBytes;
+	treeJson[QStringLiteral("generate_ms")] = generateMs;
+
+	QJsonArray phaseArray;
+	bool allOk = true;
+	for (const PhaseResult &phase : phases) {
+		phaseArray.append(phase.toJson());
+		allOk = allOk && phase.ok;
+	}
+
+	QJsonObject report;
+	report[QStringLiteral("spec")] = specJson;
+	report[QStringLiteral("tree")] = treeJson;
+	report[QStringLiteral("archive_bytes")] = QFileInfo(archivePath).size();
+	report[QStringLiteral("phases")] = phaseArray;
+
+	const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+	QTextStream(stdout) << json;
+	if (parser.isSet(out)) {
+		QFile file(parser.value(out));
+		if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+			file.write(json);
+	}
+
+	return allOk ? 0 : 2;
+}
@@ -0,0 +1,224 @@
+#include "obs-tree-generator.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+
+namespace StreamUP {
+namespace Bench {
+
+namespace {
+
+const QStringList kMediaKinds = {QStringLiteral("png"), QStringLiteral("mp4"), QStringLiteral("wav"),
+				 QStringLiteral("ttf"), QStringLiteral("html")};
+
+bool writeFile(const QString &path, const QByteArray &data, GeneratedTree &tree)
+{
+	QDir().mkpath(QFileInfo(path).absolutePath());
+	QFile f(path);
+	if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	const bool ok = f.write(data) == data.size();
+	f.close();
+	if (ok) {
+		tree.fileCount++;
+		tree.totalBytes += data.size();
+	}
+	return ok;
+}
+
+/**
+ * Media content. Compressible files repeat a short phrase, the way an html
+ * overlay or an uncompressed wav of silence would; the rest is random, the way
+ * an already-encoded video or png is.
+ */
+QByteArray mediaBytes(qint64 size, bool compressible, QRandomGenerator &rng)
+{
+	QByteArray data(static_cast<qsizetype>(size), Qt::Uninitialized);
+	if (compressible) {
+		static const QByteArray phrase = QByteArrayLiteral("<div class=\"overlay\">StreamUP</div>\n");
+		for (qsizetype i = 0; i < data.size(); ++i)
+			data[i] = phrase[i % phrase.size()];
+	} else {
+		rng.fillRange(reinterpret_cast<quint32 *>(data.data()), data.size() / 4);
+		for (qsizetype i = data.size() & ~qsizetype(3); i < data.size(); ++i)
+			data[i] = 0;
+	}
+	return data;
+}
+
+QJsonObject sourceJson(const QString &name, const QString &id, const QJsonObject &settings)
+{
+	QJsonObject source;
+	source[QStringLiteral("name")] = name;
+	source[QStringLiteral("id")] = id;
+	source[QStringLiteral("versioned_id")] = id;
+	source[QStringLiteral("uuid")] = QStringLiteral("%1-uuid").arg(name);
+	source[QStringLiteral("settings")] = settings;
+	source[QStringLiteral("enabled")] = true;
+	source[QStringLiteral("volume")] = 1.0;
+	source[QStringLiteral("filters")] = QJsonArray();
+	return source;
+}
+
+} // namespace
+
+GeneratedTree GenerateObsTree(const QString &root, const TreeSpec &spec)
+{
+	GeneratedTree tree;
+	tree.root = QDir::cleanPath(root);
+	tree.configDir = tree.root + QStringLiteral("/obs-studio");
+	tree.profilesDir = tree.configDir + QStringLiteral("/basic/profiles");
+	tree.scenesDir = tree.configDir + QStringLiteral("/basic/scenes");
+	tree.pluginConfigDir = tree.configDir + QStringLiteral("/plugin_config");
+	tree.mediaDir = tree.root + QStringLiteral("/media");
+
+	QRandomGenerator rng(spec.seed);
+
+	writeFile(tree.configDir + QStringLiteral("/global.ini"),
+		  QByteArrayLiteral("[General]\nPre31Migrated=true\n\n[Locations]\n"), tree);
+	writeFile(tree.configDir + QStringLiteral("/user.ini"),
+		  QByteArrayLiteral("[General]\nFirstRun=true\nCurrentTheme3=com.obsproject.Yami.Original\n"), tree);
+
+	for (int p = 0; p < spec.profiles; ++p) {
+		const QString dir = tree.profilesDir + QStringLiteral("/Profile %1").arg(p + 1);
+		writeFile(dir + QStringLiteral("/basic.ini"),
+			  QStringLiteral("[General]\nName=Profile %1\n\n[Video]\nBaseCX=1920\nBaseCY=1080\n"
+					 "OutputCX=1920\nOutputCY=1080\nFPSCommon=60\n\n[Output]\nMode=Advanced\n")
+				  .arg(p + 1)
+				  .toUtf8(),
+			  tree);
+		writeFile(dir + QStringLiteral("/service.json"),
+			  QByteArrayLiteral("{\"type\":\"rtmp_common\",\"settings\":{\"service\":\"Twitch\","
+					    "\"server\":\"auto\",\"key\":\"live_000000000_benchmark\"}}"),
+			  tree);
+		writeFile(dir + QStringLiteral("/streamEncoder.json"),
+			  QByteArrayLiteral("{\"bitrate\":6000,\"keyint_sec\":2,\"rate_control\":\"CBR\"}"), tree);
+	}
+
+	// Media first, so collections can point at files that exist.
+	QStringList mediaPaths;
+	for (int m = 0; m < spec.mediaFiles; ++m) {
+		const QString kind = kMediaKinds[m % kMediaKinds.size()];
+		const QString path = tree.mediaDir + QStringLiteral("/%1/asset-%2.%1").arg(kind).arg(m);
+		// Spread sizes between half and one and a half times the average so
+		// per-file overhead and throughput both show up.
+		const qint64 size = qMax<qint64>(16, spec.mediaBytes / 2 + rng.bounded(qMax<qint64>(1, spec.mediaBytes)));
+		const bool compressible = rng.generateDouble() < spec.compressibleShare;
+		writeFile(path, mediaBytes(size, compressible, rng), tree);
+		mediaPaths << path;
+	}
+
+	for (int c = 0; c < spec.sceneCollections; ++c) {
+		QJsonArray sources;
+		QJsonArray sceneOrder;
+		int mediaCursor = c;
+
+		for (int s = 0; s < spec.scenesPerCollection; ++s) {
+			const QString sceneName = QStringLiteral("Scene %1").arg(s + 1);
+			QJsonArray items;
+
+			for (int i = 0; i < spec.sourcesPerScene; ++i) {
+				const QString sourceName = QStringLiteral("C%1 S%2 Source %3").arg(c).arg(s).arg(i);
+				QJsonObject settings;
+				QString id = QStringLiteral("color_source_v3");
+				// One source in three points at media, spread over the keys
+				// real sources use so the scan walks every shape.
+				if (!mediaPaths.isEmpty() && i % 3 == 0) {
+					const QString path = mediaPaths[mediaCursor++ % mediaPaths.size()];
+					if (path.endsWith(QStringLiteral(".mp4"))) {
+						id = QStringLiteral("ffmpeg_source");
+						settings[QStringLiteral("local_file")] = path;
+					} else if (path.endsWith(QStringLiteral(".html"))) {
+						id = QStringLiteral("browser_source");
+						settings[QStringLiteral("local_file")] = path;
+						settings[QStringLiteral("is_local_file")] = true;
+					} else {
+						id = QStringLiteral("image_source");
+						settings[QStringLiteral("file")] = path;
+					}
+				} else {
+					settings[QStringLiteral("color")] = static_cast<qint64>(rng.generate());
+					settings[QStringLiteral("width")] = 1920;
+					settings[QStringLiteral("height")] = 1080;
+				}
+				sources.append(sourceJson(sourceName, id, settings));
+
+				QJsonObject item;
+				item[QStringLiteral("name")] = sourceName;
+				item[QStringLiteral("id")] = i + 1;
+				item[QStringLiteral("visible")] = true;
+				item[QStringLiteral("locked")] = false;
+				items.append(item);
+			}
+
+			QJsonObject sceneSettings;
+			sceneSettings[QStringLiteral("items")] = items;
+			sceneSettings[QStringLiteral("id_counter")] = spec.sourcesPerScene;
+			sources.append(sourceJson(sceneName, QStringLiteral("scene"), sceneSettings));
+
+			QJsonObject order;
+			order[QStringLiteral("name")] = sceneName;
+			sceneOrder.append(order);
+		}
+
+		QJsonObject collection;
+		collection[QStringLiteral("name")] = QStringLiteral("Collection %1").arg(c + 1);
+		collection[QStringLiteral("current_scene")] = QStringLiteral("Scene 1");
+		collection[QStringLiteral("current_program_scene")] = QStringLiteral("Scene 1");
+		collection[QStringLiteral("scene_order")] = sceneOrder;
+		collection[QStringLiteral("sources")] = sources;
+		writeFile(tree.scenesDir + QStringLiteral("/Collection %1.json").arg(c + 1),
+			  QJsonDocument(collection).toJson(QJsonDocument::Indented), tree);
+	}
+
+	// Plugin config: many small settings files spread over a few plugin
+	// folders, which is what stresses per-file overhead in the archive.
+	for (int f = 0; f < spec.pluginConfigFiles; ++f) {
+		const int plugin = f % qMax(1, spec.pluginFolders);
+		QJsonObject settings;
+		settings[QStringLiteral("index")] = f;
+		settings[QStringLiteral("enabled")] = (f % 2) == 0;
+		settings[QStringLiteral("label")] = QStringLiteral("Setting %1 for plugin %2").arg(f).arg(plugin);
+		writeFile(tree.pluginConfigDir + QStringLiteral("/plugin-%1/settings-%2.json").arg(plugin).arg(f),
+			  QJsonDocument(settings).toJson(QJsonDocument::Compact), tree);
+	}
+
+	// StreamUP's own settings, including the keys the automatic backup
+	// rewrites after each archive, for the reuse check.
+	tree.ownSettingsPath = tree.pluginConfigDir + QStringLiteral("/streamup/configs.json");
+	QJsonObject ownSettings;
+	ownSettings[QStringLiteral("backup_automatic")] = true;
+	ownSettings[QStringLiteral("backup_keep_count")] = 7;
+	ownSettings[QStringLiteral("backup_last_auto")] = QString();
+	ownSettings[QStringLiteral("backup_pending_verify")] = QString();
+	writeFile(tree.ownSettingsPath, QJsonDocument(ownSettings).toJson(QJsonDocument::Indented), tree);
+
+	// Browser cache lives under plugin_config in every real install and is
+	// excluded from backups; a little of it here proves the exclusion holds.
+	for (int f = 0; f < 20; ++f) {
+		const QString path =
+			tree.pluginConfigDir + QStringLiteral("/obs-browser/Cache/f_%1").arg(f, 6, 10, QLatin1Char('0'));
+		writeFile(path, mediaBytes(8 * 1024, false, rng), tree);
+		tree.excludedFiles << path;
+	}
+
+	// So is runtime state: a plugin's sentinel and lock files, and the .bak
+	// OBS leaves beside a scene collection.
+	for (const QString &path : {tree.pluginConfigDir + QStringLiteral("/plugin-0/.running"),
+				    tree.pluginConfigDir + QStringLiteral("/plugin-1/.lock"),
+				    tree.pluginConfigDir + QStringLiteral("/plugin-1/settings.lock"),
+				    tree.scenesDir + QStringLiteral("/Collection 1.json.bak")}) {
+		writeFile(path, QByteArray("1"), tree);
+		tree.excludedFiles << path;
+	}
+
+	return tree;
+}
+
+} // namespace Bench
+} // namespace StreamUP
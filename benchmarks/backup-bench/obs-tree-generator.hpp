@@ -0,0 +1,53 @@
+#ifndef STREAMUP_OBS_TREE_GENERATOR_HPP
+#define STREAMUP_OBS_TREE_GENERATOR_HPP
+
+#include <QString>
+#include <QStringList>
+
+namespace StreamUP {
+namespace Bench {
+
+/**
+ * Shape of a synthetic OBS configuration tree. The defaults are a mid-sized
+ * real install: a few profiles, a handful of busy scene collections, a plugin
+ * folder full of small files, and a couple of hundred media files.
+ */
+struct TreeSpec {
+	int profiles = 3;
+	int sceneCollections = 5;
+	int scenesPerCollection = 40;
+	int sourcesPerScene = 25;
+	int pluginConfigFiles = 2000;
+	int pluginFolders = 25;
+	int mediaFiles = 200;
+	qint64 mediaBytes = 256 * 1024; // average size per media file
+	double compressibleShare = 0.5; // fraction of media that deflates well
+	quint32 seed = 1;
+};
+
+/** Where the generated tree landed and how big it is. */
+struct GeneratedTree {
+	QString root;         // holds obs-studio/ and media/
+	QString configDir;    // root/obs-studio
+	QString profilesDir;  // configDir/basic/profiles
+	QString scenesDir;    // configDir/basic/scenes
+	QString pluginConfigDir;
+	QString ownSettingsPath; // StreamUP's configs.json under pluginConfigDir
+	QStringList excludedFiles; // written, but not configuration: no backup may hold them
+	QString mediaDir;
+	int fileCount = 0;
+	qint64 totalBytes = 0;
+};
+
+/**
+ * Write a tree laid out the way OBS lays out its config folder, under `root`.
+ * Scene collections reference the generated media through the same settings
+ * keys real sources use, so a media scan finds them. Deterministic for a given
+ * spec and seed, so two runs measure the same work.
+ */
+GeneratedTree GenerateObsTree(const QString &root, const TreeSpec &spec);
+
+} // namespace Bench
+} // namespace StreamUP
+
+#endif // STREAMUP_OBS_TREE_GENERATOR_HPP
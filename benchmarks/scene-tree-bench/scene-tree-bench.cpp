@@ -0,0 +1,292 @@
+/*
+ * Standalone benchmark for the scene organiser's tree.
+ *
+ * Builds a synthetic collection of scenes in folders out of the same node
+ * classes the dock uses (scene-tree-node.cpp), then times what the dock does to
+ * it on a large collection: building the tree, toggling icons, a program scene
+ * switch, hiding scenes from the locked dock, sorting and a search. Where the
+ * dock used to do something per item, the old way is timed next to the new one
+ * so the two can be compared in one report.
+ *
+ * SceneFolderItem and SceneTreeItem hold OBS weak references and cannot be
+ * created outside OBS; the BenchFolder and BenchScene items below carry only
+ * what the phases read. When the dock's refresh or search changes, change the
+ * matching phase here too.
+ */
+
+#include "scene-tree-node.hpp"
+
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPixmap>
+#include <QStringList>
+#include <QTextStream>
+
+#include <functional>
+
+using namespace StreamUP::SceneOrganiser;
+
+namespace {
+
+class BenchFolder : public SceneNodeItem {
+public:
+	explicit BenchFolder(const QString &name) : SceneNodeItem(name) {}
+	int type() const override { return SceneFolderItemType; }
+};
+
+class BenchScene : public SceneNodeItem {
+public:
+	explicit BenchScene(const QString &name) : SceneNodeItem(name) {}
+	int type() const override { return SceneItemType; }
+};
+
+struct PhaseResult {
+	QString name;
+	qint64 elapsedUs = 0;
+	int items = 0;
+	bool ok = true;
+	QString error;
+
+	QJsonObject toJson() const
+	{
+		QJsonObject o;
+		o[QStringLiteral("name")] = name;
+		o[QStringLiteral("us")] = elapsedUs;
+		o[QStringLiteral("items")] = items;
+		o[QStringLiteral("ok")] = ok;
+		if (!error.isEmpty())
+			o[QStringLiteral("error")] = error;
+		return o;
+	}
+};
+
+PhaseResult timePhase(const QString &name, const std::function<void(PhaseResult &)> &body)
+{
+	PhaseResult result;
+	result.name = name;
+	QElapsedTimer timer;
+	timer.start();
+	body(result);
+	result.elapsedUs = timer.nsecsElapsed() / 1000;
+	return result;
+}
+
+QIcon solidIcon(const QColor &color)
+{
+	QPixmap pixmap(16, 16);
+	pixmap.fill(color);
+	return QIcon(pixmap);
+}
+
+// Visits every item below `parent`, folders before their children.
+void forEachItem(QStandardItem *parent, const std::function<void(QStandardItem *)> &fn)
+{
+	for (int row = 0; row < parent->rowCount(); ++row) {
+		QStandardItem *child = parent->child(row);
+		fn(child);
+		if (child->hasChildren())
+			forEachItem(child, fn);
+	}
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	// Icons need a GUI application but never a display
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	QGuiApplication app(argc, argv);
+	QGuiApplication::setApplicationName(QStringLiteral("streamup-scene-tree-bench"));
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription(QStringLiteral("Times the StreamUP scene organiser tree over a generated "
+							"scene collection."));
+	parser.addHelpOption();
+
+	auto intOption = [&parser](const QString &name, const QString &help, int value) {
+		QCommandLineOption option(name, help, QStringLiteral("n"), QString::number(value));
+		parser.addOption(option);
+		return option;
+	};
+	const QCommandLineOption scenesOpt = intOption(QStringLiteral("scenes"), QStringLiteral("Scenes"), 2000);
+	const QCommandLineOption foldersOpt = intOption(QStringLiteral("folders"), QStringLiteral("Folders"), 100);
+	const QCommandLineOption out(QStringLiteral("out"), QStringLiteral("Also write the JSON report here"),
+				     QStringLiteral("file"));
+	parser.addOption(out);
+	parser.process(app);
+
+	const int sceneCount = qMax(1, parser.value(scenesOpt).toInt());
+	const int folderCount = qMax(0, parser.value(foldersOpt).toInt());
+
+	SceneNodeModel model;
+	SceneNodeModel::NodeStyle style;
+	style.folderIcon = solidIcon(Qt::darkYellow);
+	style.sceneIcon = solidIcon(Qt::darkCyan);
+	model.setNodeStyle(style);
+
+	QList<PhaseResult> phases;
+	QList<BenchScene *> scenes;
+	scenes.reserve(sceneCount);
+
+	// Build the tree the way updateTree does on a collection change: folders
+	// first, then scenes spread across them, a few left at the root.
+	phases << timePhase(QStringLiteral("build"), [&](PhaseResult &r) {
+		QList<BenchFolder *> folders;
+		for (int i = 0; i < folderCount; ++i) {
+			auto *folder = new BenchFolder(QStringLiteral("Folder %1").arg(i));
+			model.invisibleRootItem()->appendRow(folder);
+			folders.append(folder);
+		}
+		for (int i = 0; i < sceneCount; ++i) {
+			const QString kind = i % 7 ? QStringLiteral("Game") : QStringLiteral("Chat");
+			auto *scene = new BenchScene(QStringLiteral("Scene %1 - %2").arg(i).arg(kind));
+			if (folders.isEmpty() || i % 10 == 0)
+				model.invisibleRootItem()->appendRow(scene);
+			else
+				folders[i % folders.size()]->appendRow(scene);
+			scenes.append(scene);
+		}
+		r.items = sceneCount + folderCount;
+	});
+
+	// What an icon toggle cost before: setIcon on every node, one dataChanged each
+	phases << timePhase(QStringLiteral("icons_per_item"), [&](PhaseResult &r) {
+		QStandardItemModel plain;
+		for (int i = 0; i < sceneCount; ++i)
+			plain.appendRow(new QStandardItem(QStringLiteral("Scene %1").arg(i)));
+		const QIcon icon = style.sceneIcon;
+		for (int i = 0; i < sceneCount; ++i)
+			plain.item(i)->setIcon(icon);
+		for (int i = 0; i < sceneCount; ++i)
+			plain.item(i)->setIcon(QIcon());
+		r.items = sceneCount * 2;
+	});
+
+	// And now: two style changes on the model
+	phases << timePhase(QStringLiteral("icons_node_style"), [&](PhaseResult &r) {
+		SceneNodeModel::NodeStyle hidden = style;
+		hidden.showIcons = false;
+		model.setNodeStyle(hidden);
+		model.setNodeStyle(style);
+		r.items = 2;
+		r.ok = !model.index(0, 0).data(Qt::DecorationRole).isNull();
+		if (!r.ok)
+			r.error = QStringLiteral("Decoration missing after restoring icons");
+	});
+
+	// Program switch, before: walk every item clearing the flag and set it on the match
+	const int switches = 100;
+	phases << timePhase(QStringLiteral("program_walk"), [&](PhaseResult &r) {
+		for (int s = 0; s < switches; ++s) {
+			BenchScene *target = scenes[(s * 37) % scenes.size()];
+			forEachItem(model.invisibleRootItem(), [&](QStandardItem *item) {
+				if (item->type() == SceneItemType)
+					item->setData(item == target, ProgramSceneRole);
+			});
+		}
+		r.items = switches;
+	});
+
+	// After: the dock keeps the previous item and looks up the new one by source
+	phases << timePhase(QStringLiteral("program_direct"), [&](PhaseResult &r) {
+		QHash<int, BenchScene *> bySource;
+		for (int i = 0; i < scenes.size(); ++i)
+			bySource.insert(i, scenes[i]);
+		BenchScene *previous = nullptr;
+		for (int s = 0; s < switches; ++s) {
+			BenchScene *target = bySource.value((s * 37) % scenes.size());
+			if (previous && previous != target)
+				previous->setData(false, ProgramSceneRole);
+			target->setData(true, ProgramSceneRole);
+			previous = target;
+		}
+		r.items = switches;
+	});
+
+	SceneNodeFilterProxy proxy;
+	proxy.setSourceModel(&model);
+	proxy.setFilterCaseSensitivity(Qt::CaseInsensitive);
+
+	// Hide every fifth scene, as the locked dock's visibility pass does
+	phases << timePhase(QStringLiteral("hide_pass"), [&](PhaseResult &r) {
+		for (int i = 0; i < scenes.size(); ++i)
+			scenes[i]->setData(i % 5 == 0, HiddenSceneRole);
+		r.items = scenes.size();
+	});
+
+	// Sort A-Z with folders first from the build order, then the refresh that
+	// follows every scene list change, which finds nothing to move
+	SceneNodeModel::SortSpec byName;
+	byName.key = SceneNodeModel::SortSpec::Key::Name;
+	byName.foldersFirst = true;
+	model.setSortSpec(byName);
+
+	phases << timePhase(QStringLiteral("sort"), [&](PhaseResult &r) {
+		r.ok = model.sortTree(model.invisibleRootItem());
+		if (!r.ok)
+			r.error = QStringLiteral("Nothing moved sorting an unsorted tree");
+		r.items = sceneCount + folderCount;
+	});
+
+	phases << timePhase(QStringLiteral("sort_refresh_in_order"), [&](PhaseResult &r) {
+		r.ok = !model.sortTree(model.invisibleRootItem());
+		if (!r.ok)
+			r.error = QStringLiteral("Rows moved re-sorting a sorted tree");
+		r.items = sceneCount + folderCount;
+	});
+
+	// Typing "scene 19" a key at a time, then clearing
+	QStringList keystrokes;
+	const QString typed = QStringLiteral("Scene 19");
+	for (int i = 1; i <= typed.size(); ++i)
+		keystrokes << typed.left(i);
+	keystrokes << QString();
+
+	// Search, before: a wildcard regex over every row, recursively
+	phases << timePhase(QStringLiteral("filter_wildcard"), [&](PhaseResult &r) {
+		proxy.setRecursiveFilteringEnabled(true);
+		for (const QString &term : keystrokes)
+			proxy.setFilterWildcard(term);
+		proxy.setRecursiveFilteringEnabled(false);
+		r.items = keystrokes.size();
+	});
+
+	// After: the case-folded name index, narrowing the previous matches
+	phases << timePhase(QStringLiteral("filter_indexed"), [&](PhaseResult &r) {
+		for (const QString &term : keystrokes)
+			proxy.setSearchText(term);
+		r.items = keystrokes.size();
+	});
+
+	QJsonObject specJson;
+	specJson[QStringLiteral("scenes")] = sceneCount;
+	specJson[QStringLiteral("folders")] = folderCount;
+
+	QJsonArray phaseArray;
+	bool allOk = true;
+	for (const PhaseResult &phase : phases) {
+		phaseArray.append(phase.toJson());
+		allOk = allOk && phase.ok;
+	}
+
+	QJsonObject report;
+	report[QStringLiteral("spec")] = specJson;
+	report[QStringLiteral("phases")] = phaseArray;
+
+	const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+	QTextStream(stdout) << json;
+	if (parser.isSet(out)) {
+		QFile file(parser.value(out));
+		if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+			file.write(json);
+	}
+
+	return allOk ? 0 : 2;
+}
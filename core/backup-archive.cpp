@@ -0,0 +1,470 @@
+#include "backup-archive.hpp"
+#include "backup-tree.hpp"
+
+#include "../utilities/zip-writer.hpp"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <QSet>
+
+namespace StreamUP {
+namespace Backup {
+
+namespace {
+
+// Settings keys in a scene collection that hold a path to an external file.
+const QStringList kPathKeys = {QStringLiteral("file"),  QStringLiteral("local_file"),
+			       QStringLiteral("path"),  QStringLiteral("shader_file_name"),
+			       QStringLiteral("image"), QStringLiteral("font_file")};
+
+QString cleanDir(const QString &path)
+{
+	return QDir::cleanPath(QDir::fromNativeSeparators(path));
+}
+
+/** Strip the stream key out of a profile's service.json. */
+QByteArray stripServiceJson(const QByteArray &raw, bool *changed)
+{
+	QJsonParseError err{};
+	QJsonDocument doc = QJsonDocument::fromJson(raw, &err);
+	if (err.error != QJsonParseError::NoError || !doc.isObject())
+		return raw;
+
+	QJsonObject root = doc.object();
+	QJsonObject settings = root.value(QStringLiteral("settings")).toObject();
+	bool touched = false;
+	for (const QString &key : {QStringLiteral("key"), QStringLiteral("password"), QStringLiteral("bearer_token")}) {
+		if (settings.contains(key)) {
+			settings.remove(key);
+			touched = true;
+		}
+	}
+	if (!touched)
+		return raw;
+
+	root[QStringLiteral("settings")] = settings;
+	if (changed)
+		*changed = true;
+	return QJsonDocument(root).toJson(QJsonDocument::Indented);
+}
+
+/**
+ * Strip OAuth tokens out of a profile basic.ini. Done as a line filter rather
+ * than by parsing: config_t would reformat the whole file, and we want the
+ * restored ini to be byte-identical apart from the removed keys.
+ */
+QByteArray stripBasicIni(const QByteArray &raw, bool *changed)
+{
+	static const QStringList secretKeys = {QStringLiteral("Token"),        QStringLiteral("RefreshToken"),
+					       QStringLiteral("Key"),          QStringLiteral("Password"),
+					       QStringLiteral("BearerToken"),  QStringLiteral("ScopeVer")};
+
+	QByteArray out;
+	out.reserve(raw.size());
+	bool inAuthSection = false;
+	bool touched = false;
+
+	const QList<QByteArray> lines = raw.split('\n');
+	for (const QByteArray &line : lines) {
+		const QByteArray trimmed = line.trimmed();
+		if (trimmed.startsWith('[')) {
+			const QString section = QString::fromUtf8(trimmed).mid(1, trimmed.size() - 2);
+			// [Auth] plus any service section that carries a token
+			inAuthSection = (section.compare(QStringLiteral("Auth"), Qt::CaseInsensitive) == 0) ||
+					(section.compare(QStringLiteral("Twitch"), Qt::CaseInsensitive) == 0) ||
+					(section.compare(QStringLiteral("YouTube"), Qt::CaseInsensitive) == 0) ||
+					(section.compare(QStringLiteral("Restream"), Qt::CaseInsensitive) == 0);
+		} else if (inAuthSection) {
+			const int eq = trimmed.indexOf('=');
+			if (eq > 0) {
+				const QString key = QString::fromUtf8(trimmed.left(eq)).trimmed();
+				if (secretKeys.contains(key, Qt::CaseInsensitive)) {
+					touched = true;
+					continue; // drop the line entirely
+				}
+			}
+		}
+		out.append(line);
+		out.append('\n');
+	}
+
+	// split()/join round trip adds a trailing newline; drop it if the original
+	// did not have one.
+	if (!raw.endsWith('\n') && out.endsWith('\n'))
+		out.chop(1);
+
+	if (changed)
+		*changed = touched;
+	return touched ? out : raw;
+}
+
+/**
+ * Recursively walk a directory, returning (absolute path, relative path) pairs.
+ *
+ * maxBytes drops anything larger and records it in skipped, so a 3 GB AI model
+ * sitting in a plugin's config folder cannot quietly turn a 4 MB backup into an
+ * hour-long compress of something the plugin will just re-download.
+ */
+void collectDir(const QString &rootDir, const QString &relativePrefix, const QStringList &skipDirs,
+		QList<QPair<QString, QString>> &out, qint64 maxBytes, QList<SkippedFile> *skipped,
+		QStringList *leftOut)
+{
+	// QDir("") is the working directory, which is never a config area.
+	if (rootDir.isEmpty())
+		return;
+	QDir dir(rootDir);
+	if (!dir.exists())
+		return;
+
+	const QFileInfoList entries =
+		dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden);
+	for (const QFileInfo &info : entries) {
+		if (info.isDir()) {
+			if (skipDirs.contains(info.fileName(), Qt::CaseInsensitive))
+				continue;
+			collectDir(info.absoluteFilePath(), relativePrefix + info.fileName() + QStringLiteral("/"),
+				   skipDirs, out, maxBytes, skipped, leftOut);
+			continue;
+		}
+
+		if (!IsBackupCandidate(info)) {
+			if (leftOut)
+				leftOut->append(info.absoluteFilePath());
+			continue;
+		}
+
+		if (maxBytes > 0 && info.size() > maxBytes) {
+			if (skipped)
+				skipped->append({info.absoluteFilePath(), info.size()});
+			continue;
+		}
+
+		out.append({info.absoluteFilePath(), relativePrefix + info.fileName()});
+	}
+}
+
+/**
+ * Which folder inside media/ a referenced file belongs in.
+ *
+ * A collected backup is also how someone moves a setup to another machine, so
+ * the media folder is something they will open and work in rather than an
+ * opaque blob. Sorting by kind means the images sit with the images and an
+ * overlay pack's html and css stay together, instead of ninety hashed folders
+ * in one list. The category is part of the archive path and the manifest
+ * records the full path per file, so restore keeps working unchanged and older
+ * backups (which have no category folder) still restore.
+ */
+QString mediaCategory(const QString &sourcePath)
+{
+	const QString suffix = QFileInfo(sourcePath).suffix().toLower();
+
+	static const QStringList images = {"png",  "jpg", "jpeg", "gif", "bmp", "webp",
+					   "tga", "tiff", "tif",  "jxr", "psd", "svg"};
+	static const QStringList video = {"mp4", "mov", "mkv", "webm", "avi", "flv", "m4v", "mpg", "mpeg", "wmv", "ts"};
+	static const QStringList audio = {"wav", "mp3", "ogg", "flac", "aac", "m4a", "opus", "wma", "aiff"};
+	static const QStringList fonts = {"ttf", "otf", "ttc", "woff", "woff2"};
+	static const QStringList web = {"html", "htm", "css", "js", "json", "wasm"};
+	static const QStringList shaders = {"shader", "effect", "hlsl", "glsl", "fx"};
+	static const QStringList luts = {"cube", "3dl", "lut"};
+
+	if (images.contains(suffix))
+		return QStringLiteral("images");
+	if (video.contains(suffix))
+		return QStringLiteral("video");
+	if (audio.contains(suffix))
+		return QStringLiteral("audio");
+	if (fonts.contains(suffix))
+		return QStringLiteral("fonts");
+	if (shaders.contains(suffix))
+		return QStringLiteral("shaders");
+	if (luts.contains(suffix))
+		return QStringLiteral("luts");
+	// Checked after shaders and LUTs on purpose: an overlay pack's .json is web
+	// content, but a shader's .effect is not, and the specific lists win.
+	if (web.contains(suffix))
+		return QStringLiteral("web");
+	return QStringLiteral("other");
+}
+
+/**
+ * Where a referenced media file lands inside the archive.
+ *
+ * Flattening to media/<filename> collides: overlay packs are full of files
+ * called index.html, style.css, image.png, and two different sources pointing
+ * at two different index.html files would land on one entry. That is silent
+ * data loss on backup and an ambiguous restore. Keying on a hash of the full
+ * source path keeps every file distinct, and keeping the original file name in
+ * the leaf keeps the archive readable. The manifest carries the mapping, so
+ * restore never has to guess.
+ */
+QString mediaArchiveName(const QString &sourcePath)
+{
+	const QByteArray digest =
+		QCryptographicHash::hash(sourcePath.toUtf8(), QCryptographicHash::Sha1).toHex().left(10);
+	return QStringLiteral("media/%1/%2/%3")
+		.arg(mediaCategory(sourcePath), QString::fromLatin1(digest), QFileInfo(sourcePath).fileName());
+}
+
+/** Pull every path-looking value out of a scene collection JSON tree. */
+void walkForPaths(const QJsonValue &value, const QString &collection, QList<MediaReference> &out, QSet<QString> &seen)
+{
+	if (value.isObject()) {
+		const QJsonObject obj = value.toObject();
+		for (auto it = obj.begin(); it != obj.end(); ++it) {
+			if (it.value().isString() && kPathKeys.contains(it.key())) {
+				QString path = it.value().toString();
+				if (path.isEmpty() || path.startsWith(QStringLiteral("http")))
+					continue;
+				const QFileInfo info(path);
+				if (!info.isAbsolute())
+					continue;
+				const QString normalised = cleanDir(path);
+				if (seen.contains(normalised))
+					continue;
+				seen.insert(normalised);
+
+				MediaReference ref;
+				ref.path = normalised;
+				ref.collection = collection;
+				ref.key = it.key();
+				ref.archiveName = mediaArchiveName(normalised);
+				ref.exists = info.exists();
+				ref.size = ref.exists ? info.size() : 0;
+				out.append(ref);
+			} else {
+				walkForPaths(it.value(), collection, out, seen);
+			}
+		}
+	} else if (value.isArray()) {
+		const QJsonArray arr = value.toArray();
+		for (const QJsonValue child : arr)
+			walkForPaths(child, collection, out, seen);
+	}
+}
+
+/** Parse one scene collection and add what it references, skipping paths already in `seen`. */
+void scanCollection(const QFileInfo &info, QList<MediaReference> &out, QSet<QString> &seen)
+{
+	QFile f(info.absoluteFilePath());
+	if (!f.open(QIODevice::ReadOnly))
+		return;
+	const QByteArray raw = f.readAll();
+	f.close();
+
+	QJsonParseError err{};
+	const QJsonDocument doc = QJsonDocument::fromJson(raw, &err);
+	if (err.error != QJsonParseError::NoError)
+		return;
+
+	walkForPaths(doc.object(), info.completeBaseName(), out, seen);
+}
+
+} // namespace
+
+QList<MediaReference> ScanMediaReferences(const Locations &locations)
+{
+	QList<MediaReference> refs;
+	QSet<QString> seen;
+
+	QDir scenes(locations.scenesDir);
+	const QFileInfoList files = scenes.entryInfoList({QStringLiteral("*.json")}, QDir::Files);
+	for (const QFileInfo &info : files)
+		scanCollection(info, refs, seen);
+
+	return refs;
+}
+
+QList<MediaReference> ScanCollectionMedia(const QString &collectionPath)
+{
+	QList<MediaReference> refs;
+	QSet<QString> seen;
+	scanCollection(QFileInfo(collectionPath), refs, seen);
+	return refs;
+}
+
+void CollectConfigFiles(const Locations &loc, const Options &options, QList<QPair<QString, QString>> &files,
+			QList<SkippedFile> *skipped, QList<AreaCollected> *areas, QStringList *leftOut)
+{
+	auto addArea = [&](const QString &label, const QString &sourceDir, const QString &prefix,
+			   const QStringList &skip) {
+		const int before = files.size();
+		collectDir(sourceDir, prefix, skip, files, options.maxFileSizeBytes, skipped, leftOut);
+		if (areas)
+			areas->append({label, sourceDir, static_cast<int>(files.size() - before)});
+	};
+
+	int rootFiles = 0;
+	for (const QString &name : {QStringLiteral("global.ini"), QStringLiteral("user.ini")}) {
+		const QString path = loc.configDir + QStringLiteral("/") + name;
+		if (QFileInfo::exists(path)) {
+			files.append({path, QStringLiteral("config/") + name});
+			rootFiles++;
+		}
+	}
+	if (areas)
+		areas->append({QStringLiteral("config root"), loc.configDir, rootFiles});
+
+	addArea(QStringLiteral("profiles"), loc.profilesDir, QStringLiteral("config/basic/profiles/"), {});
+	addArea(QStringLiteral("scenes"), loc.scenesDir, QStringLiteral("config/basic/scenes/"), {});
+	addArea(QStringLiteral("plugin_manager"), loc.pluginManagerDir, QStringLiteral("config/plugin_manager/"), {});
+
+	if (options.includePluginConfig)
+		addArea(QStringLiteral("plugin_config"), loc.pluginConfigDir, QStringLiteral("config/plugin_config/"),
+			ExcludedPluginConfigDirs());
+
+	if (options.includeThemes)
+		addArea(QStringLiteral("themes"), loc.themesDir, QStringLiteral("themes/"), {});
+}
+
+Estimate EstimateTree(const Locations &loc, const Options &options)
+{
+	Estimate estimate;
+	if (!loc.valid())
+		return estimate;
+
+	QList<QPair<QString, QString>> files;
+	QList<SkippedFile> skipped;
+	CollectConfigFiles(loc, options, files, &skipped);
+
+	for (const auto &entry : files) {
+		estimate.fileCount++;
+		estimate.totalBytes += QFileInfo(entry.first).size();
+	}
+
+	if (options.collectMedia) {
+		for (const MediaReference &ref : ScanMediaReferences(loc)) {
+			if (!ref.exists)
+				continue;
+			if (options.maxFileSizeBytes > 0 && ref.size > options.maxFileSizeBytes) {
+				estimate.largeFileCount++;
+				estimate.largeFileBytes += ref.size;
+				continue;
+			}
+			estimate.fileCount++;
+			estimate.totalBytes += ref.size;
+		}
+	}
+
+	for (const SkippedFile &s : skipped) {
+		estimate.largeFileCount++;
+		estimate.largeFileBytes += s.size;
+	}
+
+	return estimate;
+}
+
+ArchiveWritten WriteArchive(const QString &archivePath, const QList<QPair<QString, QString>> &files,
+			    QJsonObject manifest, const Options &options, const ProgressCallback &progress)
+{
+	ArchiveWritten written;
+
+	Zip::Writer zip;
+	if (!zip.open(archivePath)) {
+		written.error = zip.lastError();
+		return written;
+	}
+
+	const int total = files.size() + 1; // +1 for the manifest
+	int done = 0;
+	QJsonArray fileList;
+
+	for (const QPair<QString, QString> &entry : files) {
+		if (progress && !progress(QFileInfo(entry.first).fileName(), done, total)) {
+			zip.close();
+			QFile::remove(archivePath);
+			written.error = QStringLiteral("Cancelled");
+			return written;
+		}
+
+		const QString name = QFileInfo(entry.first).fileName();
+		bool wrote = false;
+
+		// Credential-bearing files get filtered on the way in unless the user
+		// asked for a full-fidelity backup.
+		if (!options.includeCredentials && entry.second.startsWith(QStringLiteral("config/basic/profiles/"))) {
+			QFile in(entry.first);
+			if (in.open(QIODevice::ReadOnly)) {
+				const QByteArray raw = in.readAll();
+				in.close();
+				bool stripped = false;
+				QByteArray filtered = raw;
+				if (name.compare(QStringLiteral("service.json"), Qt::CaseInsensitive) == 0)
+					filtered = stripServiceJson(raw, &stripped);
+				else if (name.compare(QStringLiteral("basic.ini"), Qt::CaseInsensitive) == 0)
+					filtered = stripBasicIni(raw, &stripped);
+
+				if (stripped) {
+					wrote = zip.addData(filtered, entry.second);
+					written.credentialsStripped.append(entry.second);
+				}
+			}
+		}
+
+		if (!wrote) {
+			// Chunk callback keeps the UI alive inside a single large file.
+			// Without it, one big file looks like a hang, which is exactly
+			// what a multi-gigabyte model file used to do.
+			wrote = zip.addFile(entry.first, entry.second, [&](qint64 doneBytes, qint64 totalBytes) {
+				if (!progress || totalBytes < 8 * 1024 * 1024)
+					return true;
+				const QString label = QStringLiteral("%1 (%2 of %3 MB)")
+							      .arg(name)
+							      .arg(doneBytes / (1024 * 1024))
+							      .arg(totalBytes / (1024 * 1024));
+				return progress(label, done, total);
+			});
+		}
+
+		if (!wrote) {
+			// A single unreadable file (locked, permissions) should not sink
+			// the whole backup; note it and carry on.
+			written.unreadable.append({entry.first, zip.lastError()});
+			done++;
+			continue;
+		}
+
+		if (entry.second.startsWith(QStringLiteral("media/")))
+			written.mediaCollected++;
+
+		fileList.append(entry.second);
+		written.fileCount++;
+		done++;
+	}
+
+	manifest[QStringLiteral("files")] = fileList;
+	if (!zip.addData(QJsonDocument(manifest).toJson(QJsonDocument::Indented),
+			 QStringLiteral("streamup-backup.json"))) {
+		written.error = zip.lastError();
+		zip.close();
+		return written;
+	}
+
+	if (progress)
+		progress(QStringLiteral("streamup-backup.json"), total, total);
+
+	written.archiveBytes = zip.bytesWritten();
+	if (!zip.close()) {
+		written.error = zip.lastError();
+		return written;
+	}
+
+	// Read the archive back before calling it a success. A backup that is
+	// quietly truncated is worth less than no backup at all, because it is
+	// trusted right up until the moment it is needed.
+	QString verifyError;
+	if (!Zip::VerifyArchive(archivePath, written.fileCount + 1, &verifyError)) {
+		written.error = QStringLiteral("Backup could not be verified: %1").arg(verifyError);
+		return written;
+	}
+
+	written.success = true;
+	return written;
+}
+
+} // namespace Backup
+} // namespace StreamUP
@@ -0,0 +1,78 @@
+#ifndef STREAMUP_BACKUP_ARCHIVE_HPP
+#define STREAMUP_BACKUP_ARCHIVE_HPP
+
+#include "backup-manager.hpp"
+
+#include <QJsonObject>
+#include <QList>
+#include <QPair>
+#include <QStringList>
+
+namespace StreamUP {
+namespace Backup {
+
+/*
+ * Collecting a config tree and writing it into an archive, given resolved
+ * Locations. Kept free of OBS, like backup-tree.cpp, so the standalone backup
+ * benchmark times this code rather than a copy of it. Resolving the locations,
+ * saving OBS first and logging stay in backup-manager.cpp.
+ *
+ * ScanMediaReferences and ScanCollectionMedia, declared in backup-manager.hpp,
+ * are defined in backup-archive.cpp for the same reason.
+ */
+
+/** One config area as collected: where it was read from and what it added. */
+struct AreaCollected {
+	QString label;
+	QString sourceDir; // empty when the location did not resolve
+	int files = 0;
+};
+
+/**
+ * Build the list of configuration files a backup with these options covers,
+ * as (absolute path, archive name) pairs.
+ *
+ * Files over options.maxFileSizeBytes go to `skipped`, and files that are not
+ * configuration (see IsBackupCandidate) to `leftOut`, so the caller can report
+ * them. `areas` receives one entry per area, config root first.
+ */
+void CollectConfigFiles(const Locations &loc, const Options &options, QList<QPair<QString, QString>> &files,
+			QList<SkippedFile> *skipped = nullptr, QList<AreaCollected> *areas = nullptr,
+			QStringList *leftOut = nullptr);
+
+/** EstimateBackup over already resolved locations. */
+Estimate EstimateTree(const Locations &loc, const Options &options);
+
+/** What WriteArchive put down. */
+struct ArchiveWritten {
+	bool success = false;
+	QString error;
+
+	int fileCount = 0;      // entries written, manifest not counted
+	int mediaCollected = 0; // of which under media/
+	qint64 archiveBytes = 0;
+
+	// Profile files that had credentials filtered out on the way in.
+	QStringList credentialsStripped;
+
+	// (path, reason) for files left out because they could not be read.
+	QList<QPair<QString, QString>> unreadable;
+};
+
+/**
+ * Write (absolute path, archive name) pairs into a new archive, then the
+ * manifest with its "files" list set to what was actually written, then read
+ * the archive back and verify it.
+ *
+ * Profile credentials are stripped unless options.includeCredentials is set. A
+ * file that cannot be read is listed in `unreadable` rather than failing the
+ * whole archive. Returning false from progress cancels and removes the partial
+ * archive, with error "Cancelled".
+ */
+ArchiveWritten WriteArchive(const QString &archivePath, const QList<QPair<QString, QString>> &files,
+			    QJsonObject manifest, const Options &options, const ProgressCallback &progress = nullptr);
+
+} // namespace Backup
+} // namespace StreamUP
+
+#endif // STREAMUP_BACKUP_ARCHIVE_HPP
@@ -0,0 +1,562 @@
+#include "backup-estimator.hpp"
+#include "backup-tree.hpp"
+
+#include <streamup/debug-logger.hpp>
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QTimer>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace StreamUP {
+namespace Backup {
+namespace LiveEstimator {
+
+namespace {
+
+// Directories beyond this are left to the periodic re-walk. inotify's watch
+// limit is per user, shared with every other program on the machine, and a
+// plugin_config folder can hold thousands of directories on its own.
+constexpr int kMaxWatchedDirs = 4096;
+
+// How long notifications are trusted on their own before a request for the
+// estimate also queues a full re-walk.
+constexpr qint64 kResyncAfterMs = 10 * 60 * 1000;
+
+// Changes arrive in bursts (OBS saving a collection is a write, a rename and a
+// delete), so they are gathered for a moment before the worker runs.
+constexpr int kDebounceMs = 300;
+
+enum class Area { ConfigRoot, Profiles, Scenes, PluginManager, PluginConfig, Themes };
+
+struct DirRecord {
+	Area area = Area::Profiles;
+	std::vector<qint64> sizes; // backed-up files directly in this directory
+	QStringList subdirs;       // absolute paths of the directories walked below it
+};
+
+struct CollectionRecord {
+	qint64 size = 0;
+	qint64 modifiedMs = 0;
+	QList<MediaReference> media;
+};
+
+// Ordered by path so everything under a directory is one contiguous range.
+using DirMap = std::map<QString, DirRecord>;
+using CollectionMap = std::map<QString, CollectionRecord>;
+
+/** What one worker pass should look at. */
+struct Job {
+	bool full = false;
+	QSet<QString> dirs;
+	bool collections = false;
+};
+
+/** What a worker pass changed, for the UI thread to carry over to the watcher. */
+struct JobResult {
+	QStringList addedDirs;
+	QStringList removedDirs;
+	bool collectionsListed = false;
+	QStringList collectionFiles;
+};
+
+struct State {
+	// Guards everything down to sinceFull: the worker writes it, Current reads it.
+	std::mutex mutex;
+	Locations loc;
+	DirMap dirs;
+	CollectionMap collections;
+	bool ready = false;
+	QElapsedTimer sinceFull;
+
+	// UI thread only.
+	QFileSystemWatcher *watcher = nullptr;
+	QTimer *debounce = nullptr;
+	Job pending;
+	bool rerun = false;
+
+	std::thread worker;
+	std::atomic<bool> busy{false};
+	std::atomic<bool> stopping{false};
+};
+
+State &state()
+{
+	static State s;
+	return s;
+}
+
+QStringList skipDirsFor(Area area)
+{
+	return area == Area::PluginConfig ? ExcludedPluginConfigDirs() : QStringList();
+}
+
+/** One directory, without recursing: its backed-up file sizes and the folders below it. */
+DirRecord statDir(const QString &path, Area area)
+{
+	DirRecord rec;
+	rec.area = area;
+	const QStringList skip = skipDirsFor(area);
+	const QFileInfoList entries =
+		QDir(path).entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden);
+	for (const QFileInfo &info : entries) {
+		if (info.isDir()) {
+			if (!skip.contains(info.fileName(), Qt::CaseInsensitive))
+				rec.subdirs.append(info.absoluteFilePath());
+		} else if (IsBackupCandidate(info)) {
+			rec.sizes.push_back(info.size());
+		}
+	}
+	return rec;
+}
+
+/** The config root only contributes global.ini and user.ini, never its subfolders. */
+DirRecord statConfigRoot(const QString &configDir)
+{
+	DirRecord rec;
+	rec.area = Area::ConfigRoot;
+	for (const QString &name : {QStringLiteral("global.ini"), QStringLiteral("user.ini")}) {
+		const QFileInfo info(configDir + QStringLiteral("/") + name);
+		if (info.exists())
+			rec.sizes.push_back(info.size());
+	}
+	return rec;
+}
+
+/** Walk a tree into `out`, giving up early if the estimator is being torn down. */
+void scanTree(const QString &root, Area area, DirMap &out)
+{
+	QStringList queue{root};
+	while (!queue.isEmpty() && !state().stopping) {
+		const QString path = queue.takeLast();
+		if (!QFileInfo(path).isDir())
+			continue;
+		DirRecord rec = statDir(path, area);
+		queue.append(rec.subdirs);
+		out[path] = std::move(rec);
+	}
+}
+
+/** Drop a directory and everything recorded below it. */
+void eraseTree(DirMap &dirs, const QString &root, QStringList &removed)
+{
+	auto it = dirs.find(root);
+	if (it != dirs.end()) {
+		removed.append(root);
+		dirs.erase(it);
+	}
+	const QString prefix = root + QStringLiteral("/");
+	for (it = dirs.lower_bound(prefix); it != dirs.end() && it->first.startsWith(prefix);) {
+		removed.append(it->first);
+		it = dirs.erase(it);
+	}
+}
+
+/**
+ * Re-parse the collections whose size or modification time moved, and forget
+ * the ones that are gone. `force` re-parses all of them, which is also what
+ * re-checks whether the media they point at still exists.
+ */
+void refreshCollections(const Locations &loc, bool force, JobResult &result)
+{
+	State &s = state();
+
+	std::map<QString, std::pair<qint64, qint64>> known;
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		for (const auto &entry : s.collections)
+			known[entry.first] = {entry.second.size, entry.second.modifiedMs};
+	}
+
+	CollectionMap changed;
+	QSet<QString> present;
+	const QFileInfoList listing = QDir(loc.scenesDir).entryInfoList({QStringLiteral("*.json")}, QDir::Files);
+	for (const QFileInfo &info : listing) {
+		if (s.stopping)
+			return;
+		const QString path = info.absoluteFilePath();
+		present.insert(path);
+		result.collectionFiles.append(path);
+
+		const std::pair<qint64, qint64> stamp{info.size(), info.lastModified().toMSecsSinceEpoch()};
+		const auto it = known.find(path);
+		if (!force && it != known.end() && it->second == stamp)
+			continue;
+
+		CollectionRecord rec;
+		rec.size = stamp.first;
+		rec.modifiedMs = stamp.second;
+		rec.media = ScanCollectionMedia(path);
+		changed[path] = std::move(rec);
+	}
+	result.collectionsListed = true;
+
+	std::lock_guard<std::mutex> lock(s.mutex);
+	for (auto it = s.collections.begin(); it != s.collections.end();) {
+		if (present.contains(it->first))
+			++it;
+		else
+			it = s.collections.erase(it);
+	}
+	for (auto &entry : changed)
+		s.collections[entry.first] = std::move(entry.second);
+}
+
+/** Re-stat only the directories a notification named, walking any new folders below them. */
+void refreshDirs(const QSet<QString> &paths, JobResult &result)
+{
+	State &s = state();
+	for (const QString &path : paths) {
+		if (s.stopping)
+			return;
+
+		Area area = Area::Profiles;
+		QStringList oldSubdirs;
+		{
+			std::lock_guard<std::mutex> lock(s.mutex);
+			const auto it = s.dirs.find(path);
+			if (it == s.dirs.end())
+				continue; // already dropped along with a parent
+			area = it->second.area;
+			oldSubdirs = it->second.subdirs;
+		}
+
+		if (area == Area::ConfigRoot) {
+			DirRecord rec = statConfigRoot(path);
+			std::lock_guard<std::mutex> lock(s.mutex);
+			s.dirs[path] = std::move(rec);
+			continue;
+		}
+
+		if (!QFileInfo(path).isDir()) {
+			std::lock_guard<std::mutex> lock(s.mutex);
+			eraseTree(s.dirs, path, result.removedDirs);
+			continue;
+		}
+
+		DirRecord rec = statDir(path, area);
+		DirMap added;
+		for (const QString &sub : rec.subdirs) {
+			if (!oldSubdirs.contains(sub))
+				scanTree(sub, area, added);
+		}
+
+		std::lock_guard<std::mutex> lock(s.mutex);
+		for (const QString &sub : oldSubdirs) {
+			if (!rec.subdirs.contains(sub))
+				eraseTree(s.dirs, sub, result.removedDirs);
+		}
+		for (auto &entry : added) {
+			result.addedDirs.append(entry.first);
+			s.dirs[entry.first] = std::move(entry.second);
+		}
+		s.dirs[path] = std::move(rec);
+	}
+}
+
+/** Walk every area from scratch and swap the result in whole. */
+void fullScan(const Locations &loc, JobResult &result)
+{
+	State &s = state();
+
+	DirMap fresh;
+	fresh[loc.configDir] = statConfigRoot(loc.configDir);
+	const std::pair<QString, Area> areas[] = {{loc.profilesDir, Area::Profiles},
+						  {loc.scenesDir, Area::Scenes},
+						  {loc.pluginManagerDir, Area::PluginManager},
+						  {loc.pluginConfigDir, Area::PluginConfig},
+						  {loc.themesDir, Area::Themes}};
+	for (const auto &area : areas) {
+		if (!area.first.isEmpty())
+			scanTree(area.first, area.second, fresh);
+	}
+	if (s.stopping)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		for (const auto &entry : s.dirs) {
+			if (fresh.find(entry.first) == fresh.end())
+				result.removedDirs.append(entry.first);
+		}
+		for (const auto &entry : fresh)
+			result.addedDirs.append(entry.first);
+		s.dirs.swap(fresh);
+	}
+
+	refreshCollections(loc, true, result);
+}
+
+void launch();
+
+/** Carry a finished pass over to the watcher. UI thread. */
+void applyResult(const JobResult &result)
+{
+	State &s = state();
+	if (!s.watcher)
+		return;
+
+	if (!result.removedDirs.isEmpty())
+		s.watcher->removePaths(result.removedDirs);
+
+	const QStringList watchedDirs = s.watcher->directories();
+	const QSet<QString> watched(watchedDirs.begin(), watchedDirs.end());
+	QStringList toAdd;
+	int room = kMaxWatchedDirs - static_cast<int>(watched.size());
+	int unwatched = 0;
+	for (const QString &dir : result.addedDirs) {
+		if (watched.contains(dir))
+			continue;
+		if (room <= 0) {
+			unwatched++;
+			continue;
+		}
+		toAdd.append(dir);
+		room--;
+	}
+	if (unwatched > 0)
+		StreamUP::DebugLogger::LogDebugFormat("Backup", "Estimate",
+						      "Watch limit reached; %d directories rely on the periodic re-walk",
+						      unwatched);
+	if (!toAdd.isEmpty())
+		s.watcher->addPaths(toAdd);
+
+	// OBS saves a collection by writing a temporary file and renaming it over
+	// the old one, which drops the watch on some platforms. Re-add whatever
+	// has gone missing each time the collections are listed.
+	if (result.collectionsListed) {
+		const QSet<QString> wanted(result.collectionFiles.begin(), result.collectionFiles.end());
+		const QStringList watchedFiles = s.watcher->files();
+		QStringList stale;
+		for (const QString &file : watchedFiles) {
+			if (!wanted.contains(file))
+				stale.append(file);
+		}
+		if (!stale.isEmpty())
+			s.watcher->removePaths(stale);
+		QStringList missing;
+		for (const QString &file : result.collectionFiles) {
+			if (!watchedFiles.contains(file))
+				missing.append(file);
+		}
+		if (!missing.isEmpty())
+			s.watcher->addPaths(missing);
+	}
+
+	if (s.rerun) {
+		s.rerun = false;
+		launch();
+	}
+}
+
+void runJob(const Job &job, const Locations &loc)
+{
+	State &s = state();
+	QElapsedTimer timer;
+	timer.start();
+
+	JobResult result;
+	if (job.full) {
+		fullScan(loc, result);
+	} else {
+		refreshDirs(job.dirs, result);
+		if (job.collections)
+			refreshCollections(loc, false, result);
+	}
+
+	if (!s.stopping) {
+		std::lock_guard<std::mutex> lock(s.mutex);
+		if (job.full) {
+			s.ready = true;
+			s.sinceFull.start();
+			StreamUP::DebugLogger::LogInfoFormat("Backup", "Live estimate primed: %d directories, %d collections in %lld ms",
+							     static_cast<int>(s.dirs.size()),
+							     static_cast<int>(s.collections.size()),
+							     static_cast<long long>(timer.elapsed()));
+		} else {
+			StreamUP::DebugLogger::LogDebugFormat("Backup", "Estimate",
+							      "Refreshed %d changed directories%s in %lld ms",
+							      static_cast<int>(job.dirs.size()),
+							      job.collections ? " and the scene collections" : "",
+							      static_cast<long long>(timer.elapsed()));
+		}
+	}
+
+	// Cleared before handing over, so a rerun queued by applyResult can start.
+	s.busy = false;
+	if (!s.stopping)
+		QMetaObject::invokeMethod(s.watcher, [result]() { applyResult(result); }, Qt::QueuedConnection);
+}
+
+/** Start a worker pass for whatever is pending, or note that one is owed. UI thread. */
+void launch()
+{
+	State &s = state();
+	if (s.stopping)
+		return;
+	if (s.busy) {
+		s.rerun = true;
+		return;
+	}
+	if (s.worker.joinable())
+		s.worker.join();
+
+	Job job = std::move(s.pending);
+	s.pending = Job();
+	if (!job.full && job.dirs.isEmpty() && !job.collections)
+		return;
+
+	Locations loc;
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		loc = s.loc;
+	}
+	s.busy = true;
+	s.worker = std::thread([job, loc]() { runJob(job, loc); });
+}
+
+} // namespace
+
+void Start()
+{
+	State &s = state();
+	if (s.watcher)
+		return;
+
+	const Locations loc = ResolveLocations();
+	if (!loc.valid()) {
+		StreamUP::DebugLogger::LogWarning("Backup", "Live estimate not started: config location unknown");
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		s.loc = loc;
+	}
+	s.stopping = false;
+
+	s.watcher = new QFileSystemWatcher();
+	s.debounce = new QTimer(s.watcher);
+	s.debounce->setSingleShot(true);
+	s.debounce->setInterval(kDebounceMs);
+	QObject::connect(s.debounce, &QTimer::timeout, s.watcher, []() { launch(); });
+
+	QObject::connect(s.watcher, &QFileSystemWatcher::directoryChanged, s.watcher, [](const QString &path) {
+		State &st = state();
+		st.pending.dirs.insert(path);
+		if (path == st.loc.scenesDir)
+			st.pending.collections = true;
+		st.debounce->start();
+	});
+	// Only collection files are watched individually. A change there moves the
+	// scenes folder's size too, so both are refreshed.
+	QObject::connect(s.watcher, &QFileSystemWatcher::fileChanged, s.watcher, [](const QString &) {
+		State &st = state();
+		st.pending.dirs.insert(st.loc.scenesDir);
+		st.pending.collections = true;
+		st.debounce->start();
+	});
+
+	s.pending.full = true;
+	launch();
+}
+
+void Stop()
+{
+	State &s = state();
+	if (!s.watcher)
+		return;
+
+	s.stopping = true;
+	if (s.worker.joinable())
+		s.worker.join();
+
+	delete s.watcher; // takes the debounce timer and any queued results with it
+	s.watcher = nullptr;
+	s.debounce = nullptr;
+	s.pending = Job();
+	s.rerun = false;
+
+	std::lock_guard<std::mutex> lock(s.mutex);
+	s.ready = false;
+	s.dirs.clear();
+	s.collections.clear();
+}
+
+bool Current(const Options &options, LiveEstimate &out)
+{
+	State &s = state();
+	out = LiveEstimate();
+
+	bool stale = false;
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		if (!s.ready)
+			return false;
+
+		Estimate &estimate = out.estimate;
+		for (const auto &entry : s.dirs) {
+			const DirRecord &rec = entry.second;
+			if (rec.area == Area::PluginConfig && !options.includePluginConfig)
+				continue;
+			if (rec.area == Area::Themes && !options.includeThemes)
+				continue;
+			for (qint64 size : rec.sizes) {
+				// The root ini files are always taken whole, as EstimateBackup does.
+				if (rec.area != Area::ConfigRoot && options.maxFileSizeBytes > 0 &&
+				    size > options.maxFileSizeBytes) {
+					estimate.largeFileCount++;
+					estimate.largeFileBytes += size;
+					continue;
+				}
+				estimate.fileCount++;
+				estimate.totalBytes += size;
+			}
+		}
+
+		// A file referenced from two collections is one file, as in ScanMediaReferences.
+		QSet<QString> seen;
+		for (const auto &entry : s.collections) {
+			for (const MediaReference &ref : entry.second.media) {
+				if (seen.contains(ref.path))
+					continue;
+				seen.insert(ref.path);
+				out.mediaReferenced++;
+				if (!ref.exists) {
+					out.mediaMissing++;
+					continue;
+				}
+				if (!options.collectMedia)
+					continue;
+				if (options.maxFileSizeBytes > 0 && ref.size > options.maxFileSizeBytes) {
+					estimate.largeFileCount++;
+					estimate.largeFileBytes += ref.size;
+					continue;
+				}
+				estimate.fileCount++;
+				estimate.totalBytes += ref.size;
+			}
+		}
+
+		stale = s.sinceFull.hasExpired(kResyncAfterMs);
+	}
+
+	if (stale && s.watcher) {
+		s.pending.full = true;
+		launch();
+	}
+	return true;
+}
+
+} // namespace LiveEstimator
+} // namespace Backup
+} // namespace StreamUP
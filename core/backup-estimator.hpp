@@ -0,0 +1,53 @@
+#ifndef STREAMUP_BACKUP_ESTIMATOR_HPP
+#define STREAMUP_BACKUP_ESTIMATOR_HPP
+
+#include "backup-manager.hpp"
+
+namespace StreamUP {
+namespace Backup {
+
+/** What the backup dialog shows before a backup runs. */
+struct LiveEstimate {
+	Estimate estimate;
+	int mediaReferenced = 0;
+	int mediaMissing = 0;
+};
+
+/**
+ * A backup estimate kept current in the background, so the backup dialog can
+ * show it the moment it opens.
+ *
+ * EstimateBackup walks every config area and parses every scene collection,
+ * which on a large install is long enough to hold the dialog closed. Here that
+ * walk happens once, on a worker thread after OBS has loaded, and the result is
+ * kept as per-directory file sizes and per-collection media references. A
+ * QFileSystemWatcher on those directories then marks just the ones that changed,
+ * and the worker re-stats those and re-parses only the collections whose size or
+ * modification time moved. The totals are summed from the cache on request, so
+ * any Options can be answered without touching the disk.
+ *
+ * Notifications are the fast path, not the only one: watches are capped, some
+ * platforms do not report in-place writes through a directory watch, and media
+ * lives wherever the user put it. A request against a cache older than a few
+ * minutes still answers instantly but also queues a full re-walk, so drift is
+ * bounded rather than permanent.
+ *
+ * Start, Stop and Current are UI-thread calls.
+ */
+namespace LiveEstimator {
+
+/** Resolve the config areas, prime the cache off the UI thread, then start watching. */
+void Start();
+
+/** Stop watching and wait for any scan in flight. Called at frontend exit, while Qt is still up. */
+void Stop();
+
+/** Fill `out` from the cache. False until the first scan has finished; fall back to EstimateBackup then. */
+bool Current(const Options &options, LiveEstimate &out);
+
+} // namespace LiveEstimator
+
+} // namespace Backup
+} // namespace StreamUP
+
+#endif // STREAMUP_BACKUP_ESTIMATOR_HPP
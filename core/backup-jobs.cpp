@@ -0,0 +1,280 @@
+#include "backup-jobs.hpp"
+
+#include <streamup/debug-logger.hpp>
+
+#include <QCoreApplication>
+#include <QDateTime>
+
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace StreamUP {
+namespace Backup {
+namespace Jobs {
+
+namespace {
+
+// A few progress reports a second is plenty for a button or a progress bar,
+// and a backup of many small files would otherwise send one per file.
+constexpr qint64 kProgressIntervalMs = 250;
+
+// Finished jobs kept for Get, oldest dropped first
+constexpr size_t kKeptJobs = 8;
+
+struct Job {
+	Status status;
+	Options options;
+	bool cancelRequested = false;
+};
+
+struct JobState {
+	// Guards everything down to listener.
+	std::mutex mutex;
+	std::deque<Job> jobs; // oldest first
+	quint64 nextId = 1;
+	bool accepting = false;
+	bool busy = false; // a job is queued or running
+	qint64 lastReportMs = 0;
+	Listener listener = nullptr;
+
+	// UI thread only.
+	std::thread worker;
+};
+
+JobState &state()
+{
+	static JobState s;
+	return s;
+}
+
+Job *findLocked(JobState &s, const QString &id)
+{
+	if (s.jobs.empty())
+		return nullptr;
+	if (id.isEmpty())
+		return &s.jobs.back();
+	for (Job &job : s.jobs) {
+		if (job.status.id == id)
+			return &job;
+	}
+	return nullptr;
+}
+
+bool finished(State state)
+{
+	return state == State::Succeeded || state == State::Failed || state == State::Cancelled;
+}
+
+void report(Listener listener, const Status &status)
+{
+	if (listener)
+		listener(status);
+}
+
+/** Mark a job done and hand back what to report, with the lock held. */
+Status finishLocked(JobState &s, Job &job, State state)
+{
+	job.status.state = state;
+	s.busy = false;
+	return job.status;
+}
+
+void runJob(const QString &id, const Locations &loc, const QString &archivePath, const Options &options)
+{
+	JobState &s = state();
+
+	const Result result = WriteBackup(loc, archivePath, options, [&s, id](const QString &stage, int done, int total) {
+		Status snapshot;
+		Listener listener = nullptr;
+		bool cancel = false;
+		{
+			std::lock_guard<std::mutex> lock(s.mutex);
+			Job *job = findLocked(s, id);
+			if (!job)
+				return false;
+			job->status.stage = stage;
+			job->status.done = done;
+			job->status.total = total;
+			cancel = job->cancelRequested;
+
+			const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+			if (nowMs - s.lastReportMs >= kProgressIntervalMs) {
+				s.lastReportMs = nowMs;
+				snapshot = job->status;
+				listener = s.listener;
+			}
+		}
+		report(listener, snapshot);
+		return !cancel;
+	});
+
+	Status snapshot;
+	Listener listener = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		Job *job = findLocked(s, id);
+		if (!job)
+			return;
+		job->status.result = result;
+		job->status.stage.clear();
+		if (result.success)
+			job->status.done = job->status.total;
+		const State outcome = result.success         ? State::Succeeded
+				      : job->cancelRequested ? State::Cancelled
+							     : State::Failed;
+		snapshot = finishLocked(s, *job, outcome);
+		listener = s.listener;
+	}
+
+	if (result.success) {
+		StreamUP::DebugLogger::LogInfoFormat("Backup", "Job %s wrote %s (%d files, %lld bytes)",
+						     id.toUtf8().constData(), archivePath.toUtf8().constData(),
+						     result.fileCount, (long long)result.archiveBytes);
+	} else {
+		StreamUP::DebugLogger::LogWarningFormat("Backup", "Job %s did not finish: %s", id.toUtf8().constData(),
+							result.error.toUtf8().constData());
+	}
+	report(listener, snapshot);
+}
+
+/** UI thread: save OBS's state, then hand the archive to a worker. */
+void startJob(const QString &id)
+{
+	JobState &s = state();
+	QString archivePath;
+	Options options;
+	Status snapshot;
+	Listener listener = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		Job *job = findLocked(s, id);
+		if (!job)
+			return;
+		listener = s.listener;
+		if (job->cancelRequested || !s.accepting) {
+			job->status.result.error = QStringLiteral("Cancelled");
+			snapshot = finishLocked(s, *job, State::Cancelled);
+		} else {
+			job->status.state = State::Running;
+			s.lastReportMs = 0;
+			archivePath = job->status.archivePath;
+			options = job->options;
+			snapshot = job->status;
+		}
+	}
+	report(listener, snapshot);
+	if (snapshot.state != State::Running)
+		return;
+
+	// The previous job's worker has finished by now, since only one runs
+	if (s.worker.joinable())
+		s.worker.join();
+
+	const Locations loc = PrepareBackup();
+	s.worker = std::thread(runJob, id, loc, archivePath, options);
+}
+
+} // namespace
+
+const char *StateKey(State state)
+{
+	switch (state) {
+	case State::Queued:
+		return "queued";
+	case State::Running:
+		return "running";
+	case State::Succeeded:
+		return "succeeded";
+	case State::Failed:
+		return "failed";
+	case State::Cancelled:
+		return "cancelled";
+	}
+	return "";
+}
+
+QString Submit(const QString &archivePath, const Options &options, QString &error)
+{
+	JobState &s = state();
+	Status snapshot;
+	Listener listener = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		if (!s.accepting) {
+			error = QStringLiteral("Backups cannot be started until OBS has finished loading");
+			return QString();
+		}
+		if (s.busy) {
+			error = QStringLiteral("Backup %1 is still running").arg(s.jobs.back().status.id);
+			return QString();
+		}
+
+		while (s.jobs.size() >= kKeptJobs)
+			s.jobs.pop_front();
+
+		Job job;
+		job.status.id = QString::number(s.nextId++);
+		job.status.archivePath = archivePath;
+		job.options = options;
+		s.jobs.push_back(job);
+		s.busy = true;
+		snapshot = job.status;
+		listener = s.listener;
+	}
+
+	const QString id = snapshot.id;
+	QMetaObject::invokeMethod(qApp, [id]() { startJob(id); }, Qt::QueuedConnection);
+	report(listener, snapshot);
+	return id;
+}
+
+bool Get(const QString &id, Status &out)
+{
+	JobState &s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	const Job *job = findLocked(s, id);
+	if (!job)
+		return false;
+	out = job->status;
+	return true;
+}
+
+bool Cancel(const QString &id)
+{
+	JobState &s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	Job *job = findLocked(s, id);
+	if (!job || finished(job->status.state))
+		return false;
+	job->cancelRequested = true;
+	return true;
+}
+
+void Start(Listener listener)
+{
+	JobState &s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	s.listener = listener;
+	s.accepting = true;
+}
+
+void Stop()
+{
+	JobState &s = state();
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		s.accepting = false;
+		s.listener = nullptr;
+		for (Job &job : s.jobs)
+			job.cancelRequested = true;
+	}
+	// The worker checks for cancellation between files and between chunks of
+	// a large one, so this does not wait out the backup.
+	if (s.worker.joinable())
+		s.worker.join();
+}
+
+} // namespace Jobs
+} // namespace Backup
+} // namespace StreamUP
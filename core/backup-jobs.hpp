@@ -0,0 +1,66 @@
+#ifndef STREAMUP_BACKUP_JOBS_HPP
+#define STREAMUP_BACKUP_JOBS_HPP
+
+#include "backup-manager.hpp"
+
+namespace StreamUP {
+namespace Backup {
+
+/**
+ * Backups started from outside the UI, run as background jobs.
+ *
+ * A backup that collects media can take minutes. Run inside a websocket
+ * request it held that client's connection for all of it, so a "backup now"
+ * button looked hung. A job is queued and answered with its id straight away.
+ * PrepareBackup runs on the UI thread, the archive is written on a worker, and
+ * progress goes to the listener at most a few times a second, plus once for
+ * every change of state.
+ *
+ * One job runs at a time. The last few finished jobs are kept so a caller can
+ * still ask how one ended.
+ *
+ * Start and Stop are UI-thread calls. Everything else is safe from any thread.
+ */
+namespace Jobs {
+
+enum class State { Queued, Running, Succeeded, Failed, Cancelled };
+
+struct Status {
+	QString id;
+	State state = State::Queued;
+	QString archivePath;
+	QString stage; // the file being written
+	int done = 0;
+	int total = 0;
+	Result result; // filled in once the job has finished
+};
+
+/** Stable names for vendor responses ("queued", "running", ...). */
+const char *StateKey(State state);
+
+/** Called from the UI or worker thread with a copy of the job's status. */
+using Listener = void (*)(const Status &status);
+
+/**
+ * Queue a backup. Returns the job's id, or an empty string with `error` set
+ * when jobs are not running or another backup is still in progress.
+ */
+QString Submit(const QString &archivePath, const Options &options, QString &error);
+
+/** A job's status. An empty id means the most recent job. False if there is no such job. */
+bool Get(const QString &id, Status &out);
+
+/** Ask a queued or running job to stop. False if there is no such job or it has already finished. */
+bool Cancel(const QString &id);
+
+/** Accept jobs from here on, reporting progress to `listener`. */
+void Start(Listener listener);
+
+/** Cancel any job in flight and wait for its worker. Called at frontend exit. */
+void Stop();
+
+} // namespace Jobs
+} // namespace Backup
+} // namespace StreamUP
+
+#endif // STREAMUP_BACKUP_JOBS_HPP
@@ -1,8 +1,15 @@
 #include "backup-manager.hpp"
+#include "backup-archive.hpp"
+#include "backup-tree.hpp"
 
+#include "../ui/notification-manager.hpp"
 #include "../ui/settings-manager.hpp"
+#include "../ui/ui-helpers.hpp"
 #include <streamup/debug-logger.hpp>
+#include <streamup/trace.hpp>
+#include "../utilities/zip-reader.hpp"
 #include "../utilities/zip-writer.hpp"
+#include "../utilities/path-utils.hpp"
 #include "version.h"
 
 #include <obs-frontend-api.h>
@@ -11,7 +18,7 @@
 #include <util/config-file.h>
 #include <util/platform.h>
 
-#include <QCryptographicHash>
+#include <QCoreApplication>
 #include <QDate>
 #include <QDateTime>
 #include <QElapsedTimer>
@@ -20,30 +27,20 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QJsonValue>
-#include <QSet>
 #include <QSysInfo>
 
+#include <algorithm>
+#include <utility>
+
 namespace StreamUP {
 namespace Backup {
 
 namespace {
 
-// Chromium cache under plugin_config/obs-browser is by far the biggest thing in
-// an OBS config tree (333 MB of Cache plus 122 MB of Code Cache on the machine
-// this was measured on) and every byte of it regenerates. Backing it up turns a
-// 4 MB archive into a 563 MB one for no benefit.
-const QStringList kExcludedPluginConfigDirs = {QStringLiteral("obs-browser")};
-
 // Regenerated or historical data. Never worth carrying.
 const QStringList kExcludedConfigDirs = {QStringLiteral("logs"), QStringLiteral("crashes"),
 					 QStringLiteral("profiler_data"), QStringLiteral("updates")};
 
-// Settings keys in a scene collection that hold a path to an external file.
-const QStringList kPathKeys = {QStringLiteral("file"),  QStringLiteral("local_file"),
-			       QStringLiteral("path"),  QStringLiteral("shader_file_name"),
-			       QStringLiteral("image"), QStringLiteral("font_file")};
-
 QString cleanDir(const QString &path)
 {
 	return QDir::cleanPath(QDir::fromNativeSeparators(path));
@@ -78,255 +75,94 @@ QString resolveLocationBase(config_t *appConfig, const char *key, const QString
 	return QDir(candidate).exists() ? candidate : fallbackBase;
 }
 
-/** Strip the stream key out of a profile's service.json. */
-QByteArray stripServiceJson(const QByteArray &raw, bool *changed)
-{
-	QJsonParseError err{};
-	QJsonDocument doc = QJsonDocument::fromJson(raw, &err);
-	if (err.error != QJsonParseError::NoError || !doc.isObject())
-		return raw;
-
-	QJsonObject root = doc.object();
-	QJsonObject settings = root.value(QStringLiteral("settings")).toObject();
-	bool touched = false;
-	for (const QString &key : {QStringLiteral("key"), QStringLiteral("password"), QStringLiteral("bearer_token")}) {
-		if (settings.contains(key)) {
-			settings.remove(key);
-			touched = true;
-		}
-	}
-	if (!touched)
-		return raw;
-
-	root[QStringLiteral("settings")] = settings;
-	if (changed)
-		*changed = true;
-	return QJsonDocument(root).toJson(QJsonDocument::Indented);
-}
-
-/**
- * Strip OAuth tokens out of a profile basic.ini. Done as a line filter rather
- * than by parsing: config_t would reformat the whole file, and we want the
- * restored ini to be byte-identical apart from the removed keys.
- */
-QByteArray stripBasicIni(const QByteArray &raw, bool *changed)
+QJsonArray pluginInventory()
 {
-	static const QStringList secretKeys = {QStringLiteral("Token"),        QStringLiteral("RefreshToken"),
-					       QStringLiteral("Key"),          QStringLiteral("Password"),
-					       QStringLiteral("BearerToken"),  QStringLiteral("ScopeVer")};
-
-	QByteArray out;
-	out.reserve(raw.size());
-	bool inAuthSection = false;
-	bool touched = false;
-
-	const QList<QByteArray> lines = raw.split('\n');
-	for (const QByteArray &line : lines) {
-		const QByteArray trimmed = line.trimmed();
-		if (trimmed.startsWith('[')) {
-			const QString section = QString::fromUtf8(trimmed).mid(1, trimmed.size() - 2);
-			// [Auth] plus any service section that carries a token
-			inAuthSection = (section.compare(QStringLiteral("Auth"), Qt::CaseInsensitive) == 0) ||
-					(section.compare(QStringLiteral("Twitch"), Qt::CaseInsensitive) == 0) ||
-					(section.compare(QStringLiteral("YouTube"), Qt::CaseInsensitive) == 0) ||
-					(section.compare(QStringLiteral("Restream"), Qt::CaseInsensitive) == 0);
-		} else if (inAuthSection) {
-			const int eq = trimmed.indexOf('=');
-			if (eq > 0) {
-				const QString key = QString::fromUtf8(trimmed.left(eq)).trimmed();
-				if (secretKeys.contains(key, Qt::CaseInsensitive)) {
-					touched = true;
-					continue; // drop the line entirely
-				}
-			}
-		}
-		out.append(line);
-		out.append('\n');
-	}
-
-	// split()/join round trip adds a trailing newline; drop it if the original
-	// did not have one.
-	if (!raw.endsWith('\n') && out.endsWith('\n'))
-		out.chop(1);
-
-	if (changed)
-		*changed = touched;
-	return touched ? out : raw;
+	QJsonArray plugins;
+	// The plugin manager's own module list is the authoritative record of what
+	// is installed and whether it is switched on.
+	obs_enum_modules(
+		[](void *param, obs_module_t *module) {
+			auto *arr = static_cast<QJsonArray *>(param);
+			QJsonObject entry;
+			entry[QStringLiteral("name")] = QString::fromUtf8(obs_get_module_name(module)
+										 ? obs_get_module_name(module)
+										 : obs_get_module_file_name(module));
+			entry[QStringLiteral("file")] = QString::fromUtf8(obs_get_module_file_name(module));
+			arr->append(entry);
+		},
+		&plugins);
+	return plugins;
 }
 
 /**
- * Recursively walk a directory, returning (absolute path, relative path) pairs.
+ * CollectConfigFiles, with what each area added as (label, count) pairs.
  *
- * maxBytes drops anything larger and records it in skipped, so a 3 GB AI model
- * sitting in a plugin's config folder cannot quietly turn a 4 MB backup into an
- * hour-long compress of something the plugin will just re-download.
+ * Shared by CreateBackup and the fingerprint check so both always see exactly
+ * the same tree. With `log` set, an area whose source directory exists but
+ * yields nothing is reported as a warning: that is a bug, not a quiet no-op.
  */
-void collectDir(const QString &rootDir, const QString &relativePrefix, const QStringList &skipDirs,
-		QList<QPair<QString, QString>> &out, qint64 maxBytes = 0, QList<SkippedFile> *skipped = nullptr)
+void collectConfigFiles(const Locations &loc, const Options &options, QList<QPair<QString, QString>> &files,
+			QList<SkippedFile> *skipped, QList<QPair<QString, int>> *areaCounts, bool log)
 {
-	QDir dir(rootDir);
-	if (!dir.exists())
+	QList<SkippedFile> oversized;
+	QList<AreaCollected> areas;
+	QStringList leftOut;
+	CollectConfigFiles(loc, options, files, &oversized, &areas, log ? &leftOut : nullptr);
+	if (skipped)
+		skipped->append(oversized);
+	if (areaCounts) {
+		for (const AreaCollected &area : areas)
+			areaCounts->append({area.label, area.files});
+	}
+	if (!log)
 		return;
 
-	const QFileInfoList entries =
-		dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden);
-	for (const QFileInfo &info : entries) {
-		if (info.isDir()) {
-			if (skipDirs.contains(info.fileName(), Qt::CaseInsensitive))
-				continue;
-			collectDir(info.absoluteFilePath(), relativePrefix + info.fileName() + QStringLiteral("/"),
-				   skipDirs, out, maxBytes, skipped);
-			continue;
-		}
-
-		// OBS writes .bak beside its own files; the live file is what we want.
-		if (info.suffix().compare(QStringLiteral("bak"), Qt::CaseInsensitive) == 0)
-			continue;
-
-		// Runtime state, not configuration. Plugins drop lock and sentinel
-		// files next to their settings (advanced-scene-switcher leaves a
-		// ".running"), and restoring a stale one tells that plugin it is
-		// already running, or tells OBS it crashed. Same reasoning as leaving
-		// out the config root's own .sentinel and safe_mode.
-		static const QStringList runtimeState = {QStringLiteral(".running"), QStringLiteral(".lock"),
-							 QStringLiteral(".sentinel"), QStringLiteral("safe_mode")};
-		if (runtimeState.contains(info.fileName(), Qt::CaseInsensitive) ||
-		    info.suffix().compare(QStringLiteral("lock"), Qt::CaseInsensitive) == 0) {
-			StreamUP::DebugLogger::LogDebugFormat("Backup", "Skip",
-							      "Runtime state file %s left out",
-							      info.fileName().toUtf8().constData());
-			continue;
-		}
+	for (const QString &name : {QStringLiteral("global.ini"), QStringLiteral("user.ini")}) {
+		const QString path = loc.configDir + QStringLiteral("/") + name;
+		if (!QFileInfo::exists(path))
+			StreamUP::DebugLogger::LogWarningFormat("Backup", "%s not found at %s",
+								name.toUtf8().constData(),
+								path.toUtf8().constData());
+	}
 
-		if (maxBytes > 0 && info.size() > maxBytes) {
-			if (skipped)
-				skipped->append({info.absoluteFilePath(), info.size()});
-			StreamUP::DebugLogger::LogInfoFormat("Backup", "Skipping %s (%.1f MB, over the size limit)",
-							     info.absoluteFilePath().toUtf8().constData(),
-							     info.size() / (1024.0 * 1024.0));
-			continue;
+	// The config root is reported through the two lines above
+	for (const AreaCollected &area : areas.mid(1)) {
+		if (area.sourceDir.isEmpty()) {
+			StreamUP::DebugLogger::LogInfoFormat("Backup", "%-15s skipped (no path resolved)",
+							     area.label.toUtf8().constData());
+		} else if (area.files == 0 && QDir(area.sourceDir).exists()) {
+			StreamUP::DebugLogger::LogWarningFormat(
+				"Backup", "%s: 0 files collected from %s, which exists. This is unexpected.",
+				area.label.toUtf8().constData(), area.sourceDir.toUtf8().constData());
+		} else {
+			StreamUP::DebugLogger::LogInfoFormat("Backup", "%-15s %d files from %s",
+							     area.label.toUtf8().constData(), area.files,
+							     area.sourceDir.toUtf8().constData());
 		}
-
-		out.append({info.absoluteFilePath(), relativePrefix + info.fileName()});
 	}
-}
 
-/**
- * Which folder inside media/ a referenced file belongs in.
- *
- * A collected backup is also how someone moves a setup to another machine, so
- * the media folder is something they will open and work in rather than an
- * opaque blob. Sorting by kind means the images sit with the images and an
- * overlay pack's html and css stay together, instead of ninety hashed folders
- * in one list. The category is part of the archive path and the manifest
- * records the full path per file, so restore keeps working unchanged and older
- * backups (which have no category folder) still restore.
- */
-QString mediaCategory(const QString &sourcePath)
-{
-	const QString suffix = QFileInfo(sourcePath).suffix().toLower();
-
-	static const QStringList images = {"png",  "jpg", "jpeg", "gif", "bmp", "webp",
-					   "tga", "tiff", "tif",  "jxr", "psd", "svg"};
-	static const QStringList video = {"mp4", "mov", "mkv", "webm", "avi", "flv", "m4v", "mpg", "mpeg", "wmv", "ts"};
-	static const QStringList audio = {"wav", "mp3", "ogg", "flac", "aac", "m4a", "opus", "wma", "aiff"};
-	static const QStringList fonts = {"ttf", "otf", "ttc", "woff", "woff2"};
-	static const QStringList web = {"html", "htm", "css", "js", "json", "wasm"};
-	static const QStringList shaders = {"shader", "effect", "hlsl", "glsl", "fx"};
-	static const QStringList luts = {"cube", "3dl", "lut"};
-
-	if (images.contains(suffix))
-		return QStringLiteral("images");
-	if (video.contains(suffix))
-		return QStringLiteral("video");
-	if (audio.contains(suffix))
-		return QStringLiteral("audio");
-	if (fonts.contains(suffix))
-		return QStringLiteral("fonts");
-	if (shaders.contains(suffix))
-		return QStringLiteral("shaders");
-	if (luts.contains(suffix))
-		return QStringLiteral("luts");
-	// Checked after shaders and LUTs on purpose: an overlay pack's .json is web
-	// content, but a shader's .effect is not, and the specific lists win.
-	if (web.contains(suffix))
-		return QStringLiteral("web");
-	return QStringLiteral("other");
+	for (const QString &path : leftOut)
+		StreamUP::DebugLogger::LogDebugFormat("Backup", "Skip", "%s is not configuration, left out",
+						      QFileInfo(path).fileName().toUtf8().constData());
+	for (const SkippedFile &file : oversized)
+		StreamUP::DebugLogger::LogInfoFormat("Backup", "Skipping %s (%.1f MB, over the size limit)",
+						     file.path.toUtf8().constData(), file.size / (1024.0 * 1024.0));
 }
 
 /**
- * Where a referenced media file lands inside the archive.
- *
- * Flattening to media/<filename> collides: overlay packs are full of files
- * called index.html, style.css, image.png, and two different sources pointing
- * at two different index.html files would land on one entry. That is silent
- * data loss on backup and an ambiguous restore. Keying on a hash of the full
- * source path keeps every file distinct, and keeping the original file name in
- * the leaf keeps the archive readable. The manifest carries the mapping, so
- * restore never has to guess.
+ * Name our own configs.json gets in the archive, so the reuse check can tell it
+ * apart. Empty if it somehow lives outside plugin_config.
  */
-QString mediaArchiveName(const QString &sourcePath)
-{
-	const QByteArray digest =
-		QCryptographicHash::hash(sourcePath.toUtf8(), QCryptographicHash::Sha1).toHex().left(10);
-	return QStringLiteral("media/%1/%2/%3")
-		.arg(mediaCategory(sourcePath), QString::fromLatin1(digest), QFileInfo(sourcePath).fileName());
-}
-
-/** Pull every path-looking value out of a scene collection JSON tree. */
-void walkForPaths(const QJsonValue &value, const QString &collection, QList<MediaReference> &out, QSet<QString> &seen)
+QString ownSettingsArchiveName(const Locations &loc)
 {
-	if (value.isObject()) {
-		const QJsonObject obj = value.toObject();
-		for (auto it = obj.begin(); it != obj.end(); ++it) {
-			if (it.value().isString() && kPathKeys.contains(it.key())) {
-				QString path = it.value().toString();
-				if (path.isEmpty() || path.startsWith(QStringLiteral("http")))
-					continue;
-				const QFileInfo info(path);
-				if (!info.isAbsolute())
-					continue;
-				const QString normalised = cleanDir(path);
-				if (seen.contains(normalised))
-					continue;
-				seen.insert(normalised);
-
-				MediaReference ref;
-				ref.path = normalised;
-				ref.collection = collection;
-				ref.key = it.key();
-				ref.archiveName = mediaArchiveName(normalised);
-				ref.exists = info.exists();
-				ref.size = ref.exists ? info.size() : 0;
-				out.append(ref);
-			} else {
-				walkForPaths(it.value(), collection, out, seen);
-			}
-		}
-	} else if (value.isArray()) {
-		const QJsonArray arr = value.toArray();
-		for (const QJsonValue child : arr)
-			walkForPaths(child, collection, out, seen);
-	}
-}
-
-QJsonArray pluginInventory()
-{
-	QJsonArray plugins;
-	// The plugin manager's own module list is the authoritative record of what
-	// is installed and whether it is switched on.
-	obs_enum_modules(
-		[](void *param, obs_module_t *module) {
-			auto *arr = static_cast<QJsonArray *>(param);
-			QJsonObject entry;
-			entry[QStringLiteral("name")] = QString::fromUtf8(obs_get_module_name(module)
-										 ? obs_get_module_name(module)
-										 : obs_get_module_file_name(module));
-			entry[QStringLiteral("file")] = QString::fromUtf8(obs_get_module_file_name(module));
-			arr->append(entry);
-		},
-		&plugins);
-	return plugins;
+	char *path = StreamUP::PathUtils::GetOBSConfigPath("configs.json");
+	if (!path)
+		return {};
+	const QString relative = QDir(loc.pluginConfigDir).relativeFilePath(cleanDir(QString::fromUtf8(path)));
+	bfree(path);
+	if (loc.pluginConfigDir.isEmpty() || relative.startsWith(QStringLiteral("..")))
+		return {};
+	return QStringLiteral("config/plugin_config/") + relative;
 }
 
 } // namespace
@@ -519,80 +355,9 @@ Locations ResolveLocations()
 	return loc;
 }
 
-QList<MediaReference> ScanMediaReferences(const Locations &locations)
-{
-	QList<MediaReference> refs;
-	QSet<QString> seen;
-
-	QDir scenes(locations.scenesDir);
-	const QFileInfoList files = scenes.entryInfoList({QStringLiteral("*.json")}, QDir::Files);
-	for (const QFileInfo &info : files) {
-		QFile f(info.absoluteFilePath());
-		if (!f.open(QIODevice::ReadOnly))
-			continue;
-		const QByteArray raw = f.readAll();
-		f.close();
-
-		QJsonParseError err{};
-		const QJsonDocument doc = QJsonDocument::fromJson(raw, &err);
-		if (err.error != QJsonParseError::NoError)
-			continue;
-
-		walkForPaths(doc.object(), info.completeBaseName(), refs, seen);
-	}
-
-	return refs;
-}
-
 Estimate EstimateBackup(const Options &options)
 {
-	Estimate estimate;
-	const Locations loc = ResolveLocations();
-	if (!loc.valid())
-		return estimate;
-
-	QList<QPair<QString, QString>> files;
-	QList<SkippedFile> skipped;
-
-	for (const QString &name : {QStringLiteral("global.ini"), QStringLiteral("user.ini")}) {
-		const QString path = loc.configDir + QStringLiteral("/") + name;
-		if (QFileInfo::exists(path))
-			files.append({path, name});
-	}
-	collectDir(loc.profilesDir, QString(), {}, files, options.maxFileSizeBytes, &skipped);
-	collectDir(loc.scenesDir, QString(), {}, files, options.maxFileSizeBytes, &skipped);
-	collectDir(loc.pluginManagerDir, QString(), {}, files, options.maxFileSizeBytes, &skipped);
-	if (options.includePluginConfig)
-		collectDir(loc.pluginConfigDir, QString(), kExcludedPluginConfigDirs, files, options.maxFileSizeBytes,
-			   &skipped);
-	if (options.includeThemes && !loc.themesDir.isEmpty())
-		collectDir(loc.themesDir, QString(), {}, files, options.maxFileSizeBytes, &skipped);
-
-	for (const auto &entry : files) {
-		estimate.fileCount++;
-		estimate.totalBytes += QFileInfo(entry.first).size();
-	}
-
-	if (options.collectMedia) {
-		for (const MediaReference &ref : ScanMediaReferences(loc)) {
-			if (!ref.exists)
-				continue;
-			if (options.maxFileSizeBytes > 0 && ref.size > options.maxFileSizeBytes) {
-				estimate.largeFileCount++;
-				estimate.largeFileBytes += ref.size;
-				continue;
-			}
-			estimate.fileCount++;
-			estimate.totalBytes += ref.size;
-		}
-	}
-
-	for (const SkippedFile &s : skipped) {
-		estimate.largeFileCount++;
-		estimate.largeFileBytes += s.size;
-	}
-
-	return estimate;
+	return EstimateTree(ResolveLocations(), options);
 }
 
 QString SuggestedFileName()
@@ -700,20 +465,127 @@ void RunAutomaticBackupIfDue()
 	PruneBackups(folder, QStringLiteral("streamup-auto-*.zip"), settings.backupKeepCount);
 
 	settings.backupLastAutoDate = today.toStdString();
+	settings.backupPendingVerify = path.toStdString();
 	StreamUP::SettingsManager::UpdateSettings(settings);
 }
 
-Result CreateBackup(const QString &archivePath, const Options &options, ProgressCallback progress)
+void VerifyPendingAutomaticBackup()
 {
-	Result result;
-	result.archivePath = archivePath;
-	result.credentialsIncluded = options.includeCredentials;
+	const std::string pending = StreamUP::SettingsManager::GetCurrentSettings().backupPendingVerify;
+	const QString path = QString::fromStdString(pending);
+	if (path.isEmpty())
+		return;
+
+	// Cleared before the check rather than after, so an archive that crashes
+	// the verifier is not retried on every launch. This runs on the init
+	// thread, and writing back the whole settings struct from here would undo
+	// anything the UI changed in between, so the key is cleared on the UI
+	// thread from a fresh read, and flushed before the verify starts.
+	QMetaObject::invokeMethod(
+		qApp,
+		[pending]() {
+			StreamUP::SettingsManager::PluginSettings settings =
+				StreamUP::SettingsManager::GetCurrentSettings();
+			if (settings.backupPendingVerify != pending)
+				return;
+			settings.backupPendingVerify.clear();
+			StreamUP::SettingsManager::UpdateSettings(settings);
+		},
+		Qt::BlockingQueuedConnection);
+	StreamUP::SettingsManager::FlushSettings();
 
+	if (!QFileInfo::exists(path)) {
+		StreamUP::DebugLogger::LogInfoFormat("Backup", "Automatic backup %s is gone, nothing to verify",
+						     path.toUtf8().constData());
+		return;
+	}
+
+	const Zip::DeepVerifyResult verify = Zip::VerifyArchiveDeep(path);
+	if (verify.success) {
+		StreamUP::DebugLogger::LogInfoFormat(
+			"Backup", "Deep-verified %s: %d entries, %lld bytes in %lld ms (%.1f MB/s, %d workers)",
+			QFileInfo(path).fileName().toUtf8().constData(), verify.entriesChecked,
+			(long long)verify.bytesInflated, (long long)verify.elapsedMs, verify.megabytesPerSecond(),
+			verify.workers);
+		return;
+	}
+
+	StreamUP::DebugLogger::LogErrorFormat("Backup", "Automatic backup %s is damaged at %s: %s",
+					      path.toUtf8().constData(),
+					      verify.firstCorruptEntry.toUtf8().constData(),
+					      verify.error.toUtf8().constData());
+
+	const QString fileName = QFileInfo(path).fileName();
+	StreamUP::UIHelpers::ShowDialogOnUIThread([fileName]() {
+		StreamUP::NotificationManager::SendWarningNotification(
+			obs_module_text("Backup.Verify.Corrupt.Title"),
+			QString::fromUtf8(obs_module_text("Backup.Verify.Corrupt.Message")).arg(fileName));
+	});
+}
+
+QString FindReusableAutomaticBackup(const Options &options)
+{
+	const QString folder = ResolveBackupFolder();
 	const Locations loc = ResolveLocations();
-	if (!loc.valid()) {
-		result.error = QStringLiteral("Could not work out where OBS keeps its configuration");
-		return result;
+	if (folder.isEmpty() || !loc.valid())
+		return {};
+
+	// Automatic backups are stamped with the date, so today's is found by
+	// name. Newest first in case the day has more than one.
+	const QString today = QDate::currentDate().toString(Qt::ISODate);
+	const QFileInfoList candidates = QDir(folder).entryInfoList(
+		{QStringLiteral("streamup-auto-%1-*.zip").arg(today)}, QDir::Files, QDir::Time);
+	if (candidates.isEmpty())
+		return {};
+
+	// The same flushes as PrepareBackup, so the comparison is against what is
+	// on screen rather than the last save
+	StreamUP::SettingsManager::FlushSettings();
+	if (obs_frontend_get_app_config())
+		obs_frontend_save();
+
+	QList<QPair<QString, QString>> files;
+	collectConfigFiles(loc, options, files, nullptr, nullptr, false);
+	const QString ownSettings = ownSettingsArchiveName(loc);
+
+	for (const QFileInfo &candidate : candidates) {
+		Zip::Reader reader;
+		if (!reader.open(candidate.absoluteFilePath()))
+			continue;
+		const QJsonObject manifest =
+			QJsonDocument::fromJson(reader.readFile(QStringLiteral("streamup-backup.json"))).object();
+
+		const bool matches = ArchiveMatchesTree(files, options, ownSettings, reader, manifest,
+							candidate.lastModified());
+		if (!matches) {
+			StreamUP::DebugLogger::LogDebugFormat("Backup", "Reuse", "%s does not match the current config",
+							      candidate.fileName().toUtf8().constData());
+			continue;
+		}
+
+		// The comparison says the contents are right; this says the archive
+		// still holds everything its manifest lists.
+		QString verifyError;
+		const int listed = manifest.value(QStringLiteral("files")).toArray().size();
+		if (!Zip::VerifyArchive(candidate.absoluteFilePath(), listed + 1, &verifyError)) {
+			StreamUP::DebugLogger::LogWarningFormat("Backup", "Not reusing %s: %s",
+								candidate.fileName().toUtf8().constData(),
+								verifyError.toUtf8().constData());
+			continue;
+		}
+		return candidate.absoluteFilePath();
 	}
+	return {};
+}
+
+Locations PrepareBackup()
+{
+	const Locations loc = ResolveLocations();
+	if (!loc.valid())
+		return loc;
+
+	// Our own configs.json is written behind; get the latest save on disk
+	StreamUP::SettingsManager::FlushSettings();
 
 	// OBS only flushes config on save, so without this the archive holds the
 	// last flush rather than what is on screen right now. During shutdown the
@@ -721,60 +593,38 @@ Result CreateBackup(const QString &archivePath, const Options &options, Progress
 	if (obs_frontend_get_app_config())
 		obs_frontend_save();
 
+	return loc;
+}
+
+Result CreateBackup(const QString &archivePath, const Options &options, ProgressCallback progress)
+{
+	return WriteBackup(PrepareBackup(), archivePath, options, std::move(progress));
+}
+
+Result WriteBackup(const Locations &loc, const QString &archivePath, const Options &options, ProgressCallback progress)
+{
+	STREAMUP_TRACE_SCOPE("Backup::WriteBackup");
+
+	Result result;
+	result.archivePath = archivePath;
+	result.credentialsIncluded = options.includeCredentials;
+
+	if (!loc.valid()) {
+		result.error = QStringLiteral("Could not work out where OBS keeps its configuration");
+		return result;
+	}
+
 	// Build the file list first so progress can be reported against a total,
 	// and so each area's count can be logged and checked before anything is
 	// written.
 	QList<QPair<QString, QString>> files;
 	QList<QPair<QString, int>> areaCounts;
+	collectConfigFiles(loc, options, files, &result.skippedLargeFiles, &areaCounts, true);
 
-	// Collect one area and record how many files it contributed. An area whose
-	// source directory exists but yields nothing is a bug, not a quiet no-op,
-	// so it gets logged as a warning.
-	auto addArea = [&](const QString &label, const QString &sourceDir, const QString &prefix,
-			   const QStringList &skip) {
-		const int before = files.size();
-		collectDir(sourceDir, prefix, skip, files, options.maxFileSizeBytes, &result.skippedLargeFiles);
-		const int added = files.size() - before;
-		areaCounts.append({label, added});
-
-		if (sourceDir.isEmpty()) {
-			StreamUP::DebugLogger::LogInfoFormat("Backup", "%-15s skipped (no path resolved)",
-							     label.toUtf8().constData());
-		} else if (added == 0 && QDir(sourceDir).exists()) {
-			StreamUP::DebugLogger::LogWarningFormat(
-				"Backup", "%s: 0 files collected from %s, which exists. This is unexpected.",
-				label.toUtf8().constData(), sourceDir.toUtf8().constData());
-		} else {
-			StreamUP::DebugLogger::LogInfoFormat("Backup", "%-15s %d files from %s",
-							     label.toUtf8().constData(), added,
-							     sourceDir.toUtf8().constData());
-		}
-	};
-
-	int rootFiles = 0;
-	for (const QString &name : {QStringLiteral("global.ini"), QStringLiteral("user.ini")}) {
-		const QString path = loc.configDir + QStringLiteral("/") + name;
-		if (QFileInfo::exists(path)) {
-			files.append({path, QStringLiteral("config/") + name});
-			rootFiles++;
-		} else {
-			StreamUP::DebugLogger::LogWarningFormat("Backup", "%s not found at %s",
-								name.toUtf8().constData(),
-								path.toUtf8().constData());
-		}
-	}
-	areaCounts.append({QStringLiteral("config root"), rootFiles});
-
-	addArea(QStringLiteral("profiles"), loc.profilesDir, QStringLiteral("config/basic/profiles/"), {});
-	addArea(QStringLiteral("scenes"), loc.scenesDir, QStringLiteral("config/basic/scenes/"), {});
-	addArea(QStringLiteral("plugin_manager"), loc.pluginManagerDir, QStringLiteral("config/plugin_manager/"), {});
-
-	if (options.includePluginConfig)
-		addArea(QStringLiteral("plugin_config"), loc.pluginConfigDir, QStringLiteral("config/plugin_config/"),
-			kExcludedPluginConfigDirs);
-
-	if (options.includeThemes)
-		addArea(QStringLiteral("themes"), loc.themesDir, QStringLiteral("themes/"), {});
+	// Taken before media is added: it describes the config tree, which is what
+	// a later restore compares against to decide whether this archive can
+	// stand in for a fresh safety backup.
+	const QString fingerprint = FingerprintFiles(files, options, ownSettingsArchiveName(loc));
 
 	const QList<MediaReference> media = ScanMediaReferences(loc);
 	result.mediaReferenced = media.size();
@@ -788,89 +638,8 @@ Result CreateBackup(const QString &archivePath, const Options &options, Progress
 			files.append({ref.path, ref.archiveName});
 	}
 
-	Zip::Writer zip;
-	if (!zip.open(archivePath)) {
-		result.error = zip.lastError();
-		return result;
-	}
-
-	const int total = files.size() + 1; // +1 for the manifest
-	int done = 0;
-	QJsonArray fileList;
-
-	for (const QPair<QString, QString> &entry : files) {
-		if (progress && !progress(QFileInfo(entry.first).fileName(), done, total)) {
-			zip.close();
-			QFile::remove(archivePath);
-			result.error = QStringLiteral("Cancelled");
-			return result;
-		}
-
-		const QString name = QFileInfo(entry.first).fileName();
-		bool wrote = false;
-
-		// Credential-bearing files get filtered on the way in unless the user
-		// asked for a full-fidelity backup.
-		if (!options.includeCredentials && entry.second.startsWith(QStringLiteral("config/basic/profiles/"))) {
-			QFile in(entry.first);
-			if (in.open(QIODevice::ReadOnly)) {
-				const QByteArray raw = in.readAll();
-				in.close();
-				bool stripped = false;
-				QByteArray filtered = raw;
-				if (name.compare(QStringLiteral("service.json"), Qt::CaseInsensitive) == 0)
-					filtered = stripServiceJson(raw, &stripped);
-				else if (name.compare(QStringLiteral("basic.ini"), Qt::CaseInsensitive) == 0)
-					filtered = stripBasicIni(raw, &stripped);
-
-				if (stripped) {
-					wrote = zip.addData(filtered, entry.second);
-					StreamUP::DebugLogger::LogDebugFormat(
-						"Backup", "Credentials", "Stripped secrets from %s",
-						entry.second.toUtf8().constData());
-				}
-			}
-		}
-
-		if (!wrote) {
-			// Chunk callback keeps the UI alive inside a single large file.
-			// Without it, one big file looks like a hang, which is exactly
-			// what a multi-gigabyte model file used to do.
-			const qint64 fileSize = QFileInfo(entry.first).size();
-			wrote = zip.addFile(entry.first, entry.second,
-					    [&](qint64 doneBytes, qint64 totalBytes) {
-						    if (!progress || totalBytes < 8 * 1024 * 1024)
-							    return true;
-						    const QString label =
-							    QStringLiteral("%1 (%2 of %3 MB)")
-								    .arg(name)
-								    .arg(doneBytes / (1024 * 1024))
-								    .arg(totalBytes / (1024 * 1024));
-						    return progress(label, done, total);
-					    });
-			Q_UNUSED(fileSize);
-		}
-
-		if (!wrote) {
-			// A single unreadable file (locked, permissions) should not sink
-			// the whole backup; note it and carry on.
-			StreamUP::DebugLogger::LogWarning("Backup", QStringLiteral("Skipped %1: %2")
-									  .arg(entry.first, zip.lastError())
-									  .toUtf8()
-									  .constData());
-			done++;
-			continue;
-		}
-
-		if (entry.second.startsWith(QStringLiteral("media/")))
-			result.mediaCollected++;
-
-		fileList.append(entry.second);
-		result.fileCount++;
-		done++;
-	}
-
 	// Manifest: what this backup is, what it came from, and what it points at.
+	// WriteArchive adds the list of files it actually wrote.
 	QJsonObject manifest;
 	manifest[QStringLiteral("format")] = 1;
 	manifest[QStringLiteral("created")] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
@@ -899,8 +668,9 @@ Result CreateBackup(const QString &archivePath, const Options &options, Progress
 
 	manifest[QStringLiteral("credentials_included")] = options.includeCredentials;
 	manifest[QStringLiteral("media_collected")] = options.collectMedia;
+	manifest[QStringLiteral("config_fingerprint")] = fingerprint;
+	manifest[QStringLiteral("options_fingerprint")] = OptionsFingerprint(options);
 	manifest[QStringLiteral("plugins")] = pluginInventory();
-	manifest[QStringLiteral("files")] = fileList;
 
 	QJsonArray mediaArray;
 	for (const MediaReference &ref : media) {
@@ -932,29 +702,24 @@ Result CreateBackup(const QString &archivePath, const Options &options, Progress
 	manifest[QStringLiteral("skipped_large_files")] = skippedArray;
 	manifest[QStringLiteral("max_file_size_bytes")] = options.maxFileSizeBytes;
 
-	if (!zip.addData(QJsonDocument(manifest).toJson(QJsonDocument::Indented),
-			 QStringLiteral("streamup-backup.json"))) {
-		result.error = zip.lastError();
-		zip.close();
-		return result;
-	}
-
-	if (progress)
-		progress(QStringLiteral("streamup-backup.json"), total, total);
-
-	result.archiveBytes = zip.bytesWritten();
-	if (!zip.close()) {
-		result.error = zip.lastError();
-		return result;
-	}
-
-	// Read the archive back before calling it a success. A backup that is
-	// quietly truncated is worth less than no backup at all, because it is
-	// trusted right up until the moment it is needed.
-	QString verifyError;
-	if (!Zip::VerifyArchive(archivePath, result.fileCount + 1, &verifyError)) {
-		result.error = QStringLiteral("Backup could not be verified: %1").arg(verifyError);
-		StreamUP::DebugLogger::LogError("Backup", result.error.toUtf8().constData());
+	const ArchiveWritten written = WriteArchive(archivePath, files, manifest, options, progress);
+
+	for (const QString &name : written.credentialsStripped)
+		StreamUP::DebugLogger::LogDebugFormat("Backup", "Credentials", "Stripped secrets from %s",
+						      name.toUtf8().constData());
+	for (const auto &unreadable : written.unreadable)
+		StreamUP::DebugLogger::LogWarning("Backup", QStringLiteral("Skipped %1: %2")
+								  .arg(unreadable.first, unreadable.second)
+								  .toUtf8()
+								  .constData());
+
+	result.fileCount = written.fileCount;
+	result.mediaCollected = written.mediaCollected;
+	result.archiveBytes = written.archiveBytes;
+	if (!written.success) {
+		result.error = written.error;
+		if (written.error != QStringLiteral("Cancelled"))
+			StreamUP::DebugLogger::LogError("Backup", result.error.toUtf8().constData());
 		return result;
 	}
 
@@ -113,12 +113,32 @@ Locations ResolveLocations();
  */
 QList<MediaReference> ScanMediaReferences(const Locations &locations);
 
+/** The same scan for a single scene collection file, for callers that track collections one by one. */
+QList<MediaReference> ScanCollectionMedia(const QString &collectionPath);
+
 /**
  * Write a backup archive. Forces OBS to save first so the archive holds current
  * state rather than the last flush.
  */
 Result CreateBackup(const QString &archivePath, const Options &options, ProgressCallback progress = nullptr);
 
+/**
+ * CreateBackup in two halves, for running the archive off the UI thread.
+ * PrepareBackup resolves the locations and saves OBS and our settings, which
+ * has to happen on the UI thread. WriteBackup does everything else and can
+ * run anywhere; an invalid Locations fails it with the usual error.
+ */
+Locations PrepareBackup();
+Result WriteBackup(const Locations &locations, const QString &archivePath, const Options &options,
+		   ProgressCallback progress = nullptr);
+
+/**
+ * Today's automatic backup, if one exists and its recorded fingerprint still
+ * matches the tree, so it can stand in for a new backup taken with the same
+ * options. Empty when there is none or anything has changed since.
+ */
+QString FindReusableAutomaticBackup(const Options &options);
+
 /** Default file name for a new backup, e.g. streamup-backup-2026-08-05-0914.zip */
 QString SuggestedFileName();
 
@@ -145,6 +165,17 @@ int PruneBackups(const QString &folder, const QString &pattern, int keep);
  */
 void RunAutomaticBackupIfDue();
 
+/**
+ * Deep-verify the automatic backup written at the end of the last session.
+ *
+ * The shutdown path only does the cheap structural check, because inflating
+ * every entry there would hold OBS open and the module is unloaded straight
+ * after, so a thread cannot outlive it. The archive is remembered instead and
+ * checked here, off the UI thread, as soon as OBS has finished loading. A
+ * corrupt archive is logged and raised as a notification.
+ */
+void VerifyPendingAutomaticBackup();
+
 } // namespace Backup
 } // namespace StreamUP
 
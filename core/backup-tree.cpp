@@ -0,0 +1,180 @@
+#include "backup-tree.hpp"
+
+#include "../utilities/zip-reader.hpp"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <zlib.h>
+
+#include <algorithm>
+
+namespace StreamUP {
+namespace Backup {
+
+namespace {
+
+// Chromium cache under plugin_config/obs-browser is by far the biggest thing in
+// an OBS config tree (333 MB of Cache plus 122 MB of Code Cache on the machine
+// this was measured on) and every byte of it regenerates. Backing it up turns a
+// 4 MB archive into a 563 MB one for no benefit.
+const QStringList kExcludedPluginConfigDirs = {QStringLiteral("obs-browser")};
+
+// Keys in our configs.json that record backups rather than configure anything.
+// RunAutomaticBackupIfDue sets them right after its archive is written and the
+// next launch clears one again, so they never match the archive's copy.
+const QStringList kBookkeepingKeys = {QStringLiteral("backup_last_auto"), QStringLiteral("backup_pending_verify")};
+
+quint32 crcOfFile(const QString &path, bool *ok)
+{
+	*ok = false;
+	QFile in(path);
+	if (!in.open(QIODevice::ReadOnly))
+		return 0;
+
+	quint32 crc = crc32(0, nullptr, 0);
+	QByteArray buffer(128 * 1024, Qt::Uninitialized);
+	qint64 got = 0;
+	while ((got = in.read(buffer.data(), buffer.size())) > 0)
+		crc = crc32(crc, reinterpret_cast<const Bytef *>(buffer.constData()), static_cast<uInt>(got));
+	*ok = got == 0;
+	return crc;
+}
+
+QJsonObject withoutBookkeeping(const QByteArray &json)
+{
+	QJsonObject root = QJsonDocument::fromJson(json).object();
+	for (const QString &key : kBookkeepingKeys)
+		root.remove(key);
+	return root;
+}
+
+bool ownSettingsMatch(const QString &path, Zip::Reader &reader, const QString &name)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	return withoutBookkeeping(file.readAll()) == withoutBookkeeping(reader.readFile(name));
+}
+
+/**
+ * The per-file comparison: the same set of names, the same sizes, and for
+ * anything modified after the archive was written, the same CRC as the entry
+ * recorded. Files untouched since are taken on their mtime, so this only reads
+ * what was actually rewritten.
+ */
+bool treeMatchesArchive(const QList<QPair<QString, QString>> &files, const QString &ownSettingsName,
+			Zip::Reader &reader, const QDateTime &archiveWritten)
+{
+	// Everything in the archive bar the manifest.
+	if (files.size() != reader.entryCount() - 1)
+		return false;
+
+	for (const QPair<QString, QString> &entry : files) {
+		const int index = reader.indexOf(entry.second);
+		if (index < 0)
+			return false;
+		if (entry.second == ownSettingsName) {
+			if (!ownSettingsMatch(entry.first, reader, entry.second))
+				return false;
+			continue;
+		}
+
+		const Zip::Reader::Entry &recorded = reader.entryAt(index);
+		const QFileInfo info(entry.first);
+		if (static_cast<quint64>(info.size()) != recorded.uncompressedSize)
+			return false;
+		if (info.lastModified() <= archiveWritten)
+			continue;
+
+		bool ok = false;
+		if (crcOfFile(entry.first, &ok) != recorded.crc || !ok)
+			return false;
+	}
+	return true;
+}
+
+} // namespace
+
+bool IsBackupCandidate(const QFileInfo &info)
+{
+	// OBS writes .bak beside its own files; the live file is what we want.
+	if (info.suffix().compare(QStringLiteral("bak"), Qt::CaseInsensitive) == 0)
+		return false;
+
+	// Runtime state, not configuration. Plugins drop lock and sentinel
+	// files next to their settings (advanced-scene-switcher leaves a
+	// ".running"), and restoring a stale one tells that plugin it is
+	// already running, or tells OBS it crashed. Same reasoning as leaving
+	// out the config root's own .sentinel and safe_mode.
+	static const QStringList runtimeState = {QStringLiteral(".running"), QStringLiteral(".lock"),
+						 QStringLiteral(".sentinel"), QStringLiteral("safe_mode")};
+	return !runtimeState.contains(info.fileName(), Qt::CaseInsensitive) &&
+	       info.suffix().compare(QStringLiteral("lock"), Qt::CaseInsensitive) != 0;
+}
+
+QStringList ExcludedPluginConfigDirs()
+{
+	return kExcludedPluginConfigDirs;
+}
+
+QString OptionsFingerprint(const Options &options)
+{
+	return QStringLiteral("%1|%2|%3|%4|%5")
+		.arg(options.includeCredentials)
+		.arg(options.collectMedia)
+		.arg(options.includeThemes)
+		.arg(options.includePluginConfig)
+		.arg(options.maxFileSizeBytes);
+}
+
+QString FingerprintFiles(const QList<QPair<QString, QString>> &files, const Options &options,
+			 const QString &ownSettingsName)
+{
+	QList<QPair<QString, QString>> sorted = files;
+	std::sort(sorted.begin(), sorted.end(),
+		  [](const QPair<QString, QString> &a, const QPair<QString, QString> &b) { return a.second < b.second; });
+
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(OptionsFingerprint(options).toUtf8());
+	for (const QPair<QString, QString> &entry : sorted) {
+		if (entry.second == ownSettingsName)
+			continue;
+		const QFileInfo info(entry.first);
+		hash.addData(QStringLiteral("\n%1|%2|%3")
+				     .arg(entry.second)
+				     .arg(info.size())
+				     .arg(info.lastModified().toMSecsSinceEpoch())
+				     .toUtf8());
+	}
+	return QString::fromLatin1(hash.result().toHex());
+}
+
+bool ArchiveMatchesTree(const QList<QPair<QString, QString>> &files, const Options &options,
+			const QString &ownSettingsName, Zip::Reader &reader, const QJsonObject &manifest,
+			const QDateTime &archiveWritten)
+{
+	const QString recorded = manifest.value(QStringLiteral("config_fingerprint")).toString();
+	if (recorded.isEmpty())
+		return false;
+
+	// An equal fingerprint means every other file is as archived, so only our
+	// settings are left to compare. The save before a restore rewrites the
+	// scene collection and bumps its mtime even when nothing changed, though,
+	// so a miss falls back to the per-file comparison.
+	if (recorded == FingerprintFiles(files, options, ownSettingsName)) {
+		for (const QPair<QString, QString> &entry : files) {
+			if (entry.second == ownSettingsName)
+				return ownSettingsMatch(entry.first, reader, entry.second);
+		}
+		return true;
+	}
+
+	if (manifest.value(QStringLiteral("options_fingerprint")).toString() != OptionsFingerprint(options))
+		return false;
+	return treeMatchesArchive(files, ownSettingsName, reader, archiveWritten);
+}
+
+} // namespace Backup
+} // namespace StreamUP
@@ -0,0 +1,64 @@
+#ifndef STREAMUP_BACKUP_TREE_HPP
+#define STREAMUP_BACKUP_TREE_HPP
+
+#include "backup-manager.hpp"
+
+#include <QDateTime>
+#include <QJsonObject>
+#include <QList>
+#include <QPair>
+
+class QFileInfo;
+
+namespace StreamUP {
+namespace Zip {
+class Reader;
+}
+
+namespace Backup {
+
+/*
+ * What a backup covers and whether an existing archive still holds it. Kept
+ * apart from backup-manager.cpp and free of OBS so the standalone backup
+ * benchmark builds the same rules instead of a copy of them.
+ */
+
+/**
+ * Whether a file found while walking a config area belongs in a backup: not an
+ * OBS .bak and not a plugin's runtime lock or sentinel. Size is judged apart.
+ */
+bool IsBackupCandidate(const QFileInfo &info);
+
+/** Folder names under plugin_config that a backup never descends into. */
+QStringList ExcludedPluginConfigDirs();
+
+/** The options that shape an archive's contents, as a short comparable key. */
+QString OptionsFingerprint(const Options &options);
+
+/**
+ * Hash of what a backup would capture: the options that shape it, then every
+ * file's archive name, size and modification time. A stat per file and nothing
+ * read. Our own settings file, named by `ownSettingsName`, is left out: the
+ * automatic backup rewrites it straight after writing the archive.
+ */
+QString FingerprintFiles(const QList<QPair<QString, QString>> &files, const Options &options,
+			 const QString &ownSettingsName);
+
+/**
+ * Whether an archive holds exactly these (absolute path, archive name) files
+ * as they are now, so it can stand in for a fresh backup with these options.
+ *
+ * The manifest's fingerprint is tried first. Failing that, with the same
+ * options, every file's size is compared and anything modified since the
+ * archive was written is checked against the entry's CRC. Our own settings
+ * file is compared as JSON with the backup bookkeeping keys left out, since
+ * recording the backup is itself a change to it.
+ */
+bool ArchiveMatchesTree(const QList<QPair<QString, QString>> &files, const Options &options,
+			const QString &ownSettingsName, Zip::Reader &reader, const QJsonObject &manifest,
+			const QDateTime &archiveWritten);
+
+} // namespace Backup
+} // namespace StreamUP
+
+#endif // STREAMUP_BACKUP_TREE_HPP
@@ -1,5 +1,6 @@
 #include "plugin-manager.hpp"
 #include <streamup/debug-logger.hpp>
+#include <streamup/trace.hpp>
 #include "streamup-common.hpp"
 #include "plugin-state.hpp"
 #include "string-utils.hpp"
@@ -906,6 +907,7 @@ void PluginsHaveIssue(const std::map<std::string, std::string>& missing_modules,
 //-------------------PLUGIN UPDATE FUNCTIONS-------------------
 void CheckAllPluginsForUpdates(bool manuallyTriggered)
 {
+	STREAMUP_TRACE_SCOPE("PluginManager::CheckAllPluginsForUpdates");
 	const auto& allPlugins = StreamUP::GetAllPlugins();
 	if (allPlugins.empty()) {
 		ErrorDialog(obs_module_text("Plugin.Error.LoadIssue"));
@@ -1034,6 +1036,7 @@ void InitialiseRequiredModules()
 
 bool CheckrequiredOBSPluginsWithoutUI(bool isLoadStreamUpFile)
 {
+	STREAMUP_TRACE_SCOPE("PluginManager::CheckrequiredOBSPluginsWithoutUI");
 	UNUSED_PARAMETER(isLoadStreamUpFile);
 	const auto& requiredPlugins = StreamUP::GetRequiredPlugins();
 	if (requiredPlugins.empty()) {
@@ -1089,6 +1092,7 @@ bool CheckrequiredOBSPluginsWithoutUI(bool isLoadStreamUpFile)
 
 bool CheckrequiredOBSPlugins(bool isLoadStreamUpFile)
 {
+	STREAMUP_TRACE_SCOPE("PluginManager::CheckrequiredOBSPlugins");
 	const auto& requiredPlugins = StreamUP::GetRequiredPlugins();
 	if (requiredPlugins.empty()) {
 		ErrorDialog(obs_module_text("Plugin.Error.LoadIssue"));
@@ -1733,6 +1737,7 @@ std::vector<std::pair<std::string, std::string>> GetInstalledPlugins()
 //-------------------EFFICIENT CACHING FUNCTIONS-------------------
 void PerformPluginCheckAndCache(bool checkAllPlugins)
 {
+	STREAMUP_TRACE_SCOPE("PluginManager::PerformPluginCheckAndCache");
 	const auto& pluginsToCheck = checkAllPlugins ? StreamUP::GetAllPlugins() : StreamUP::GetRequiredPlugins();
 	if (pluginsToCheck.empty()) {
 		return;
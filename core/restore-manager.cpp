@@ -1,6 +1,8 @@
 #include "restore-manager.hpp"
+#include "restore-staging.hpp"
 
 #include <streamup/debug-logger.hpp>
+#include <streamup/trace.hpp>
 #include "../utilities/zip-reader.hpp"
 #include "backup-manager.hpp"
 #include "../ui/settings-manager.hpp"
@@ -10,7 +12,6 @@
 #include <obs.h>
 #include <util/platform.h>
 
-#include <QCryptographicHash>
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
@@ -21,6 +22,10 @@
 #include <QMap>
 #include <QSet>
 
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
 namespace StreamUP {
 namespace Restore {
 
@@ -73,17 +78,6 @@ bool writeJson(const QString &path, const QJsonObject &obj)
 	return true;
 }
 
-QString sha1Of(const QString &path)
-{
-	QFile f(path);
-	if (!f.open(QIODevice::ReadOnly))
-		return {};
-	QCryptographicHash hash(QCryptographicHash::Sha1);
-	hash.addData(&f);
-	f.close();
-	return QString::fromLatin1(hash.result().toHex());
-}
-
 void removeDirectory(const QString &path)
 {
 	QDir dir(path);
@@ -296,40 +290,45 @@ Inspection Inspect(const QString &archivePath)
 	result.credentialsIncluded = manifest.value(QStringLiteral("credentials_included")).toBool();
 	result.mediaCollected = manifest.value(QStringLiteral("media_collected")).toBool();
 
-	const QStringList names = reader.entryNames();
-	result.totalFiles = names.size();
+	result.totalFiles = reader.entryCount();
 
 	// Plugin settings and themes are counted per folder, not per file: "115
 	// files" means nothing to a user, "advanced-scene-switcher (3 files)" does.
 	QMap<QString, int> pluginFileCounts;
 	QMap<QString, int> themeFileCounts;
 
-	for (const QString &name : names) {
-		if (name.startsWith(QStringLiteral("config/basic/scenes/")) && name.endsWith(QStringLiteral(".json"))) {
+	// Classified straight off the reader's name bytes. A media-collected backup
+	// can hold 100k+ entries and almost all of them only need a prefix test,
+	// so a name is decoded only when part of it is kept.
+	auto firstSegment = [](QByteArrayView rest) {
+		const auto slash = std::find(rest.begin(), rest.end(), '/');
+		return QString::fromUtf8(rest.first(slash - rest.begin()));
+	};
+
+	for (int i = 0; i < reader.entryCount(); ++i) {
+		const QByteArrayView name = reader.entryNameBytes(i);
+		if (name.startsWith("config/basic/scenes/") && name.endsWith(".json")) {
 			result.sceneCollections++;
-			result.sceneCollectionNames << QFileInfo(name).completeBaseName();
-		} else if (name.startsWith(QStringLiteral("config/basic/profiles/"))) {
-			const QString rest = name.mid(QStringLiteral("config/basic/profiles/").size());
-			const QString profile = rest.section(QLatin1Char('/'), 0, 0);
+			result.sceneCollectionNames << QFileInfo(QString::fromUtf8(name)).completeBaseName();
+		} else if (name.startsWith("config/basic/profiles/")) {
+			const QString profile = firstSegment(name.sliced(qstrlen("config/basic/profiles/")));
 			if (!profile.isEmpty() && !result.profileNames.contains(profile)) {
 				result.profileNames << profile;
 				result.profiles++;
 			}
-		} else if (name.startsWith(QStringLiteral("config/plugin_config/"))) {
+		} else if (name.startsWith("config/plugin_config/")) {
 			result.pluginConfigFiles++;
-			const QString rest = name.mid(QStringLiteral("config/plugin_config/").size());
-			const QString plugin = rest.section(QLatin1Char('/'), 0, 0);
+			const QString plugin = firstSegment(name.sliced(qstrlen("config/plugin_config/")));
 			if (!plugin.isEmpty())
 				pluginFileCounts[plugin]++;
-		} else if (name.startsWith(QStringLiteral("themes/"))) {
+		} else if (name.startsWith("themes/")) {
 			result.themeFiles++;
-			const QString rest = name.mid(QStringLiteral("themes/").size());
-			// A theme is either a single .obt/.ovt file or a folder of assets.
-			const QString theme = rest.contains(QLatin1Char('/')) ? rest.section(QLatin1Char('/'), 0, 0)
-									      : rest;
+			// A theme is either a single .obt/.ovt file or a folder of assets,
+			// and the first segment covers both.
+			const QString theme = firstSegment(name.sliced(qstrlen("themes/")));
 			if (!theme.isEmpty())
 				themeFileCounts[theme]++;
-		} else if (name.startsWith(QStringLiteral("media/"))) {
+		} else if (name.startsWith("media/")) {
 			result.mediaFiles++;
 		}
 	}
@@ -373,6 +372,8 @@ Inspection Inspect(const QString &archivePath)
 bool Stage(const QString &archivePath, QString *error, QString *safetyBackupPath, ProgressCallback progress,
 	   const Selection &selection)
 {
+	STREAMUP_TRACE_SCOPE("Restore::Stage");
+
 	auto reportError = [error](const QString &reason) {
 		if (error)
 			*error = reason;
@@ -404,25 +405,55 @@ bool Stage(const QString &archivePath, QString *error, QString *safetyBackupPath
 	safetyOptions.includeCredentials = true; // it is going back to this machine only
 	safetyOptions.collectMedia = false;
 
-	// The safety backup is the slowest part of staging, so it reports through
-	// the same progress channel rather than looking like a freeze.
-	const Backup::Result safety =
-		Backup::CreateBackup(safetyPath, safetyOptions, [&](const QString &file, int done, int total) {
-			if (!progress)
-				return true;
-			return progress(QStringLiteral("Saving current setup: %1").arg(file), done, total);
-		});
-	if (!safety.success)
-		return reportError(QStringLiteral("Could not take a safety backup first: %1").arg(safety.error));
+	// A full safety backup is the slowest part of staging. When today's
+	// automatic backup was taken with the same options and nothing in the tree
+	// has changed since, it already is that backup, so it is hardlinked into
+	// place (or, where links are not possible, copied) instead of compressing
+	// everything again. Never pointed at directly: pruning automatic backups
+	// would take the safety backup with it.
+	QString safetyWritten;
+	const QString reusable = Backup::FindReusableAutomaticBackup(safetyOptions);
+	if (!reusable.isEmpty()) {
+		std::error_code linkError;
+		std::filesystem::create_hard_link(std::filesystem::path(reusable.toStdU16String()),
+						  std::filesystem::path(safetyPath.toStdU16String()), linkError);
+		if (!linkError) {
+			safetyWritten = safetyPath;
+		} else {
+			StreamUP::DebugLogger::LogInfoFormat("Restore", "Could not link %s (%s), copying it instead",
+							     QFileInfo(reusable).fileName().toUtf8().constData(),
+							     linkError.message().c_str());
+			if (QFile::copy(reusable, safetyPath))
+				safetyWritten = safetyPath;
+		}
+		if (!safetyWritten.isEmpty())
+			StreamUP::DebugLogger::LogInfoFormat("Restore",
+							     "Config unchanged since %s, reusing it as the safety backup",
+							     QFileInfo(reusable).fileName().toUtf8().constData());
+	}
+
+	if (safetyWritten.isEmpty()) {
+		// Reports through the same progress channel rather than looking like
+		// a freeze.
+		const Backup::Result safety =
+			Backup::CreateBackup(safetyPath, safetyOptions, [&](const QString &file, int done, int total) {
+				if (!progress)
+					return true;
+				return progress(QStringLiteral("Saving current setup: %1").arg(file), done, total);
+			});
+		if (!safety.success)
+			return reportError(QStringLiteral("Could not take a safety backup first: %1").arg(safety.error));
+		safetyWritten = safetyPath;
+	}
 	if (safetyBackupPath)
-		*safetyBackupPath = safetyPath;
+		*safetyBackupPath = safetyWritten;
 	StreamUP::DebugLogger::LogInfoFormat("Restore", "Safety backup written to %s",
-					     safetyPath.toUtf8().constData());
+					     safetyWritten.toUtf8().constData());
 
 	// Safety backups accumulate one per restore and are never cleaned up by
 	// anything else, so they follow the same retention rule as automatic
 	// backups rather than growing without limit.
-	const int keep = StreamUP::SettingsManager::GetCurrentSettings().backupKeepCount;
+	const int keep = StreamUP::SettingsManager::GetSettingsSnapshot()->backupKeepCount;
 	const int pruned = Backup::PruneBackups(safetyDir, QStringLiteral("before-restore-*.zip"), keep);
 	if (pruned > 0)
 		StreamUP::DebugLogger::LogInfoFormat("Restore", "Pruned %d old safety backups", pruned);
@@ -446,48 +477,20 @@ bool Stage(const QString &archivePath, QString *error, QString *safetyBackupPath
 					  : QDir::cleanPath(QDir::fromNativeSeparators(selection.mediaFolder));
 
 	QJsonArray plan;
-	int staged = 0;
-
-	const QStringList allEntries = reader.entryNames();
-	int seen = 0;
-
-	for (const QString &name : allEntries) {
-		seen++;
-		if (progress && (seen % 10 == 0 || seen == allEntries.size())) {
-			if (!progress(QStringLiteral("Unpacking backup: %1").arg(QFileInfo(name).fileName()), seen,
-				      allEntries.size())) {
-				removeDirectory(staging);
-				return reportError(QStringLiteral("Cancelled"));
-			}
-		}
-
-		if (name == QString::fromUtf8(kManifestName))
-			continue;
-
-		if (!wantedBySelection(name, selection))
-			continue;
-
-		QString target;
-		if (name.startsWith(QStringLiteral("media/")))
-			target = mediaRoot + QStringLiteral("/") + name.mid(QStringLiteral("media/").size());
-		else
-			target = targetForEntry(name, loc);
-
-		if (target.isEmpty())
-			continue;
-
-		const QString stagedPath = staging + QStringLiteral("/files/") + name;
-		if (!reader.extractTo(name, stagedPath))
-			return reportError(reader.lastError());
-
-		QJsonObject item;
-		item[QStringLiteral("archive")] = name;
-		item[QStringLiteral("staged")] = stagedPath;
-		item[QStringLiteral("target")] = QDir::cleanPath(target);
-		item[QStringLiteral("sha1")] = sha1Of(stagedPath);
-		plan.append(item);
-		staged++;
-	}
+	QString extractError;
+	const bool extracted = ExtractToStaging(
+		reader, staging,
+		[&](const QString &name) -> QString {
+			if (!wantedBySelection(name, selection))
+				return {};
+			if (name.startsWith(QStringLiteral("media/")))
+				return mediaRoot + QStringLiteral("/") + name.mid(QStringLiteral("media/").size());
+			return targetForEntry(name, loc);
+		},
+		progress, plan, &extractError);
+	if (!extracted)
+		return reportError(extractError);
+	const int staged = plan.size();
 
 	// Rewrite media paths in the staged scene collections so the restored
 	// scenes point at the files we are about to lay down, rather than at
@@ -579,7 +582,7 @@ bool Stage(const QString &archivePath, QString *error, QString *safetyBackupPath
 	QJsonArray finalPlan;
 	for (const QJsonValue value : plan) {
 		QJsonObject item = value.toObject();
-		item[QStringLiteral("sha1")] = sha1Of(item.value(QStringLiteral("staged")).toString());
+		item[QStringLiteral("sha1")] = FileSha1(item.value(QStringLiteral("staged")).toString());
 		finalPlan.append(item);
 	}
 
@@ -587,7 +590,7 @@ bool Stage(const QString &archivePath, QString *error, QString *safetyBackupPath
 	journal[QStringLiteral("version")] = 1;
 	journal[QStringLiteral("staged_at")] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
 	journal[QStringLiteral("source_archive")] = archivePath;
-	journal[QStringLiteral("safety_backup")] = safetyPath;
+	journal[QStringLiteral("safety_backup")] = safetyWritten;
 	journal[QStringLiteral("media_paths_rewritten")] = rewritten;
 	journal[QStringLiteral("media_paths_kept")] = keptInPlace;
 	journal[QStringLiteral("media_folder")] = QDir::cleanPath(mediaRoot);
@@ -684,73 +687,25 @@ static void applyPendingInternal(bool lateCatchUp)
 		if (staged.isEmpty() || target.isEmpty())
 			continue;
 
-		// Already correct? Then there is nothing to do, and crucially nothing
-		// to fail. This makes a retry cheap and stops a second pass reporting
-		// failures for files it restored the first time: by the time the retry
-		// runs at startup, other plugins have their config files open, so
-		// re-copying a file that is already right can fail for no good reason.
-		if (!expected.isEmpty() && QFileInfo::exists(target) && sha1Of(target) == expected) {
+		QString applyError;
+		switch (ApplyStagedFile(staged, target, expected, &applyError)) {
+		case ApplyOutcome::AlreadyInPlace:
 			alreadyInPlace++;
-			continue;
-		}
-
-		if (!QFileInfo::exists(staged)) {
-			if (loggedFailures++ < 20)
-				StreamUP::DebugLogger::LogWarningFormat(
-					"Restore", "Staged file is gone, cannot restore %s",
-					target.toUtf8().constData());
-			failureList.append(target);
-			failed++;
-			continue;
-		}
-
-		QDir().mkpath(QFileInfo(target).absolutePath());
-
-		// Replace atomically enough for our purposes: the old file only goes
-		// once the new one is in place, so an interruption leaves either the
-		// old file or the new one, never a truncated file.
-		const QString incoming = target + QStringLiteral(".streamup-new");
-		QFile::remove(incoming);
-
-		QFile source(staged);
-		if (!source.copy(incoming)) {
+			break;
+		case ApplyOutcome::Applied:
+			applied++;
+			if (appearance)
+				appearanceWritten++;
+			break;
+		case ApplyOutcome::Failed:
 			if (loggedFailures++ < 20)
-				StreamUP::DebugLogger::LogWarningFormat("Restore", "Copy failed for %s: %s",
+				StreamUP::DebugLogger::LogWarningFormat("Restore", "Could not restore %s: %s",
 									target.toUtf8().constData(),
-									source.errorString().toUtf8().constData());
+									applyError.toUtf8().constData());
 			failureList.append(target);
 			failed++;
-			continue;
-		}
-
-		QFile::remove(target);
-		QFile incomingFile(incoming);
-		if (incomingFile.rename(target)) {
-			applied++;
-			if (appearance)
-				appearanceWritten++;
-			continue;
-		}
-
-		// Rename can fail if something grabbed the target between the remove
-		// and the rename. Fall back to writing over it directly rather than
-		// giving up on the file.
-		const QString renameError = incomingFile.errorString();
-		if (QFile::copy(staged, target)) {
-			QFile::remove(incoming);
-			applied++;
-			if (appearance)
-				appearanceWritten++;
-			continue;
+			break;
 		}
-
-		QFile::remove(incoming);
-		if (loggedFailures++ < 20)
-			StreamUP::DebugLogger::LogWarningFormat("Restore", "Could not replace %s: %s",
-								target.toUtf8().constData(),
-								renameError.toUtf8().constData());
-		failureList.append(target);
-		failed++;
 	}
 
 	if (loggedFailures > 20)
@@ -0,0 +1,123 @@
+#include "restore-staging.hpp"
+
+#include "../utilities/zip-reader.hpp"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonObject>
+
+namespace StreamUP {
+namespace Restore {
+
+namespace {
+
+constexpr const char *kManifestName = "streamup-backup.json";
+
+} // namespace
+
+QString FileSha1(const QString &path)
+{
+	QFile f(path);
+	if (!f.open(QIODevice::ReadOnly))
+		return {};
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(&f);
+	f.close();
+	return QString::fromLatin1(hash.result().toHex());
+}
+
+bool ExtractToStaging(Zip::Reader &reader, const QString &staging,
+		      const std::function<QString(const QString &)> &targetFor, const ProgressCallback &progress,
+		      QJsonArray &plan, QString *error)
+{
+	const int entryCount = reader.entryCount();
+
+	for (int i = 0; i < entryCount; ++i) {
+		const int seen = i + 1;
+		const QByteArrayView nameBytes = reader.entryNameBytes(i);
+		if (progress && (seen % 10 == 0 || seen == entryCount)) {
+			const QString shown = QFileInfo(QString::fromUtf8(nameBytes)).fileName();
+			if (!progress(QStringLiteral("Unpacking backup: %1").arg(shown), seen, entryCount)) {
+				QDir(staging).removeRecursively();
+				if (error)
+					*error = QStringLiteral("Cancelled");
+				return false;
+			}
+		}
+
+		if (nameBytes == QByteArrayView(kManifestName))
+			continue;
+
+		const QString name = QString::fromUtf8(nameBytes);
+		const QString target = targetFor(name);
+		if (target.isEmpty())
+			continue;
+
+		const QString stagedPath = staging + QStringLiteral("/files/") + name;
+		if (!reader.extractTo(i, stagedPath)) {
+			if (error)
+				*error = reader.lastError();
+			return false;
+		}
+
+		QJsonObject item;
+		item[QStringLiteral("archive")] = name;
+		item[QStringLiteral("staged")] = stagedPath;
+		item[QStringLiteral("target")] = QDir::cleanPath(target);
+		item[QStringLiteral("sha1")] = FileSha1(stagedPath);
+		plan.append(item);
+	}
+	return true;
+}
+
+ApplyOutcome ApplyStagedFile(const QString &staged, const QString &target, const QString &expectedSha1,
+			     QString *error)
+{
+	// Already correct? Then there is nothing to do, and crucially nothing
+	// to fail. This makes a retry cheap and stops a second pass reporting
+	// failures for files it restored the first time: by the time the retry
+	// runs at startup, other plugins have their config files open, so
+	// re-copying a file that is already right can fail for no good reason.
+	if (!expectedSha1.isEmpty() && QFileInfo::exists(target) && FileSha1(target) == expectedSha1)
+		return ApplyOutcome::AlreadyInPlace;
+
+	if (!QFileInfo::exists(staged)) {
+		if (error)
+			*error = QStringLiteral("the staged file is gone");
+		return ApplyOutcome::Failed;
+	}
+
+	QDir().mkpath(QFileInfo(target).absolutePath());
+
+	const QString incoming = target + QStringLiteral(".streamup-new");
+	QFile::remove(incoming);
+
+	QFile source(staged);
+	if (!source.copy(incoming)) {
+		if (error)
+			*error = QStringLiteral("copy failed: %1").arg(source.errorString());
+		return ApplyOutcome::Failed;
+	}
+
+	QFile::remove(target);
+	QFile incomingFile(incoming);
+	if (incomingFile.rename(target))
+		return ApplyOutcome::Applied;
+
+	// Rename can fail if something grabbed the target between the remove
+	// and the rename. Fall back to writing over it directly rather than
+	// giving up on the file.
+	const QString renameError = incomingFile.errorString();
+	QFile::remove(incoming);
+	if (QFile::copy(staged, target))
+		return ApplyOutcome::Applied;
+
+	if (error)
+		*error = QStringLiteral("could not replace it: %1").arg(renameError);
+	return ApplyOutcome::Failed;
+}
+
+} // namespace Restore
+} // namespace StreamUP
@@ -0,0 +1,57 @@
+#ifndef STREAMUP_RESTORE_STAGING_HPP
+#define STREAMUP_RESTORE_STAGING_HPP
+
+#include "restore-manager.hpp"
+
+#include <QJsonArray>
+#include <QString>
+
+#include <functional>
+
+namespace StreamUP {
+namespace Zip {
+class Reader;
+}
+
+namespace Restore {
+
+/*
+ * Unpacking an archive into staging and laying staged files over their
+ * targets. Kept free of OBS, like backup-tree.cpp, so the standalone backup
+ * benchmark times this code rather than a copy of it. Choosing targets, the
+ * safety backup, the journal and logging stay in restore-manager.cpp.
+ */
+
+/** SHA-1 of a file's contents as hex, empty if it cannot be read. */
+QString FileSha1(const QString &path);
+
+/**
+ * Extract an archive's entries under `staging`/files/ and append one journal
+ * item per file (archive name, staged path, target, checksum) to `plan`.
+ *
+ * The manifest is skipped, and so is any entry `targetFor` maps to an empty
+ * path. Progress is reported every tenth entry; cancelling removes `staging`
+ * and fails with "Cancelled".
+ */
+bool ExtractToStaging(Zip::Reader &reader, const QString &staging,
+		      const std::function<QString(const QString &)> &targetFor, const ProgressCallback &progress,
+		      QJsonArray &plan, QString *error);
+
+enum class ApplyOutcome {
+	Applied,
+	AlreadyInPlace, // the target already matched the expected checksum
+	Failed,
+};
+
+/**
+ * Put one staged file at its target: copied beside it, then renamed over it,
+ * so an interruption leaves the old file or the new one and never a
+ * truncated one. Sets error when the outcome is Failed.
+ */
+ApplyOutcome ApplyStagedFile(const QString &staged, const QString &target, const QString &expectedSha1,
+			     QString *error);
+
+} // namespace Restore
+} // namespace StreamUP
+
+#endif // STREAMUP_RESTORE_STAGING_HPP
@@ -0,0 +1,213 @@
+#include "scene-item-cache.hpp"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace StreamUP {
+namespace SourceManager {
+namespace SceneItemCache {
+
+namespace {
+
+struct Cache {
+	// Guards everything down to generation. Nothing that takes a libobs lock
+	// may be called while it is held: signals are delivered with libobs locks
+	// held, and their handlers take this.
+	std::mutex mutex;
+	std::map<std::pair<obs_source_t *, std::string>, obs_sceneitem_t *> items;
+	bool running = false;
+	// Bumped on every emptying, so a lookup can tell it raced one
+	uint64_t generation = 0;
+
+	// Sources whose signals are connected. Only ever checked and changed on
+	// its own, around the connect, never held across it.
+	std::mutex hookMutex;
+	std::unordered_set<obs_source_t *> hooked;
+};
+
+Cache &cache()
+{
+	static Cache c;
+	return c;
+}
+
+void invalidate()
+{
+	Cache &c = cache();
+	std::lock_guard<std::mutex> lock(c.mutex);
+	c.items.clear();
+	++c.generation;
+}
+
+void onChanged(void *, calldata_t *)
+{
+	invalidate();
+}
+
+void onSourceDestroy(void *, calldata_t *cd)
+{
+	obs_source_t *source = static_cast<obs_source_t *>(calldata_ptr(cd, "source"));
+	if (!source || obs_source_get_type(source) != OBS_SOURCE_TYPE_SCENE)
+		return;
+
+	Cache &c = cache();
+	{
+		// Its signal handler goes with it, so there is nothing to disconnect
+		std::lock_guard<std::mutex> lock(c.hookMutex);
+		if (!c.hooked.erase(source))
+			return;
+	}
+	invalidate();
+}
+
+struct SignalHook {
+	const char *name;
+	signal_callback_t callback;
+};
+
+// Grouping and ungrouping move items between scenes without item_add or
+// item_remove, and a refresh is what they do signal. Reordering changes which
+// of two items of the same source is found first.
+const SignalHook kSceneSignals[] = {
+	{"item_add", onChanged},
+	{"item_remove", onChanged},
+	{"reorder", onChanged},
+	{"refresh", onChanged},
+};
+
+/** Connect to a scene's or group's signals once. The caller holds a reference for the duration. */
+void hook(obs_source_t *source)
+{
+	Cache &c = cache();
+	{
+		std::lock_guard<std::mutex> lock(c.hookMutex);
+		if (!c.hooked.insert(source).second)
+			return;
+	}
+	signal_handler_t *handler = obs_source_get_signal_handler(source);
+	for (const SignalHook &signal : kSceneSignals)
+		signal_handler_connect(handler, signal.name, signal.callback, nullptr);
+}
+
+/**
+ * Hook the scene and every group in it. Groups are gathered first and hooked
+ * after the enumeration, which holds the scene's lock.
+ */
+void hookSceneAndGroups(obs_source_t *scene, obs_scene_t *sceneData)
+{
+	hook(scene);
+
+	std::vector<obs_source_t *> groups;
+	obs_scene_enum_items(
+		sceneData,
+		[](obs_scene_t *, obs_sceneitem_t *item, void *param) {
+			if (obs_sceneitem_is_group(item)) {
+				if (obs_source_t *group = obs_source_get_ref(obs_sceneitem_get_source(item)))
+					static_cast<std::vector<obs_source_t *> *>(param)->push_back(group);
+			}
+			return true;
+		},
+		&groups);
+
+	for (obs_source_t *group : groups) {
+		hook(group);
+		obs_source_release(group);
+	}
+}
+
+void unhook(obs_source_t *source)
+{
+	signal_handler_t *handler = obs_source_get_signal_handler(source);
+	for (const SignalHook &signal : kSceneSignals)
+		signal_handler_disconnect(handler, signal.name, signal.callback, nullptr);
+}
+
+} // namespace
+
+obs_sceneitem_t *Find(obs_source_t *scene, const char *sourceName)
+{
+	obs_scene_t *sceneData = scene ? obs_scene_from_source(scene) : nullptr;
+	if (!sceneData || !sourceName)
+		return nullptr;
+
+	Cache &c = cache();
+	std::pair<obs_source_t *, std::string> key(scene, sourceName);
+	uint64_t generation = 0;
+	bool running = false;
+	{
+		std::lock_guard<std::mutex> lock(c.mutex);
+		running = c.running;
+		const auto it = c.items.find(key);
+		if (it != c.items.end())
+			return it->second;
+		generation = c.generation;
+	}
+	if (!running)
+		return obs_scene_find_source_recursive(sceneData, sourceName);
+
+	// Hook the scene and all its groups before walking them, so a change from
+	// here on is seen. Every group, not just the one the item turns up in: an
+	// item added to a group walked earlier would be found there first. A group
+	// added later arrives through the scene's item_add, which empties the
+	// cache, and is hooked on the next miss.
+	hookSceneAndGroups(scene, sceneData);
+	obs_sceneitem_t *item = obs_scene_find_source_recursive(sceneData, sourceName);
+	if (!item)
+		return nullptr;
+
+	// Anything that changed the scene since the lookup began emptied the cache
+	// and bumped the generation; what was found then is not kept
+	std::lock_guard<std::mutex> lock(c.mutex);
+	if (c.running && c.generation == generation)
+		c.items.emplace(std::move(key), item);
+	return item;
+}
+
+void Start()
+{
+	Cache &c = cache();
+	{
+		std::lock_guard<std::mutex> lock(c.mutex);
+		if (c.running)
+			return;
+		c.running = true;
+	}
+
+	signal_handler_t *global = obs_get_signal_handler();
+	signal_handler_connect(global, "source_rename", onChanged, nullptr);
+	signal_handler_connect(global, "source_destroy", onSourceDestroy, nullptr);
+}
+
+void Stop()
+{
+	Cache &c = cache();
+	{
+		std::lock_guard<std::mutex> lock(c.mutex);
+		if (!c.running)
+			return;
+		c.running = false;
+		c.items.clear();
+		++c.generation;
+	}
+
+	signal_handler_t *global = obs_get_signal_handler();
+	signal_handler_disconnect(global, "source_rename", onChanged, nullptr);
+	signal_handler_disconnect(global, "source_destroy", onSourceDestroy, nullptr);
+
+	std::unordered_set<obs_source_t *> hooked;
+	{
+		std::lock_guard<std::mutex> lock(c.hookMutex);
+		hooked.swap(c.hooked);
+	}
+	for (obs_source_t *source : hooked)
+		unhook(source);
+}
+
+} // namespace SceneItemCache
+} // namespace SourceManager
+} // namespace StreamUP
@@ -0,0 +1,42 @@
+#ifndef STREAMUP_SCENE_ITEM_CACHE_HPP
+#define STREAMUP_SCENE_ITEM_CACHE_HPP
+
+#include <obs.h>
+
+namespace StreamUP {
+namespace SourceManager {
+
+/**
+ * Scene items already found by name, for requests that find them over and over.
+ *
+ * obs_scene_find_source_recursive walks every item of the scene and of each
+ * group in it. A controller toggling a property at 30 Hz repeats that walk for
+ * the same name thirty times a second. Here the first walk is remembered
+ * against the scene and name, and later lookups are a map hit.
+ *
+ * Entries hold no reference. Every scene looked in, and every group in it, is
+ * hooked, and anything that could change the answer (item_add, item_remove,
+ * reorder, refresh, a rename, the scene going away) empties the cache before
+ * the item can be freed. Structural changes are rare next to lookups, so
+ * nothing finer than emptying it is worth the bookkeeping.
+ */
+namespace SceneItemCache {
+
+/**
+ * The item `sourceName` names in `scene`, looking inside groups, as
+ * obs_scene_find_source_recursive would find it. No reference is added; the
+ * caller holds one on `scene` while it uses the item. Any thread.
+ */
+obs_sceneitem_t *Find(obs_source_t *scene, const char *sourceName);
+
+/** Start caching. Until then, and after Stop, Find walks every time. UI thread. */
+void Start();
+
+/** Empty the cache and unhook everything. UI thread; safe to call more than once. */
+void Stop();
+
+} // namespace SceneItemCache
+} // namespace SourceManager
+} // namespace StreamUP
+
+#endif // STREAMUP_SCENE_ITEM_CACHE_HPP
@@ -0,0 +1,477 @@
+#include "source-state-tracker.hpp"
+
+#include <QCoreApplication>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace StreamUP {
+namespace SourceManager {
+namespace StateTracker {
+
+namespace {
+
+struct Counts {
+	int unlocked = 0;
+	int selected = 0;
+	int selectedVisible = 0;
+
+	Counts &operator+=(const Counts &other)
+	{
+		unlocked += other.unlocked;
+		selected += other.selected;
+		selectedVisible += other.selectedVisible;
+		return *this;
+	}
+	Counts operator-() const { return {-unlocked, -selected, -selectedVisible}; }
+};
+
+struct Record {
+	Counts own;                    // this scene's or group's own items
+	Counts nested;                 // the own counts of the groups it holds
+	obs_scene_t *parent = nullptr; // for a group, the scene holding it
+};
+
+struct Tracker {
+	// Guards everything down to callback. Nothing that takes a libobs lock
+	// may be called while it is held: signals are delivered with libobs locks
+	// held, and their handlers take this.
+	std::mutex mutex;
+	std::unordered_map<obs_scene_t *, Record> scenes;
+	int totalUnlocked = 0;
+	obs_scene_t *current = nullptr;
+	bool running = false;
+	bool changing = false;
+	bool recountQueued = false;
+	ChangedCallback callback = nullptr;
+
+	// Sources whose signals are connected. Only ever checked and changed on
+	// its own, around the connect, never held across it.
+	std::mutex hookMutex;
+	std::unordered_set<obs_source_t *> hooked;
+
+	// Bumped by every counted signal, so a recount can tell it raced one
+	std::atomic<uint64_t> generation{0};
+	std::atomic<bool> dirty{false};
+
+	// Graphics thread only
+	State reported;
+	bool hasReported = false;
+};
+
+Tracker &tracker()
+{
+	static Tracker t;
+	return t;
+}
+
+Counts itemCounts(obs_sceneitem_t *item)
+{
+	Counts counts;
+	counts.unlocked = obs_sceneitem_locked(item) ? 0 : 1;
+	counts.selected = obs_sceneitem_selected(item) ? 1 : 0;
+	counts.selectedVisible = counts.selected && obs_sceneitem_visible(item) ? 1 : 0;
+	return counts;
+}
+
+bool isGroupItem(obs_sceneitem_t *item)
+{
+	obs_source_t *source = obs_sceneitem_get_source(item);
+	return source && obs_source_is_group(source);
+}
+
+State stateLocked(const Tracker &t)
+{
+	State state;
+	state.allLocked = t.totalUnlocked == 0;
+	const auto it = t.current ? t.scenes.find(t.current) : t.scenes.end();
+	if (it == t.scenes.end())
+		return state;
+
+	Counts counts = it->second.own;
+	counts += it->second.nested;
+	state.currentSceneLocked = counts.unlocked == 0;
+	state.selectionCount = counts.selected;
+	state.selectedVisible = counts.selectedVisible > 0;
+	return state;
+}
+
+/** Add a delta to one scene, the scene holding it if it is a group, and the total. */
+void applyLocked(Tracker &t, obs_scene_t *scene, const Counts &delta)
+{
+	const auto it = t.scenes.find(scene);
+	if (it == t.scenes.end())
+		return;
+	it->second.own += delta;
+	if (it->second.parent) {
+		const auto parent = t.scenes.find(it->second.parent);
+		if (parent != t.scenes.end())
+			parent->second.nested += delta;
+	}
+	t.totalUnlocked += delta.unlocked;
+	++t.generation;
+	t.dirty = true;
+}
+
+void apply(calldata_t *cd, const Counts &delta)
+{
+	Tracker &t = tracker();
+	std::lock_guard<std::mutex> lock(t.mutex);
+	applyLocked(t, static_cast<obs_scene_t *>(calldata_ptr(cd, "scene")), delta);
+}
+
+void recount();
+
+void queueRecount()
+{
+	Tracker &t = tracker();
+	{
+		std::lock_guard<std::mutex> lock(t.mutex);
+		if (!t.running || t.changing || t.recountQueued)
+			return;
+		t.recountQueued = true;
+	}
+	QMetaObject::invokeMethod(qApp, []() { recount(); }, Qt::QueuedConnection);
+}
+
+void onItemLocked(void *, calldata_t *cd)
+{
+	Counts delta;
+	delta.unlocked = calldata_bool(cd, "locked") ? -1 : 1;
+	apply(cd, delta);
+}
+
+void onItemVisible(void *, calldata_t *cd)
+{
+	obs_sceneitem_t *item = static_cast<obs_sceneitem_t *>(calldata_ptr(cd, "item"));
+	if (!item || !obs_sceneitem_selected(item))
+		return;
+	Counts delta;
+	delta.selectedVisible = calldata_bool(cd, "visible") ? 1 : -1;
+	apply(cd, delta);
+}
+
+void onItemSelect(void *, calldata_t *cd)
+{
+	obs_sceneitem_t *item = static_cast<obs_sceneitem_t *>(calldata_ptr(cd, "item"));
+	if (!item)
+		return;
+	Counts delta;
+	delta.selected = 1;
+	delta.selectedVisible = obs_sceneitem_visible(item) ? 1 : 0;
+	apply(cd, delta);
+}
+
+void onItemDeselect(void *, calldata_t *cd)
+{
+	obs_sceneitem_t *item = static_cast<obs_sceneitem_t *>(calldata_ptr(cd, "item"));
+	if (!item)
+		return;
+	Counts delta;
+	delta.selected = -1;
+	delta.selectedVisible = obs_sceneitem_visible(item) ? -1 : 0;
+	apply(cd, delta);
+}
+
+void onItemAdd(void *, calldata_t *cd)
+{
+	obs_sceneitem_t *item = static_cast<obs_sceneitem_t *>(calldata_ptr(cd, "item"));
+	if (!item)
+		return;
+	apply(cd, itemCounts(item));
+	// A group arriving brings items of its own that were never signalled here
+	if (isGroupItem(item))
+		queueRecount();
+}
+
+void onItemRemove(void *, calldata_t *cd)
+{
+	obs_sceneitem_t *item = static_cast<obs_sceneitem_t *>(calldata_ptr(cd, "item"));
+	if (!item)
+		return;
+	apply(cd, -itemCounts(item));
+	if (isGroupItem(item))
+		queueRecount();
+}
+
+// Grouping and ungrouping move items between scenes without item_add or
+// item_remove, and a refresh is what they do signal.
+void onRefresh(void *, calldata_t *)
+{
+	queueRecount();
+}
+
+struct SignalHook {
+	const char *name;
+	signal_callback_t callback;
+};
+
+const SignalHook kSceneSignals[] = {
+	{"item_locked", onItemLocked}, {"item_visible", onItemVisible}, {"item_select", onItemSelect},
+	{"item_deselect", onItemDeselect}, {"item_add", onItemAdd}, {"item_remove", onItemRemove},
+	{"refresh", onRefresh},
+};
+
+/** Connect to a scene's signals once. The caller holds a reference for the duration. */
+void hook(obs_source_t *source)
+{
+	Tracker &t = tracker();
+	{
+		std::lock_guard<std::mutex> lock(t.hookMutex);
+		if (!t.hooked.insert(source).second)
+			return;
+	}
+	signal_handler_t *handler = obs_source_get_signal_handler(source);
+	for (const SignalHook &signal : kSceneSignals)
+		signal_handler_connect(handler, signal.name, signal.callback, nullptr);
+}
+
+void unhook(obs_source_t *source)
+{
+	signal_handler_t *handler = obs_source_get_signal_handler(source);
+	for (const SignalHook &signal : kSceneSignals)
+		signal_handler_disconnect(handler, signal.name, signal.callback, nullptr);
+}
+
+void forget(obs_source_t *source, bool destroyed)
+{
+	if (obs_source_get_type(source) != OBS_SOURCE_TYPE_SCENE)
+		return;
+
+	Tracker &t = tracker();
+	if (destroyed) {
+		// Its signal handler goes with it, so there is nothing to disconnect
+		std::lock_guard<std::mutex> lock(t.hookMutex);
+		t.hooked.erase(source);
+	}
+
+	obs_scene_t *scene = obs_group_or_scene_from_source(source);
+	std::lock_guard<std::mutex> lock(t.mutex);
+	const auto it = t.scenes.find(scene);
+	if (it == t.scenes.end())
+		return;
+	applyLocked(t, scene, -it->second.own);
+	t.scenes.erase(it);
+	if (t.current == scene)
+		t.current = nullptr;
+}
+
+void onSourceCreate(void *, calldata_t *cd)
+{
+	obs_source_t *source = static_cast<obs_source_t *>(calldata_ptr(cd, "source"));
+	if (source && obs_source_get_type(source) == OBS_SOURCE_TYPE_SCENE)
+		queueRecount();
+}
+
+void onSourceRemove(void *, calldata_t *cd)
+{
+	if (obs_source_t *source = static_cast<obs_source_t *>(calldata_ptr(cd, "source")))
+		forget(source, false);
+}
+
+void onSourceDestroy(void *, calldata_t *cd)
+{
+	if (obs_source_t *source = static_cast<obs_source_t *>(calldata_ptr(cd, "source")))
+		forget(source, true);
+}
+
+using SceneMap = std::unordered_map<obs_scene_t *, Record>;
+
+/** Count one scene or group into `out`, hooking it and any group inside it on the way. */
+void countScene(SceneMap &out, obs_scene_t *scene, obs_scene_t *parent)
+{
+	struct Walk {
+		Counts counts;
+		std::vector<obs_scene_t *> groups;
+	} walk;
+
+	hook(obs_scene_get_source(scene));
+	obs_scene_enum_items(
+		scene,
+		[](obs_scene_t *, obs_sceneitem_t *item, void *param) -> bool {
+			Walk *walk = static_cast<Walk *>(param);
+			walk->counts += itemCounts(item);
+			obs_source_t *source = obs_sceneitem_get_source(item);
+			if (source && obs_source_is_group(source)) {
+				// The item holds the group for as long as this enumeration runs
+				hook(source);
+				walk->groups.push_back(obs_group_from_source(source));
+			}
+			return true;
+		},
+		&walk);
+
+	Record &record = out[scene];
+	record.own = walk.counts;
+	record.parent = parent;
+	for (obs_scene_t *group : walk.groups) {
+		if (group)
+			countScene(out, group, scene);
+	}
+}
+
+void recount()
+{
+	Tracker &t = tracker();
+	{
+		std::lock_guard<std::mutex> lock(t.mutex);
+		t.recountQueued = false;
+		if (!t.running || t.changing)
+			return;
+	}
+
+	const uint64_t startedAt = t.generation;
+	SceneMap fresh;
+	obs_enum_scenes(
+		[](void *param, obs_source_t *source) -> bool {
+			// Groups are counted through the scene holding them
+			if (obs_source_is_group(source))
+				return true;
+			if (obs_scene_t *scene = obs_scene_from_source(source))
+				countScene(*static_cast<SceneMap *>(param), scene, nullptr);
+			return true;
+		},
+		&fresh);
+
+	int totalUnlocked = 0;
+	for (auto &entry : fresh) {
+		totalUnlocked += entry.second.own.unlocked;
+		if (!entry.second.parent)
+			continue;
+		const auto parent = fresh.find(entry.second.parent);
+		if (parent != fresh.end())
+			parent->second.nested += entry.second.own;
+	}
+
+	bool raced = false;
+	{
+		std::lock_guard<std::mutex> lock(t.mutex);
+		if (!t.running)
+			return;
+		t.scenes.swap(fresh);
+		t.totalUnlocked = totalUnlocked;
+		t.dirty = true;
+		// A signal from another thread landed mid-count and may be missing from
+		// it. Counting again once settles it; nearly every state change comes
+		// from the UI thread, which this is, so this is rare.
+		raced = t.generation != startedAt;
+	}
+	static bool retried = false;
+	if (raced && !retried) {
+		retried = true;
+		queueRecount();
+	} else {
+		retried = false;
+	}
+}
+
+void tick(void *, float)
+{
+	Tracker &t = tracker();
+	if (!t.dirty.exchange(false))
+		return;
+
+	State state;
+	ChangedCallback callback;
+	{
+		std::lock_guard<std::mutex> lock(t.mutex);
+		if (!t.running)
+			return;
+		state = stateLocked(t);
+		callback = t.callback;
+	}
+	if (t.hasReported && state == t.reported)
+		return;
+	t.reported = state;
+	t.hasReported = true;
+	if (callback)
+		callback(state);
+}
+
+} // namespace
+
+void Start(ChangedCallback onChanged)
+{
+	Tracker &t = tracker();
+	{
+		std::lock_guard<std::mutex> lock(t.mutex);
+		if (t.running)
+			return;
+		t.running = true;
+		t.callback = onChanged;
+	}
+	t.hasReported = false;
+
+	signal_handler_t *global = obs_get_signal_handler();
+	signal_handler_connect(global, "source_create", onSourceCreate, nullptr);
+	signal_handler_connect(global, "source_remove", onSourceRemove, nullptr);
+	signal_handler_connect(global, "source_destroy", onSourceDestroy, nullptr);
+
+	recount();
+	obs_add_tick_callback(tick, nullptr);
+}
+
+void Stop()
+{
+	Tracker &t = tracker();
+	{
+		std::lock_guard<std::mutex> lock(t.mutex);
+		if (!t.running)
+			return;
+		t.running = false;
+		t.callback = nullptr;
+		t.scenes.clear();
+		t.totalUnlocked = 0;
+		t.current = nullptr;
+	}
+
+	obs_remove_tick_callback(tick, nullptr);
+	signal_handler_t *global = obs_get_signal_handler();
+	signal_handler_disconnect(global, "source_create", onSourceCreate, nullptr);
+	signal_handler_disconnect(global, "source_remove", onSourceRemove, nullptr);
+	signal_handler_disconnect(global, "source_destroy", onSourceDestroy, nullptr);
+
+	std::unordered_set<obs_source_t *> hooked;
+	{
+		std::lock_guard<std::mutex> lock(t.hookMutex);
+		hooked.swap(t.hooked);
+	}
+	for (obs_source_t *source : hooked)
+		unhook(source);
+}
+
+void SetCurrentScene(obs_source_t *scene)
+{
+	Tracker &t = tracker();
+	std::lock_guard<std::mutex> lock(t.mutex);
+	t.current = scene ? obs_scene_from_source(scene) : nullptr;
+	t.dirty = true;
+}
+
+void SetCollectionChanging(bool changing)
+{
+	Tracker &t = tracker();
+	{
+		std::lock_guard<std::mutex> lock(t.mutex);
+		t.changing = changing;
+	}
+	if (!changing)
+		queueRecount();
+}
+
+bool Current(State &out)
+{
+	Tracker &t = tracker();
+	std::lock_guard<std::mutex> lock(t.mutex);
+	if (!t.running || t.changing || t.recountQueued)
+		return false;
+	out = stateLocked(t);
+	return true;
+}
+
+} // namespace StateTracker
+} // namespace SourceManager
+} // namespace StreamUP
@@ -0,0 +1,72 @@
+#ifndef STREAMUP_SOURCE_STATE_TRACKER_HPP
+#define STREAMUP_SOURCE_STATE_TRACKER_HPP
+
+#include <obs.h>
+
+namespace StreamUP {
+namespace SourceManager {
+
+/**
+ * Lock and selection state of every scene, kept as running counts.
+ *
+ * Answering "is everything locked" by asking walks every item of every scene.
+ * Done for each item_locked or item_visible signal, an animation flipping
+ * visibility on a few items costs a walk of the whole collection per flip.
+ * Instead every scene and group is hooked once, and each signal adjusts its
+ * scene's counts of unlocked, selected and selected-and-visible items, so the
+ * state is known without looking.
+ *
+ * Group contents are counted in the group and added into the scene holding
+ * it, the way the lock checks have always looked inside groups. What libobs
+ * changes without a signal (loading a collection, duplicating a scene, moving
+ * items in and out of groups) is caught by a full recount, queued to the UI
+ * thread when a scene or group is created or removed or a scene refreshes.
+ *
+ * Changes are reported at most once a frame, and only when the state differs
+ * from what was last reported.
+ */
+namespace StateTracker {
+
+struct State {
+	bool allLocked = true;           // no unlocked item in any scene
+	bool currentSceneLocked = false; // false with no current scene, as before
+	int selectionCount = 0;          // in the current scene, groups included
+	bool selectedVisible = false;    // any selected item in the current scene is shown
+
+	bool operator==(const State &other) const
+	{
+		return allLocked == other.allLocked && currentSceneLocked == other.currentSceneLocked &&
+		       selectionCount == other.selectionCount && selectedVisible == other.selectedVisible;
+	}
+	bool operator!=(const State &other) const { return !(*this == other); }
+};
+
+using ChangedCallback = void (*)(const State &state);
+
+/** Hook every scene, count them, and report changes to `onChanged` from the graphics thread. UI thread. */
+void Start(ChangedCallback onChanged);
+
+/** Unhook everything. UI thread; safe to call more than once. */
+void Stop();
+
+/** The scene the current-scene counts are read from. No reference is kept. */
+void SetCurrentScene(obs_source_t *scene);
+
+/**
+ * Between SCENE_COLLECTION_CHANGING and SCENE_COLLECTION_CHANGED nothing is
+ * recounted. Leaving that state recounts the new collection.
+ */
+void SetCollectionChanging(bool changing);
+
+/**
+ * The state as of the last signal, into `out`. False while it cannot be
+ * trusted: before Start, while a collection is changing and while a recount is
+ * queued. Any thread.
+ */
+bool Current(State &out);
+
+} // namespace StateTracker
+} // namespace SourceManager
+} // namespace StreamUP
+
+#endif // STREAMUP_SOURCE_STATE_TRACKER_HPP
@@ -0,0 +1,380 @@
+#include "stream-health.hpp"
+#include "../ui/streamup-toolbar-status.hpp"
+
+#include <obs.h>
+#include <obs-frontend-api.h>
+
+#include <QDateTime>
+#include <QObject>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+
+namespace StreamUP {
+namespace StreamHealth {
+
+namespace {
+
+constexpr int kSampleMs = 1000;
+
+// The Monitor also ticks out of turn, when an item is added or comes back on
+// screen. Those ticks are skipped, but one a few milliseconds early is not.
+constexpr qint64 kSampleSlackMs = 250;
+
+// One sample a second, so the longest window is also the ring size.
+constexpr int kCapacity = 300;
+constexpr int kMetricCount = static_cast<int>(Metric::Count);
+constexpr int kWindowCount = static_cast<int>(Window::Count);
+constexpr int kWindowLengths[kWindowCount] = {10, 60, 300};
+
+/**
+ * Running figures for the newest `length` samples of a series. Sample times
+ * are counted from the oldest sample in the window, so the sums stay as small
+ * as the window however long OBS has been running.
+ */
+struct WindowState {
+	int length = 0;
+	int count = 0;
+	double sum = 0.0;
+	double sumTY = 0.0; // sum of (position in window * value)
+
+	// Indices of the samples that can still become the minimum, values rising
+	// from front to back. Never holds more than the window.
+	std::array<int64_t, kCapacity> minQueue{};
+	int minHead = 0;
+	int minSize = 0;
+};
+
+struct Series {
+	std::array<double, kCapacity> ring{};
+	int64_t pushed = 0; // total samples, also the index of the next one
+	WindowState windows[kWindowCount];
+
+	double at(int64_t index) const { return ring[static_cast<size_t>(index % kCapacity)]; }
+};
+
+struct State {
+	// Guards the series: the UI thread samples, vendor requests read.
+	std::mutex mutex;
+	Series series[kMetricCount];
+
+	// UI thread only.
+	QObject *context = nullptr;
+	qint64 lastSampleAtMs = 0;
+	// The first CPU reading after the Monitor starts its query has no baseline
+	bool cpuPrimed = false;
+	bool streamWasActive = false;
+	bool streamPrimed = false;
+	uint64_t lastStreamBytes = 0;
+	int lastStreamDropped = 0;
+	qint64 lastStreamAtMs = 0;
+	bool framesPrimed = false;
+	uint32_t lastLagged = 0;
+	uint32_t lastSkipped = 0;
+};
+
+State &state()
+{
+	static State s;
+	return s;
+}
+
+void resetSeries(Series &series)
+{
+	series.pushed = 0;
+	for (int w = 0; w < kWindowCount; ++w) {
+		WindowState &win = series.windows[w];
+		win = WindowState();
+		win.length = kWindowLengths[w];
+	}
+}
+
+/**
+ * Recompute a window's sums from the ring. Adding and taking away doubles one
+ * sample at a time drifts, so this runs each time the ring comes round; it
+ * touches at most five minutes of samples once every five minutes.
+ */
+void resum(const Series &series, WindowState &win)
+{
+	win.sum = 0.0;
+	win.sumTY = 0.0;
+	const int64_t first = series.pushed - win.count;
+	for (int t = 0; t < win.count; ++t) {
+		const double y = series.at(first + t);
+		win.sum += y;
+		win.sumTY += t * y;
+	}
+}
+
+void push(Series &series, double value)
+{
+	const int64_t index = series.pushed;
+
+	// Everything leaving a window is read before its ring slot is reused below
+	for (WindowState &win : series.windows) {
+		if (win.count == win.length) {
+			const double oldest = series.at(index - win.length);
+			win.sum -= oldest;
+			--win.count;
+			// Every remaining sample moves one place nearer the front
+			win.sumTY -= win.sum;
+		}
+		if (win.minSize > 0 && win.minQueue[win.minHead] <= index - win.length) {
+			win.minHead = (win.minHead + 1) % kCapacity;
+			--win.minSize;
+		}
+	}
+
+	series.ring[static_cast<size_t>(index % kCapacity)] = value;
+	series.pushed = index + 1;
+
+	for (WindowState &win : series.windows) {
+		win.sumTY += win.count * value;
+		win.sum += value;
+		++win.count;
+
+		while (win.minSize > 0) {
+			const int back = (win.minHead + win.minSize - 1) % kCapacity;
+			if (series.at(win.minQueue[back]) < value)
+				break;
+			--win.minSize;
+		}
+		win.minQueue[(win.minHead + win.minSize) % kCapacity] = index;
+		++win.minSize;
+	}
+
+	if (series.pushed % kCapacity == 0) {
+		for (WindowState &win : series.windows)
+			resum(series, win);
+	}
+}
+
+Stats statsFor(const Series &series, const WindowState &win)
+{
+	Stats stats;
+	const int n = win.count;
+	stats.samples = n;
+	if (n == 0)
+		return stats;
+
+	stats.min = series.at(win.minQueue[win.minHead]);
+	stats.mean = win.sum / n;
+
+	// Least-squares slope against time in seconds. The sums of t and t^2 over
+	// 0..n-1 have closed forms, so only the value sums need keeping.
+	if (n > 1) {
+		const double sumT = n * (n - 1) / 2.0;
+		const double sumT2 = (n - 1) * n * (2.0 * n - 1) / 6.0;
+		const double denominator = n * sumT2 - sumT * sumT;
+		if (denominator > 0.0)
+			stats.trendPerMinute = (n * win.sumTY - sumT * win.sum) / denominator * 60.0;
+	}
+
+	// Nearest-rank 95th percentile, selected from a copy on the stack
+	std::array<double, kCapacity> scratch;
+	const int64_t first = series.pushed - n;
+	for (int t = 0; t < n; ++t)
+		scratch[static_cast<size_t>(t)] = series.at(first + t);
+	const int rank = std::max(1, static_cast<int>(std::ceil(0.95 * n))) - 1;
+	std::nth_element(scratch.begin(), scratch.begin() + rank, scratch.begin() + n);
+	stats.p95 = scratch[static_cast<size_t>(rank)];
+
+	return stats;
+}
+
+// The Monitor ticks every five seconds while no status item is on screen. A
+// tick that long after the last is spread over the seconds it covers.
+int secondsSince(qint64 thenMs, qint64 nowMs)
+{
+	const qint64 seconds = (nowMs - thenMs + kSampleMs / 2) / kSampleMs;
+	return static_cast<int>(std::clamp<qint64>(seconds, 1, kCapacity));
+}
+
+/** One sample for each of `seconds` seconds, all the same reading. */
+void pushFor(Series &series, double value, int seconds)
+{
+	for (int i = 0; i < seconds; ++i)
+		push(series, value);
+}
+
+/** A counter's growth since the last reading, or nothing if it went backwards (OBS reset it). */
+template<typename T> double delta(T now, T before)
+{
+	return now >= before ? static_cast<double>(now - before) : 0.0;
+}
+
+void sample()
+{
+	State &s = state();
+	const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+	if (s.lastSampleAtMs != 0 && nowMs - s.lastSampleAtMs < kSampleMs - kSampleSlackMs)
+		return;
+	const int seconds = s.lastSampleAtMs != 0 ? secondsSince(s.lastSampleAtMs, nowMs) : 1;
+	s.lastSampleAtMs = nowMs;
+
+	const double cpu = ToolbarStatus::Monitor::instance().value(ToolbarStatus::Kind::Cpu);
+
+	const uint32_t lagged = obs_get_lagged_frames();
+	uint32_t skipped = s.lastSkipped;
+	if (video_t *video = obs_get_video())
+		skipped = video_output_get_skipped_frames(video);
+
+	bool streamActive = false;
+	uint64_t streamBytes = 0;
+	int streamDropped = 0;
+	if (obs_output_t *output = obs_frontend_get_streaming_output()) {
+		streamActive = obs_output_active(output);
+		if (streamActive) {
+			streamBytes = obs_output_get_total_bytes(output);
+			streamDropped = obs_output_get_frames_dropped(output);
+		}
+		obs_output_release(output);
+	}
+
+	std::lock_guard<std::mutex> lock(s.mutex);
+
+	// The CPU query averages over the time since it was last read, and the
+	// frame counters are turned into a rate over the same time
+	if (s.cpuPrimed)
+		pushFor(s.series[static_cast<int>(Metric::Cpu)], cpu, seconds);
+	s.cpuPrimed = true;
+
+	if (s.framesPrimed) {
+		pushFor(s.series[static_cast<int>(Metric::RenderLagged)], delta(lagged, s.lastLagged) / seconds,
+			seconds);
+		pushFor(s.series[static_cast<int>(Metric::EncodeSkipped)], delta(skipped, s.lastSkipped) / seconds,
+			seconds);
+	}
+	s.lastLagged = lagged;
+	s.lastSkipped = skipped;
+	s.framesPrimed = true;
+
+	// A new stream starts its windows empty rather than after the gap
+	if (streamActive && !s.streamWasActive) {
+		resetSeries(s.series[static_cast<int>(Metric::StreamBitrate)]);
+		resetSeries(s.series[static_cast<int>(Metric::DroppedFrames)]);
+		s.streamPrimed = false;
+	}
+	s.streamWasActive = streamActive;
+
+	if (!streamActive)
+		return;
+	if (s.streamPrimed && nowMs > s.lastStreamAtMs) {
+		const int streamSeconds = secondsSince(s.lastStreamAtMs, nowMs);
+		const double kbps = delta(streamBytes, s.lastStreamBytes) * 8.0 / double(nowMs - s.lastStreamAtMs);
+		pushFor(s.series[static_cast<int>(Metric::StreamBitrate)], kbps, streamSeconds);
+		pushFor(s.series[static_cast<int>(Metric::DroppedFrames)],
+			delta(streamDropped, s.lastStreamDropped) / streamSeconds, streamSeconds);
+	}
+	s.lastStreamBytes = streamBytes;
+	s.lastStreamDropped = streamDropped;
+	s.lastStreamAtMs = nowMs;
+	s.streamPrimed = true;
+}
+
+} // namespace
+
+const char *MetricKey(Metric metric)
+{
+	switch (metric) {
+	case Metric::StreamBitrate:
+		return "streamBitrate";
+	case Metric::DroppedFrames:
+		return "droppedFrames";
+	case Metric::RenderLagged:
+		return "renderLaggedFrames";
+	case Metric::EncodeSkipped:
+		return "encodeSkippedFrames";
+	case Metric::Cpu:
+		return "cpuUsage";
+	case Metric::Count:
+		break;
+	}
+	return "";
+}
+
+const char *WindowKey(Window window)
+{
+	switch (window) {
+	case Window::TenSeconds:
+		return "10s";
+	case Window::OneMinute:
+		return "1m";
+	case Window::FiveMinutes:
+		return "5m";
+	case Window::Count:
+		break;
+	}
+	return "";
+}
+
+Stats Get(Metric metric, Window window)
+{
+	const int m = static_cast<int>(metric);
+	const int w = static_cast<int>(window);
+	if (m < 0 || m >= kMetricCount || w < 0 || w >= kWindowCount)
+		return Stats();
+
+	State &s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	const Series &series = s.series[m];
+	return statsFor(series, series.windows[w]);
+}
+
+bool Latest(Metric metric, double &out)
+{
+	const int m = static_cast<int>(metric);
+	if (m < 0 || m >= kMetricCount)
+		return false;
+
+	State &s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	const Series &series = s.series[m];
+	if (series.pushed == 0)
+		return false;
+	out = series.at(series.pushed - 1);
+	return true;
+}
+
+void Start()
+{
+	State &s = state();
+	if (s.context)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		for (Series &series : s.series)
+			resetSeries(series);
+	}
+	s.lastSampleAtMs = 0;
+	s.cpuPrimed = false;
+	s.streamWasActive = false;
+	s.streamPrimed = false;
+	s.framesPrimed = false;
+
+	// Sampled on the toolbar status Monitor's tick, which already keeps the
+	// one CPU query and the one timer. Not counted as an item on screen, so
+	// the Monitor still slows down while nothing of it is shown.
+	ToolbarStatus::Monitor &monitor = ToolbarStatus::Monitor::instance();
+	s.context = new QObject();
+	QObject::connect(&monitor, &ToolbarStatus::Monitor::sampled, s.context, []() { sample(); });
+	monitor.addObserver(ToolbarStatus::Kind::Cpu);
+}
+
+void Stop()
+{
+	State &s = state();
+	if (!s.context)
+		return;
+
+	delete s.context;
+	s.context = nullptr;
+	ToolbarStatus::Monitor::instance().removeObserver(ToolbarStatus::Kind::Cpu);
+}
+
+} // namespace StreamHealth
+} // namespace StreamUP
@@ -0,0 +1,74 @@
+#ifndef STREAMUP_STREAM_HEALTH_HPP
+#define STREAMUP_STREAM_HEALTH_HPP
+
+namespace StreamUP {
+
+/**
+ * Rolling statistics over the last few minutes of stream health.
+ *
+ * The toolbar readouts show the reading of the moment: a bitrate from the last
+ * two byte counts, a lag count since the last reset. Whether a stream is
+ * getting worse needs history, so once a second this samples the stream
+ * bitrate, the frames the stream output dropped, frames missed to rendering
+ * lag, frames skipped to encoding lag and CPU use, and keeps each series over
+ * 10 second, 1 minute and 5 minute windows.
+ *
+ * The samples are taken on the toolbar status Monitor's tick rather than a
+ * timer of our own, so the CPU figure comes from its one CPU query and there is
+ * one timer, not two. While no status item is on screen that tick slows to one
+ * every five seconds, and each reading then stands for every second it covers,
+ * so the windows stay measured in seconds.
+ *
+ * Each series is one fixed ring of the last five minutes of samples, and each
+ * window keeps running sums and a monotonic queue over that ring, so adding a
+ * sample is O(1) and nothing allocates after Start(). Min, mean and trend are
+ * read straight off those; the 95th percentile is selected from the window's
+ * samples when asked for, which is only ever a tooltip or a vendor request.
+ *
+ * The stream series (bitrate, dropped frames) only fill while the stream output
+ * is active and start over when a new stream starts, so a window never mixes
+ * two streams or counts the time between them as zero bitrate.
+ *
+ * Start and Stop are UI-thread calls. Get is safe from any thread.
+ */
+namespace StreamHealth {
+
+enum class Metric {
+	StreamBitrate, // kb/s
+	DroppedFrames, // frames the stream output dropped, per second
+	RenderLagged,  // frames missed to rendering lag, per second
+	EncodeSkipped, // frames skipped to encoding lag, per second
+	Cpu,           // percent
+	Count
+};
+
+enum class Window { TenSeconds, OneMinute, FiveMinutes, Count };
+
+struct Stats {
+	int samples = 0; // how many seconds of the window are filled
+	double min = 0.0;
+	double mean = 0.0;
+	double p95 = 0.0;
+	double trendPerMinute = 0.0; // least-squares slope over the window
+};
+
+/** Stable names for vendor responses ("streamBitrate", "10s", ...). */
+const char *MetricKey(Metric metric);
+const char *WindowKey(Window window);
+
+/** Current statistics for one series over one window. Zero samples before any have been taken. */
+Stats Get(Metric metric, Window window);
+
+/** The newest sample of a series. False if there is none yet. */
+bool Latest(Metric metric, double &out);
+
+/** Start sampling on the Monitor's tick. Call once OBS has finished loading. */
+void Start();
+
+/** Stop sampling. Called at frontend exit, while OBS can still be queried. */
+void Stop();
+
+} // namespace StreamHealth
+} // namespace StreamUP
+
+#endif // STREAMUP_STREAM_HEALTH_HPP
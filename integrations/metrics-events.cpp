@@ -0,0 +1,326 @@
+#include "metrics-events.hpp"
+#include "../ui/streamup-toolbar-status.hpp"
+
+#include <QDateTime>
+#include <QObject>
+#include <QUuid>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace StreamUP {
+namespace MetricsEvents {
+
+namespace {
+
+using ToolbarStatus::Kind;
+using ToolbarStatus::Monitor;
+
+constexpr int kKindCount = static_cast<int>(Kind::Message) + 1;
+constexpr unsigned kAllKinds = (1u << kKindCount) - 1;
+
+// Every client shares one vendor event stream, so this bounds the events a
+// single tick can produce.
+constexpr size_t kMaxSubscriptions = 32;
+
+// The Monitor samples once a second, so that is the finest interval there is.
+constexpr int kMinIntervalMs = 1000;
+constexpr int kMaxIntervalMs = 60 * 1000;
+constexpr int kMinLeaseSeconds = 10;
+constexpr int kMaxLeaseSeconds = 60 * 60;
+
+// Ticks are not exactly a second apart. Without this a 1s subscription would
+// skip a tick whenever one came in a few milliseconds early.
+constexpr qint64 kIntervalSlackMs = 250;
+
+struct Entry {
+	std::string id;
+	unsigned kinds = 0;
+	int intervalMs = kMinIntervalMs;
+	qint64 expiresAtMs = 0;
+	qint64 lastSentMs = 0;
+	// The change count of each reading when it was last sent here
+	quint64 sentVersions[kKindCount] = {};
+	// False until the first event, which carries every reading asked for
+	bool primed = false;
+	// False until the Monitor samples every kind asked for. Set by the sync
+	// that registers them, so the first event waits for a tick after it.
+	bool observed = false;
+};
+
+struct State {
+	// Guards everything down to running: requests write, the tick reads.
+	std::mutex mutex;
+	std::vector<Entry> subscriptions;
+	QObject *context = nullptr;
+	bool running = false;
+
+	// UI thread only.
+	obs_websocket_vendor vendor = nullptr;
+	// Bumped each time the Monitor reports a reading changed
+	quint64 versions[kKindCount] = {};
+	bool observing[kKindCount] = {};
+	bool shown = false;
+	// Registering a kind makes the Monitor sample it at once, before the
+	// rest are registered and, for CPU, before there is a baseline to measure
+	// from. Ticks while this is set are not published.
+	bool syncing = false;
+};
+
+State &state()
+{
+	static State s;
+	return s;
+}
+
+bool wants(unsigned kinds, int index)
+{
+	return (kinds & (1u << index)) != 0;
+}
+
+/**
+ * Make the Monitor sample what the subscriptions ask for, and at its on-screen
+ * rate while there are any. A subscriber counts as one item on screen: it wants
+ * every tick, whatever the window is doing.
+ */
+void syncObservers()
+{
+	State &s = state();
+	unsigned wanted = 0;
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		for (const Entry &entry : s.subscriptions)
+			wanted |= entry.kinds;
+	}
+
+	Monitor &monitor = Monitor::instance();
+	s.syncing = true;
+	for (int index = 0; index < kKindCount; ++index) {
+		const bool want = wants(wanted, index);
+		if (want == s.observing[index])
+			continue;
+		s.observing[index] = want;
+		if (want)
+			monitor.addObserver(static_cast<Kind>(index));
+		else
+			monitor.removeObserver(static_cast<Kind>(index));
+	}
+
+	const bool show = wanted != 0;
+	if (show != s.shown) {
+		s.shown = show;
+		if (show)
+			monitor.observerShown();
+		else
+			monitor.observerHidden();
+	}
+	s.syncing = false;
+
+	// Everything asked for as of the read above is now sampled. A subscription
+	// made or changed since has its own sync queued behind this one.
+	std::lock_guard<std::mutex> lock(s.mutex);
+	for (Entry &entry : s.subscriptions) {
+		if ((entry.kinds & wanted) == entry.kinds)
+			entry.observed = true;
+	}
+}
+
+void setReading(obs_data_t *metrics, Kind kind)
+{
+	const Monitor &monitor = Monitor::instance();
+	const std::string key = ToolbarStatus::kindKey(kind).toStdString();
+	switch (kind) {
+	case Kind::Cpu:
+	case Kind::Fps:
+		obs_data_set_double(metrics, key.c_str(), monitor.value(kind));
+		break;
+	case Kind::Message:
+		obs_data_set_string(metrics, key.c_str(), monitor.text(kind, false, false).toUtf8().constData());
+		break;
+	default:
+		obs_data_set_int(metrics, key.c_str(), static_cast<long long>(monitor.value(kind)));
+		break;
+	}
+}
+
+/** Once per Monitor tick: one event for each due subscription with something new. */
+void publish()
+{
+	State &s = state();
+	if (s.syncing)
+		return;
+	const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+
+	struct Due {
+		std::string id;
+		unsigned kinds;
+	};
+	std::vector<Due> due;
+	bool lapsed = false;
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		const auto firstLapsed = std::remove_if(s.subscriptions.begin(), s.subscriptions.end(),
+							[nowMs](const Entry &entry) { return entry.expiresAtMs <= nowMs; });
+		lapsed = firstLapsed != s.subscriptions.end();
+		s.subscriptions.erase(firstLapsed, s.subscriptions.end());
+
+		for (Entry &entry : s.subscriptions) {
+			if (!entry.observed)
+				continue;
+			if (entry.primed && nowMs - entry.lastSentMs < entry.intervalMs - kIntervalSlackMs)
+				continue;
+			unsigned changed = 0;
+			for (int index = 0; index < kKindCount; ++index) {
+				if (!wants(entry.kinds, index))
+					continue;
+				if (entry.primed && entry.sentVersions[index] == s.versions[index])
+					continue;
+				changed |= 1u << index;
+				entry.sentVersions[index] = s.versions[index];
+			}
+			// Nothing new is not worth an event, and the next change goes out
+			// on the tick it happens rather than waiting out another interval
+			if (changed == 0)
+				continue;
+			entry.primed = true;
+			entry.lastSentMs = nowMs;
+			due.push_back({entry.id, changed});
+		}
+	}
+
+	if (lapsed)
+		syncObservers();
+
+	for (const Due &entry : due) {
+		obs_data_t *metrics = obs_data_create();
+		for (int index = 0; index < kKindCount; ++index) {
+			if (wants(entry.kinds, index))
+				setReading(metrics, static_cast<Kind>(index));
+		}
+		obs_data_t *event = obs_data_create();
+		obs_data_set_string(event, "subscriptionId", entry.id.c_str());
+		obs_data_set_obj(event, "metrics", metrics);
+		obs_websocket_vendor_emit_event(s.vendor, "MetricsUpdated", event);
+		obs_data_release(event);
+		obs_data_release(metrics);
+	}
+}
+
+} // namespace
+
+bool Subscribe(Subscription &subscription, std::string &error)
+{
+	const unsigned kinds = subscription.kinds ? subscription.kinds & kAllKinds : kAllKinds;
+	if (kinds == 0) {
+		error = "No known metrics requested";
+		return false;
+	}
+
+	// Whole seconds, since that is how often there is anything new
+	const int clamped = std::clamp(subscription.intervalMs, kMinIntervalMs, kMaxIntervalMs);
+	const int intervalMs = (clamped + 999) / 1000 * 1000;
+	const int leaseSeconds = std::clamp(subscription.leaseSeconds, kMinLeaseSeconds, kMaxLeaseSeconds);
+	const qint64 expiresAtMs = QDateTime::currentMSecsSinceEpoch() + qint64(leaseSeconds) * 1000;
+
+	State &s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	if (!s.running) {
+		error = "Metrics events are not available until OBS has finished loading";
+		return false;
+	}
+
+	Entry *entry = nullptr;
+	if (!subscription.id.empty()) {
+		for (Entry &existing : s.subscriptions) {
+			if (existing.id == subscription.id)
+				entry = &existing;
+		}
+		if (!entry) {
+			error = "Unknown or lapsed subscription";
+			return false;
+		}
+	} else {
+		if (s.subscriptions.size() >= kMaxSubscriptions) {
+			error = "Too many metrics subscriptions";
+			return false;
+		}
+		s.subscriptions.emplace_back();
+		entry = &s.subscriptions.back();
+		// Unique, not secret: every client receives every event and its
+		// subscriptionId, so subscriptions are not isolated per client
+		entry->id = QUuid::createUuid().toString(QUuid::WithoutBraces).toStdString();
+	}
+
+	// A changed set starts over with everything, so nothing asked for is missing
+	if (entry->kinds != kinds) {
+		entry->primed = false;
+		entry->observed = false;
+	}
+	entry->kinds = kinds;
+	entry->intervalMs = intervalMs;
+	entry->expiresAtMs = expiresAtMs;
+
+	subscription.id = entry->id;
+	subscription.kinds = kinds;
+	subscription.intervalMs = intervalMs;
+	subscription.leaseSeconds = leaseSeconds;
+
+	QMetaObject::invokeMethod(s.context, []() { syncObservers(); }, Qt::QueuedConnection);
+	return true;
+}
+
+bool Unsubscribe(const std::string &id)
+{
+	State &s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	const auto it = std::find_if(s.subscriptions.begin(), s.subscriptions.end(),
+				     [&id](const Entry &entry) { return entry.id == id; });
+	if (it == s.subscriptions.end())
+		return false;
+	s.subscriptions.erase(it);
+	if (s.running)
+		QMetaObject::invokeMethod(s.context, []() { syncObservers(); }, Qt::QueuedConnection);
+	return true;
+}
+
+void Start(obs_websocket_vendor vendor)
+{
+	State &s = state();
+	if (!vendor || s.context)
+		return;
+
+	s.vendor = vendor;
+	auto *context = new QObject();
+	Monitor &monitor = Monitor::instance();
+	QObject::connect(&monitor, &Monitor::updated, context,
+			 [](Kind kind) { ++state().versions[static_cast<int>(kind)]; });
+	QObject::connect(&monitor, &Monitor::sampled, context, []() { publish(); });
+
+	std::lock_guard<std::mutex> lock(s.mutex);
+	s.context = context;
+	s.running = true;
+}
+
+void Stop()
+{
+	State &s = state();
+	QObject *context = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		context = s.context;
+		s.context = nullptr;
+		s.running = false;
+		s.subscriptions.clear();
+	}
+	if (!context)
+		return;
+
+	// Takes the connections and any queued syncs with it
+	delete context;
+	syncObservers();
+	s.vendor = nullptr;
+}
+
+} // namespace MetricsEvents
+} // namespace StreamUP
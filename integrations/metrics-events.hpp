@@ -0,0 +1,55 @@
+#ifndef STREAMUP_METRICS_EVENTS_HPP
+#define STREAMUP_METRICS_EVENTS_HPP
+
+#include "../obs-websocket-api.h"
+
+#include <string>
+
+namespace StreamUP {
+
+/**
+ * MetricsUpdated vendor events, pushed to websocket clients that subscribe.
+ *
+ * Polling GetBitrate gave every client its own request per reading, all of
+ * them served from one set of shared counters. Here the toolbar's status
+ * Monitor does the sampling, once, and each tick every subscription that is
+ * due gets one event holding only the readings that have changed since its
+ * last one. A new subscription's first event holds everything it asked for,
+ * and comes on the first tick after all of it is being sampled.
+ *
+ * obs-websocket sends vendor events to every client and never tells a vendor
+ * when one disconnects. So each event names the subscription it is for, and a
+ * subscription lapses unless it is renewed (subscribed again with its id)
+ * within its lease.
+ *
+ * Start and Stop are UI-thread calls. Subscribe and Unsubscribe are safe from
+ * the websocket thread.
+ */
+namespace MetricsEvents {
+
+struct Subscription {
+	std::string id;       // empty to create a subscription, or one to renew or change
+	unsigned kinds = 0;   // bit per ToolbarStatus::Kind; 0 for every reading
+	int intervalMs = 1000;
+	int leaseSeconds = 60;
+};
+
+/**
+ * Create, renew or change a subscription. The interval and lease are clamped
+ * to what is supported and written back, along with the id.
+ */
+bool Subscribe(Subscription &subscription, std::string &error);
+
+/** End a subscription. False if there was no such subscription. */
+bool Unsubscribe(const std::string &id);
+
+/** Start serving subscriptions. Call once OBS has finished loading. */
+void Start(obs_websocket_vendor vendor);
+
+/** Drop every subscription. Called at frontend exit. */
+void Stop();
+
+} // namespace MetricsEvents
+} // namespace StreamUP
+
+#endif // STREAMUP_METRICS_EVENTS_HPP
@@ -0,0 +1,126 @@
+#include "request-stats.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+namespace StreamUP {
+namespace RequestStats {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Record {
+	std::string requestType;
+	WebSocketAPI::RequestHandler handler = nullptr;
+
+	std::atomic<uint64_t> calls{0};
+	std::atomic<uint64_t> errors{0};
+	std::atomic<uint64_t> totalUs{0};
+	std::atomic<uint64_t> maxUs{0};
+	std::atomic<uint64_t> buckets[kBucketCount] = {};
+};
+
+struct State {
+	// Guards the list, not the counters. Taken only to add a record and to
+	// walk them, never by Dispatch.
+	std::mutex mutex;
+	std::deque<Record> records; // never shrinks, so a record's address is stable
+	std::atomic<Clock::rep> resetAt{Clock::now().time_since_epoch().count()};
+};
+
+State &state()
+{
+	static State s;
+	return s;
+}
+
+int bucketFor(uint64_t us)
+{
+	int bucket = 0;
+	while (bucket < kBucketCount - 1 && us > kBucketBoundsUs[bucket])
+		++bucket;
+	return bucket;
+}
+
+} // namespace
+
+void *Instrument(const char *requestType, WebSocketAPI::RequestHandler handler)
+{
+	State &s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	s.records.emplace_back();
+	Record &record = s.records.back();
+	record.requestType = requestType;
+	record.handler = handler;
+	return &record;
+}
+
+void Dispatch(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
+{
+	Record &record = *static_cast<Record *>(private_data);
+
+	const Clock::time_point start = Clock::now();
+	record.handler(request_data, response_data, nullptr);
+	const uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+
+	record.calls.fetch_add(1, std::memory_order_relaxed);
+	if (!WebSocketAPI::ResponseSucceeded(response_data))
+		record.errors.fetch_add(1, std::memory_order_relaxed);
+	record.totalUs.fetch_add(us, std::memory_order_relaxed);
+	record.buckets[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+
+	uint64_t max = record.maxUs.load(std::memory_order_relaxed);
+	while (us > max && !record.maxUs.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+	}
+}
+
+std::vector<Snapshot> Collect()
+{
+	State &s = state();
+	std::vector<Snapshot> snapshots;
+	std::lock_guard<std::mutex> lock(s.mutex);
+	for (const Record &record : s.records) {
+		const uint64_t calls = record.calls.load(std::memory_order_relaxed);
+		if (calls == 0)
+			continue;
+
+		Snapshot snapshot;
+		snapshot.requestType = record.requestType;
+		snapshot.calls = calls;
+		snapshot.errors = record.errors.load(std::memory_order_relaxed);
+		snapshot.totalUs = record.totalUs.load(std::memory_order_relaxed);
+		snapshot.maxUs = record.maxUs.load(std::memory_order_relaxed);
+		for (int bucket = 0; bucket < kBucketCount; ++bucket)
+			snapshot.buckets[bucket] = record.buckets[bucket].load(std::memory_order_relaxed);
+		snapshots.push_back(std::move(snapshot));
+	}
+	return snapshots;
+}
+
+void Reset()
+{
+	State &s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	for (Record &record : s.records) {
+		record.calls.store(0, std::memory_order_relaxed);
+		record.errors.store(0, std::memory_order_relaxed);
+		record.totalUs.store(0, std::memory_order_relaxed);
+		record.maxUs.store(0, std::memory_order_relaxed);
+		for (std::atomic<uint64_t> &bucket : record.buckets)
+			bucket.store(0, std::memory_order_relaxed);
+	}
+	s.resetAt.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+double SecondsSinceReset()
+{
+	const Clock::duration since = Clock::now().time_since_epoch() -
+				      Clock::duration(state().resetAt.load(std::memory_order_relaxed));
+	return std::chrono::duration<double>(since).count();
+}
+
+} // namespace RequestStats
+} // namespace StreamUP
@@ -0,0 +1,64 @@
+#ifndef STREAMUP_REQUEST_STATS_HPP
+#define STREAMUP_REQUEST_STATS_HPP
+
+#include "websocket-api.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace StreamUP {
+
+/**
+ * Call counts, error counts and latency of every vendor request, by type.
+ *
+ * Which requests are slow or failing used to be a matter of reading the debug
+ * log. Every handler is now registered through Dispatch, which times the call,
+ * counts it and files its latency in a fixed histogram. The counters are
+ * relaxed atomics on a record made once at registration, so a call costs two
+ * clock reads and a few increments, with no lock and no allocation.
+ *
+ * Instrument is called while requests are registered. Dispatch, Collect and
+ * Reset are safe from any thread.
+ */
+namespace RequestStats {
+
+/** Upper bounds of the latency buckets in microseconds. One more bucket holds everything slower. */
+constexpr uint64_t kBucketBoundsUs[] = {10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000};
+constexpr int kBucketCount = sizeof(kBucketBoundsUs) / sizeof(kBucketBoundsUs[0]) + 1;
+
+struct Snapshot {
+	std::string requestType;
+	uint64_t calls = 0;
+	uint64_t errors = 0;
+	uint64_t totalUs = 0;
+	uint64_t maxUs = 0;
+	uint64_t buckets[kBucketCount] = {};
+};
+
+/**
+ * Make a record for a request type and return it, to be registered as the
+ * private data of Dispatch in place of the handler.
+ */
+void *Instrument(const char *requestType, WebSocketAPI::RequestHandler handler);
+
+/** Run the handler the record was made for, timing and counting the call. */
+void Dispatch(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
+
+/**
+ * Every request type called since the last reset, in registration order. The
+ * counters are read one by one, so a snapshot taken mid-call may be a call
+ * apart between them.
+ */
+std::vector<Snapshot> Collect();
+
+/** Zero every counter. */
+void Reset();
+
+/** Seconds since the counters were last reset, or since they started. */
+double SecondsSinceReset();
+
+} // namespace RequestStats
+} // namespace StreamUP
+
+#endif // STREAMUP_REQUEST_STATS_HPP
@@ -1,13 +1,20 @@
 #include "websocket-api.hpp"
 #include <streamup/debug-logger.hpp>
+#include <streamup/trace.hpp>
 #include "streamup-common.hpp"
 #include "../version.h"
 #include "plugin-manager.hpp"
 #include "source-manager.hpp"
+#include "scene-item-cache.hpp"
+#include "source-state-tracker.hpp"
 #include "file-manager.hpp"
 #include "../ui/hotkey-manager.hpp"
 #include "../ui/settings-manager.hpp"
 #include "backup-manager.hpp"
+#include "stream-health.hpp"
+#include "metrics-events.hpp"
+#include "request-stats.hpp"
+#include "../ui/streamup-toolbar-status.hpp"
 #include <obs-frontend-api.h>
 #include <obs-module.h>
 #include <util/platform.h>
@@ -15,6 +22,12 @@
 #include <QFileInfo>
 #include <QString>
 
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 // Forward declarations for functions from main streamup.cpp
 extern void GetShowHideTransition(obs_data_t *request_data, obs_data_t *response_data, void *private_data, bool transition_type);
 extern void SetShowHideTransition(obs_data_t *request_data, obs_data_t *response_data, void *private_data, bool show_transition);
@@ -28,6 +41,85 @@ struct SceneItemLookup {
 	obs_sceneitem_t *sceneitem = nullptr;
 };
 
+// Scenes and scene items found during one Batch, so a run of sub-requests on
+// the same sources looks each up once. Keyed by scene name and source name.
+// The current scene is never cached by scene: an earlier sub-request may have
+// switched it. Every entry holds a reference, which keeps the pointers good for
+// the batch; a hit is still checked before use, since an earlier sub-request
+// may have removed or renamed what was found.
+struct BatchLookupCache {
+	std::map<std::string, obs_source_t *> scenes;
+	std::map<std::pair<std::string, std::string>, obs_sceneitem_t *> items;
+
+	BatchLookupCache() = default;
+	BatchLookupCache(const BatchLookupCache &) = delete;
+	BatchLookupCache &operator=(const BatchLookupCache &) = delete;
+	~BatchLookupCache()
+	{
+		for (auto &entry : items)
+			obs_sceneitem_release(entry.second);
+		for (auto &entry : scenes)
+			obs_source_release(entry.second);
+	}
+};
+
+// Set while a Batch runs its sub-requests on this thread
+static thread_local BatchLookupCache *t_batchLookups = nullptr;
+
+// Returns a new reference to the named scene, or the current one if no name is given
+static obs_source_t *GetRequestScene(const char *scene_name)
+{
+	// Looked up every time: the frontend already holds it, and a cached one
+	// would go stale when a sub-request switches scene
+	if (!scene_name || !strlen(scene_name))
+		return obs_frontend_get_current_scene();
+
+	const std::string key = scene_name;
+	if (t_batchLookups) {
+		auto it = t_batchLookups->scenes.find(key);
+		if (it != t_batchLookups->scenes.end() && !obs_source_removed(it->second) &&
+		    strcmp(obs_source_get_name(it->second), scene_name) == 0)
+			return obs_source_get_ref(it->second);
+	}
+
+	obs_source_t *scene_source = obs_get_source_by_name(scene_name);
+	if (scene_source && t_batchLookups) {
+		obs_source_t *&slot = t_batchLookups->scenes[key];
+		if (slot)
+			obs_source_release(slot);
+		slot = obs_source_get_ref(scene_source);
+	}
+	return scene_source;
+}
+
+static obs_sceneitem_t *FindRequestSceneItem(obs_source_t *scene_source, const char *source_name)
+{
+	std::pair<std::string, std::string> key;
+	if (t_batchLookups) {
+		key = {obs_source_get_name(scene_source), source_name};
+		auto it = t_batchLookups->items.find(key);
+		if (it != t_batchLookups->items.end()) {
+			// A removed item has no scene; a renamed one no longer matches
+			obs_sceneitem_t *item = it->second;
+			if (obs_sceneitem_get_scene(item) &&
+			    strcmp(obs_source_get_name(obs_sceneitem_get_source(item)), source_name) == 0)
+				return item;
+		}
+	}
+
+	// Recursive, so sources nested inside groups are found (OBS treats groups
+	// as sub-scenes), and remembered, so the walk is not repeated per request
+	obs_sceneitem_t *item = StreamUP::SourceManager::SceneItemCache::Find(scene_source, source_name);
+	if (item && t_batchLookups) {
+		obs_sceneitem_t *&slot = t_batchLookups->items[key];
+		if (slot)
+			obs_sceneitem_release(slot);
+		obs_sceneitem_addref(item);
+		slot = item;
+	}
+	return item;
+}
+
 // Looks up a scene item by sourceName and optional sceneName from request data.
 // On success, caller MUST call obs_source_release(result.scene_source) when done.
 // On failure, sets error on response_data and returns empty result.
@@ -44,12 +136,7 @@ static SceneItemLookup FindSceneItemFromRequest(obs_data_t *request_data,
 		return result;
 	}
 
-	if (scene_name && strlen(scene_name)) {
-		result.scene_source = obs_get_source_by_name(scene_name);
-	} else {
-		result.scene_source = obs_frontend_get_current_scene();
-	}
-
+	result.scene_source = GetRequestScene(scene_name);
 	if (!result.scene_source) {
 		obs_data_set_string(response_data, "error", "Scene not found");
 		return result;
@@ -63,8 +150,7 @@ static SceneItemLookup FindSceneItemFromRequest(obs_data_t *request_data,
 		return result;
 	}
 
-	// Use recursive lookup so sources nested inside groups are found (OBS treats groups as sub-scenes)
-	result.sceneitem = obs_scene_find_source_recursive(scene, source_name);
+	result.sceneitem = FindRequestSceneItem(result.scene_source, source_name);
 	if (!result.sceneitem) {
 		obs_source_release(result.scene_source);
 		result.scene_source = nullptr;
@@ -92,40 +178,16 @@ void WebsocketRequestBitrate(obs_data_t *request_data, obs_data_t *response_data
 		return;
 	}
 
-	uint64_t bytesSent = obs_output_get_total_bytes(streamOutput);
-	uint64_t currentTime = os_gettime_ns();
-	static uint64_t lastBytesSent = 0;
-	static uint64_t lastTime = 0;
-	static bool initialized = false;
-
-	if (!initialized) {
-		lastBytesSent = bytesSent;
-		lastTime = currentTime;
-		initialized = true;
-		obs_data_set_int(response_data, "kbits-per-sec", 0);
-		obs_output_release(streamOutput);
-		return;
-	}
-
-	if (bytesSent < lastBytesSent) {
-		bytesSent = 0;
-	}
-
-	uint64_t bytesBetween = bytesSent - lastBytesSent;
-	double timePassed = (currentTime - lastTime) / 1000000000.0;
-
-	// Ensure timePassed is greater than zero to avoid division by zero
-	uint64_t bytesPerSec = 0;
-	if (timePassed > 0)
-		bytesPerSec = bytesBetween / timePassed;
-
-	uint64_t kbitsPerSec = (bytesPerSec * 8) / 1024;
+	obs_output_release(streamOutput);
 
-	lastBytesSent = bytesSent;
-	lastTime = currentTime;
+	// Read from the shared once-a-second sampler rather than worked out here,
+	// so callers polling at the same time cannot disturb each other's readings.
+	// It measures in kb/s; this request has always answered in units of 1024.
+	double kbps = 0.0;
+	StreamUP::StreamHealth::Latest(StreamUP::StreamHealth::Metric::StreamBitrate, kbps);
+	const uint64_t kbitsPerSec = static_cast<uint64_t>(kbps * 1000.0 / 1024.0);
 
 	obs_data_set_int(response_data, "kbits-per-sec", kbitsPerSec);
-	obs_output_release(streamOutput);
 }
 
 void WebsocketRequestVersion(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
@@ -179,19 +241,29 @@ void WebsocketRequestLockCurrentSources(obs_data_t *request_data, obs_data_t *re
 }
 
 // Read-only lock-state getters so a Stream Deck key can stay in sync after a
-// source is (un)locked in OBS directly, without toggling anything.
+// source is (un)locked in OBS directly, without toggling anything. Answered
+// from the state tracker's running counts; the walk is only for when those
+// are not settled.
 void WebsocketRequestGetAllSourcesLocked(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
 {
 	UNUSED_PARAMETER(request_data);
 	UNUSED_PARAMETER(private_data);
-	obs_data_set_bool(response_data, "lockState", StreamUP::SourceManager::AreAllSourcesLockedInAllScenes());
+	StreamUP::SourceManager::StateTracker::State state;
+	const bool locked = StreamUP::SourceManager::StateTracker::Current(state)
+				    ? state.allLocked
+				    : StreamUP::SourceManager::AreAllSourcesLockedInAllScenes();
+	obs_data_set_bool(response_data, "lockState", locked);
 }
 
 void WebsocketRequestGetCurrentSceneSourcesLocked(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
 {
 	UNUSED_PARAMETER(request_data);
 	UNUSED_PARAMETER(private_data);
-	obs_data_set_bool(response_data, "lockState", StreamUP::SourceManager::AreAllSourcesLockedInCurrentScene());
+	StreamUP::SourceManager::StateTracker::State state;
+	const bool locked = StreamUP::SourceManager::StateTracker::Current(state)
+				    ? state.currentSceneLocked
+				    : StreamUP::SourceManager::AreAllSourcesLockedInCurrentScene();
+	obs_data_set_bool(response_data, "lockState", locked);
 }
 
 // Read-only visibility of the current selection, so a Stream Deck key can show an
@@ -200,6 +272,12 @@ void WebsocketRequestGetSelectedVisibility(obs_data_t *request_data, obs_data_t
 {
 	UNUSED_PARAMETER(request_data);
 	UNUSED_PARAMETER(private_data);
+	StreamUP::SourceManager::StateTracker::State state;
+	if (StreamUP::SourceManager::StateTracker::Current(state)) {
+		obs_data_set_int(response_data, "count", state.selectionCount);
+		obs_data_set_bool(response_data, "visible", state.selectedVisible);
+		return;
+	}
 	obs_data_set_int(response_data, "count", StreamUP::SourceManager::GetSelectedSourceCount());
 	obs_data_set_bool(response_data, "visible", StreamUP::SourceManager::CheckIfAnySelectedVisible());
 }
@@ -875,23 +953,75 @@ void WebsocketRequestCreateBackup(obs_data_t *request_data, obs_data_t *response
 		path = QDir(folder).filePath(StreamUP::Backup::SuggestedFileName());
 	}
 
-	const StreamUP::Backup::Result result = StreamUP::Backup::CreateBackup(path, options);
-	obs_data_set_bool(response_data, "success", result.success);
-	if (!result.success) {
-		obs_data_set_string(response_data, "error", result.error.toUtf8().constData());
+	QString error;
+	const QString jobId = StreamUP::Backup::Jobs::Submit(path, options, error);
+	if (jobId.isEmpty()) {
+		obs_data_set_bool(response_data, "success", false);
+		obs_data_set_string(response_data, "error", error.toUtf8().constData());
+		return;
+	}
+
+	obs_data_set_bool(response_data, "success", true);
+	obs_data_set_string(response_data, "jobId", jobId.toUtf8().constData());
+	obs_data_set_string(response_data, "filePath", path.toUtf8().constData());
+}
+
+void SetBackupJobFields(obs_data_t *data, const StreamUP::Backup::Jobs::Status &status)
+{
+	using StreamUP::Backup::Jobs::State;
+
+	obs_data_set_string(data, "jobId", status.id.toUtf8().constData());
+	obs_data_set_string(data, "state", StreamUP::Backup::Jobs::StateKey(status.state));
+	obs_data_set_string(data, "filePath", status.archivePath.toUtf8().constData());
+	obs_data_set_int(data, "done", status.done);
+	obs_data_set_int(data, "total", status.total);
+	if (!status.stage.isEmpty())
+		obs_data_set_string(data, "stage", status.stage.toUtf8().constData());
+
+	if (status.state == State::Failed || status.state == State::Cancelled) {
+		obs_data_set_string(data, "error", status.result.error.toUtf8().constData());
 		return;
 	}
+	if (status.state != State::Succeeded)
+		return;
 
-	obs_data_set_string(response_data, "filePath", result.archivePath.toUtf8().constData());
-	obs_data_set_int(response_data, "fileCount", result.fileCount);
-	obs_data_set_int(response_data, "sizeBytes", result.archiveBytes);
-	obs_data_set_bool(response_data, "credentialsIncluded", result.credentialsIncluded);
+	const StreamUP::Backup::Result &result = status.result;
+	obs_data_set_int(data, "fileCount", result.fileCount);
+	obs_data_set_int(data, "sizeBytes", result.archiveBytes);
+	obs_data_set_bool(data, "credentialsIncluded", result.credentialsIncluded);
 	// The audit is the useful part for automation: a scene pointing at a file
 	// that no longer exists is a broken source, and this is how a dashboard
 	// would notice.
-	obs_data_set_int(response_data, "mediaReferenced", result.mediaReferenced);
-	obs_data_set_int(response_data, "mediaMissing", result.mediaMissing);
-	obs_data_set_int(response_data, "largeFilesSkipped", result.skippedLargeFiles.size());
+	obs_data_set_int(data, "mediaReferenced", result.mediaReferenced);
+	obs_data_set_int(data, "mediaMissing", result.mediaMissing);
+	obs_data_set_int(data, "largeFilesSkipped", result.skippedLargeFiles.size());
+}
+
+void WebsocketRequestGetBackupJob(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
+{
+	UNUSED_PARAMETER(private_data);
+
+	StreamUP::Backup::Jobs::Status status;
+	if (!StreamUP::Backup::Jobs::Get(QString::fromUtf8(obs_data_get_string(request_data, "jobId")), status)) {
+		obs_data_set_bool(response_data, "success", false);
+		obs_data_set_string(response_data, "error", "No such backup job");
+		return;
+	}
+
+	SetBackupJobFields(response_data, status);
+	obs_data_set_bool(response_data, "success", true);
+}
+
+void WebsocketRequestCancelBackupJob(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
+{
+	UNUSED_PARAMETER(private_data);
+
+	if (!StreamUP::Backup::Jobs::Cancel(QString::fromUtf8(obs_data_get_string(request_data, "jobId")))) {
+		obs_data_set_bool(response_data, "success", false);
+		obs_data_set_string(response_data, "error", "No such backup job, or it has already finished");
+		return;
+	}
+	obs_data_set_bool(response_data, "success", true);
 }
 
 void WebsocketRequestGetBackupInfo(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
@@ -927,5 +1057,375 @@ void WebsocketRequestGetBackupInfo(obs_data_t *request_data, obs_data_t *respons
 	obs_data_set_bool(response_data, "success", true);
 }
 
+
+//-------------------STREAM HEALTH-------------------
+void WebsocketRequestGetStreamHealth(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
+{
+	UNUSED_PARAMETER(private_data);
+
+	using StreamUP::StreamHealth::Metric;
+	using StreamUP::StreamHealth::Window;
+
+	const char *only = obs_data_get_string(request_data, "metric");
+	const bool filtered = only && *only;
+
+	obs_data_t *metrics = obs_data_create();
+	bool found = false;
+	for (int m = 0; m < static_cast<int>(Metric::Count); ++m) {
+		const Metric metric = static_cast<Metric>(m);
+		const char *metricKey = StreamUP::StreamHealth::MetricKey(metric);
+		if (filtered && strcmp(only, metricKey) != 0)
+			continue;
+		found = true;
+
+		obs_data_t *windows = obs_data_create();
+		for (int w = 0; w < static_cast<int>(Window::Count); ++w) {
+			const Window window = static_cast<Window>(w);
+			const StreamUP::StreamHealth::Stats stats = StreamUP::StreamHealth::Get(metric, window);
+
+			obs_data_t *entry = obs_data_create();
+			obs_data_set_int(entry, "samples", stats.samples);
+			obs_data_set_double(entry, "min", stats.min);
+			obs_data_set_double(entry, "mean", stats.mean);
+			obs_data_set_double(entry, "p95", stats.p95);
+			obs_data_set_double(entry, "trendPerMinute", stats.trendPerMinute);
+			obs_data_set_obj(windows, StreamUP::StreamHealth::WindowKey(window), entry);
+			obs_data_release(entry);
+		}
+		obs_data_set_obj(metrics, metricKey, windows);
+		obs_data_release(windows);
+	}
+
+	if (!found) {
+		obs_data_release(metrics);
+		obs_data_set_bool(response_data, "success", false);
+		obs_data_set_string(response_data, "error", "Unknown metric");
+		return;
+	}
+
+	obs_data_set_obj(response_data, "metrics", metrics);
+	obs_data_release(metrics);
+	obs_data_set_bool(response_data, "success", true);
+}
+
+
+//-------------------METRICS EVENTS-------------------
+void WebsocketRequestSubscribeMetrics(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
+{
+	UNUSED_PARAMETER(private_data);
+
+	StreamUP::MetricsEvents::Subscription subscription;
+	subscription.id = obs_data_get_string(request_data, "subscriptionId");
+
+	const QString metrics = QString::fromUtf8(obs_data_get_string(request_data, "metrics"));
+	for (const QString &name : metrics.split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+		StreamUP::ToolbarStatus::Kind kind;
+		if (!StreamUP::ToolbarStatus::kindFromKey(name.trimmed(), kind)) {
+			obs_data_set_bool(response_data, "success", false);
+			obs_data_set_string(response_data, "error",
+					    QStringLiteral("Unknown metric: %1").arg(name.trimmed()).toUtf8().constData());
+			return;
+		}
+		subscription.kinds |= 1u << static_cast<int>(kind);
+	}
+
+	obs_data_set_default_int(request_data, "intervalMs", subscription.intervalMs);
+	obs_data_set_default_int(request_data, "leaseSeconds", subscription.leaseSeconds);
+	subscription.intervalMs = static_cast<int>(obs_data_get_int(request_data, "intervalMs"));
+	subscription.leaseSeconds = static_cast<int>(obs_data_get_int(request_data, "leaseSeconds"));
+
+	std::string error;
+	if (!StreamUP::MetricsEvents::Subscribe(subscription, error)) {
+		obs_data_set_bool(response_data, "success", false);
+		obs_data_set_string(response_data, "error", error.c_str());
+		return;
+	}
+
+	QStringList names;
+	for (int i = 0; i <= static_cast<int>(StreamUP::ToolbarStatus::Kind::Message); ++i) {
+		if (subscription.kinds & (1u << i))
+			names << StreamUP::ToolbarStatus::kindKey(static_cast<StreamUP::ToolbarStatus::Kind>(i));
+	}
+
+	obs_data_set_string(response_data, "subscriptionId", subscription.id.c_str());
+	obs_data_set_string(response_data, "metrics", names.join(QLatin1Char(',')).toUtf8().constData());
+	obs_data_set_int(response_data, "intervalMs", subscription.intervalMs);
+	obs_data_set_int(response_data, "leaseSeconds", subscription.leaseSeconds);
+	obs_data_set_bool(response_data, "success", true);
+}
+
+void WebsocketRequestUnsubscribeMetrics(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
+{
+	UNUSED_PARAMETER(private_data);
+
+	if (!StreamUP::MetricsEvents::Unsubscribe(obs_data_get_string(request_data, "subscriptionId"))) {
+		obs_data_set_bool(response_data, "success", false);
+		obs_data_set_string(response_data, "error", "Unknown or lapsed subscription");
+		return;
+	}
+	obs_data_set_bool(response_data, "success", true);
+}
+
+
+//-------------------TRACING-------------------
+void WebsocketRequestExportTrace(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
+{
+	UNUSED_PARAMETER(private_data);
+
+	if (!StreamUP::Trace::IsCompiledIn()) {
+		obs_data_set_bool(response_data, "success", false);
+		obs_data_set_string(response_data, "error", "This build of StreamUP does not record traces");
+		return;
+	}
+
+	const char *filePath = obs_data_get_string(request_data, "filePath");
+	if (filePath && *filePath) {
+		if (!StreamUP::Trace::WriteChromeJson(filePath)) {
+			obs_data_set_bool(response_data, "success", false);
+			obs_data_set_string(response_data, "error", "Could not write the trace file");
+			return;
+		}
+		obs_data_set_string(response_data, "filePath", filePath);
+	} else {
+		obs_data_set_string(response_data, "trace", StreamUP::Trace::ExportChromeJson().c_str());
+	}
+
+	if (obs_data_get_bool(request_data, "clear"))
+		StreamUP::Trace::Clear();
+
+	obs_data_set_bool(response_data, "success", true);
+}
+
+//-------------------BATCH-------------------
+namespace {
+
+struct BatchEntry {
+	RequestHandler handler = nullptr;
+	void *private_data = nullptr;
+};
+
+// Filled while requests are registered and only read afterwards, so no lock
+std::unordered_map<std::string, BatchEntry> &BatchRequests()
+{
+	static std::unordered_map<std::string, BatchEntry> requests;
+	return requests;
+}
+
+// A batch is answered in one response, so keep that response a sane size
+constexpr size_t kMaxBatchRequests = 256;
+
+// Requests that only read or set fields on a scene item found through the
+// lookup cache. Nothing else is safe with the graphics context held: most of
+// the others take libobs locks the video thread takes in the other order, or
+// wait on the UI thread.
+bool AllowedInAtomicBatch(const std::string &request_type)
+{
+	return request_type == "GetBlendingMethod" || request_type == "SetBlendingMethod" ||
+	       request_type == "GetScaleFiltering" || request_type == "SetScaleFiltering";
+}
+
+} // namespace
+
+bool ResponseSucceeded(obs_data_t *response_data)
+{
+	// Handlers report failure either way: an "error" string, or "success" false
+	const char *error = obs_data_get_string(response_data, "error");
+	if (error && *error)
+		return false;
+	if (obs_data_has_user_value(response_data, "success"))
+		return obs_data_get_bool(response_data, "success");
+	return true;
+}
+
+void AddBatchRequest(const char *request_type, RequestHandler handler, void *private_data)
+{
+	BatchRequests()[request_type] = {handler, private_data};
+}
+
+void WebsocketRequestBatch(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
+{
+	UNUSED_PARAMETER(private_data);
+	STREAMUP_TRACE_SCOPE("WebSocketAPI::Batch");
+
+	if (t_batchLookups) {
+		obs_data_set_bool(response_data, "success", false);
+		obs_data_set_string(response_data, "error", "Batch requests cannot be nested");
+		return;
+	}
+
+	obs_data_array_t *requests = obs_data_get_array(request_data, "requests");
+	const size_t count = requests ? obs_data_array_count(requests) : 0;
+	if (count == 0 || count > kMaxBatchRequests) {
+		obs_data_array_release(requests);
+		obs_data_set_bool(response_data, "success", false);
+		obs_data_set_string(response_data, "error", "requests must be an array of 1 to 256 sub-requests");
+		return;
+	}
+
+	const bool halt_on_failure = obs_data_get_bool(request_data, "haltOnFailure");
+	const bool atomic = obs_data_get_bool(request_data, "atomic");
+
+	// Check every sub-request before running any, so a typo at the end does
+	// not leave the first half applied
+	struct Step {
+		std::string request_type;
+		const BatchEntry *entry = nullptr;
+		obs_data_t *request_data = nullptr;
+	};
+	std::vector<Step> steps;
+	steps.reserve(count);
+	std::string error;
+	for (size_t i = 0; i < count && error.empty(); ++i) {
+		obs_data_t *item = obs_data_array_item(requests, i);
+		Step step;
+		step.request_type = obs_data_get_string(item, "requestType");
+		step.request_data = obs_data_get_obj(item, "requestData");
+		if (!step.request_data)
+			step.request_data = obs_data_create();
+		obs_data_release(item);
+
+		auto it = BatchRequests().find(step.request_type);
+		if (it == BatchRequests().end() || step.request_type == "Batch")
+			error = "Unknown requestType in batch: " + step.request_type;
+		else if (atomic && !AllowedInAtomicBatch(step.request_type))
+			error = "Not allowed in an atomic batch: " + step.request_type;
+		else
+			step.entry = &it->second;
+		steps.push_back(step);
+	}
+	obs_data_array_release(requests);
+
+	if (!error.empty()) {
+		for (Step &step : steps)
+			obs_data_release(step.request_data);
+		obs_data_set_bool(response_data, "success", false);
+		obs_data_set_string(response_data, "error", error.c_str());
+		return;
+	}
+
+	BatchLookupCache lookups;
+	t_batchLookups = &lookups;
+
+	// Resolve everything up front. Inside the graphics context the handlers
+	// must only hit the cache: a fresh lookup takes the scene's mutex, which
+	// the video thread can hold while it waits for graphics. So a source that
+	// cannot be found fails the batch here, before anything has run.
+	if (atomic) {
+		for (Step &step : steps) {
+			obs_data_t *scratch = obs_data_create();
+			auto lookup = FindSceneItemFromRequest(step.request_data, scratch);
+			if (lookup.scene_source)
+				obs_source_release(lookup.scene_source);
+			else
+				error = step.request_type + ": " + obs_data_get_string(scratch, "error");
+			obs_data_release(scratch);
+			if (!error.empty())
+				break;
+		}
+		if (!error.empty()) {
+			t_batchLookups = nullptr;
+			for (Step &step : steps)
+				obs_data_release(step.request_data);
+			obs_data_set_bool(response_data, "success", false);
+			obs_data_set_string(response_data, "error", error.c_str());
+			return;
+		}
+		// Holding graphics keeps the frame from rendering half way through
+		obs_enter_graphics();
+	}
+
+	obs_data_array_t *results = obs_data_array_create();
+	long long failed = 0;
+	for (Step &step : steps) {
+		obs_data_t *sub_response = obs_data_create();
+		step.entry->handler(step.request_data, sub_response, step.entry->private_data);
+		const bool succeeded = ResponseSucceeded(sub_response);
+
+		obs_data_t *result = obs_data_create();
+		obs_data_set_string(result, "requestType", step.request_type.c_str());
+		obs_data_set_bool(result, "success", succeeded);
+		obs_data_set_obj(result, "responseData", sub_response);
+		obs_data_array_push_back(results, result);
+		obs_data_release(result);
+		obs_data_release(sub_response);
+
+		if (!succeeded) {
+			failed++;
+			if (halt_on_failure)
+				break;
+		}
+	}
+
+	if (atomic)
+		obs_leave_graphics();
+	t_batchLookups = nullptr;
+
+	for (Step &step : steps)
+		obs_data_release(step.request_data);
+
+	obs_data_set_array(response_data, "results", results);
+	obs_data_array_release(results);
+	obs_data_set_int(response_data, "failedCount", failed);
+	obs_data_set_bool(response_data, "success", true);
+}
+
+//-------------------VENDOR STATS-------------------
+void WebsocketRequestGetVendorStats(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
+{
+	UNUSED_PARAMETER(private_data);
+
+	const char *only = obs_data_get_string(request_data, "requestType");
+
+	obs_data_array_t *bounds = obs_data_array_create();
+	for (uint64_t bound : StreamUP::RequestStats::kBucketBoundsUs) {
+		obs_data_t *entry = obs_data_create();
+		obs_data_set_int(entry, "leUs", (long long)bound);
+		obs_data_array_push_back(bounds, entry);
+		obs_data_release(entry);
+	}
+
+	obs_data_array_t *requests = obs_data_array_create();
+	for (const StreamUP::RequestStats::Snapshot &snapshot : StreamUP::RequestStats::Collect()) {
+		if (only && *only && snapshot.requestType != only)
+			continue;
+
+		obs_data_t *entry = obs_data_create();
+		obs_data_set_string(entry, "requestType", snapshot.requestType.c_str());
+		obs_data_set_int(entry, "calls", (long long)snapshot.calls);
+		obs_data_set_int(entry, "errors", (long long)snapshot.errors);
+		obs_data_set_double(entry, "meanUs", double(snapshot.totalUs) / double(snapshot.calls));
+		obs_data_set_int(entry, "maxUs", (long long)snapshot.maxUs);
+
+		obs_data_array_t *histogram = obs_data_array_create();
+		for (uint64_t count : snapshot.buckets) {
+			obs_data_t *bucket = obs_data_create();
+			obs_data_set_int(bucket, "count", (long long)count);
+			obs_data_array_push_back(histogram, bucket);
+			obs_data_release(bucket);
+		}
+		obs_data_set_array(entry, "histogram", histogram);
+		obs_data_array_release(histogram);
+
+		obs_data_array_push_back(requests, entry);
+		obs_data_release(entry);
+	}
+
+	obs_data_set_array(response_data, "bucketBounds", bounds);
+	obs_data_array_release(bounds);
+	obs_data_set_array(response_data, "requests", requests);
+	obs_data_array_release(requests);
+	obs_data_set_double(response_data, "secondsSinceReset", StreamUP::RequestStats::SecondsSinceReset());
+	obs_data_set_bool(response_data, "success", true);
+}
+
+void WebsocketRequestResetVendorStats(obs_data_t *request_data, obs_data_t *response_data, void *private_data)
+{
+	UNUSED_PARAMETER(request_data);
+	UNUSED_PARAMETER(private_data);
+
+	StreamUP::RequestStats::Reset();
+	obs_data_set_bool(response_data, "success", true);
+}
+
 } // namespace WebSocketAPI
 } // namespace StreamUP
@@ -3,6 +3,8 @@
 
 #include <obs-data.h>
 
+#include "../core/backup-jobs.hpp"
+
 namespace StreamUP {
 namespace WebSocketAPI {
 
@@ -310,7 +312,9 @@ void WebsocketToggleVisibilitySelectedSources(obs_data_t *request_data, obs_data
 
 //-------------------BACKUP-------------------
 /**
- * Create a backup of the whole OBS setup.
+ * Start a backup of the whole OBS setup as a background job and return its
+ * jobId straight away. Progress arrives as BackupProgress vendor events, and
+ * GetBackupJob reports the same at any time.
  * Optional request fields: filePath (defaults to the configured backup folder),
  * includeCredentials (default false), collectMedia (default false).
  * @param request_data Request data from WebSocket
@@ -319,6 +323,33 @@ void WebsocketToggleVisibilitySelectedSources(obs_data_t *request_data, obs_data
  */
 void WebsocketRequestCreateBackup(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
 
+/**
+ * Report a backup job: state (queued, running, succeeded, failed, cancelled),
+ * progress, and once finished what CreateBackup used to answer with.
+ * Optional request field: jobId (defaults to the most recent job).
+ * @param request_data Request data from WebSocket
+ * @param response_data Response data to populate
+ * @param private_data Private data (unused)
+ */
+void WebsocketRequestGetBackupJob(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
+
+/**
+ * Cancel a queued or running backup job. The partial archive is removed.
+ * Optional request field: jobId (defaults to the most recent job).
+ * @param request_data Request data from WebSocket
+ * @param response_data Response data to populate
+ * @param private_data Private data (unused)
+ */
+void WebsocketRequestCancelBackupJob(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
+
+/**
+ * Fill in a backup job's fields, shared by GetBackupJob and the BackupProgress
+ * event so the two always read the same.
+ * @param data Response or event data to populate
+ * @param status The job to describe
+ */
+void SetBackupJobFields(obs_data_t *data, const StreamUP::Backup::Jobs::Status &status);
+
 /**
  * Report backup settings and list the backups that exist, newest first.
  * @param request_data Request data from WebSocket
@@ -327,6 +358,119 @@ void WebsocketRequestCreateBackup(obs_data_t *request_data, obs_data_t *response
  */
 void WebsocketRequestGetBackupInfo(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
 
+
+//-------------------STREAM HEALTH-------------------
+/**
+ * Rolling statistics of stream health over the last 10 seconds, minute and
+ * 5 minutes: for each of streamBitrate (kb/s), droppedFrames,
+ * renderLaggedFrames, encodeSkippedFrames (per second) and cpuUsage (percent),
+ * an object per window ("10s", "1m", "5m") with samples, min, mean, p95 and
+ * trendPerMinute. Optional request field: metric, to return only that one.
+ * @param request_data Request data from WebSocket
+ * @param response_data Response data to populate
+ * @param private_data Private data (unused)
+ */
+void WebsocketRequestGetStreamHealth(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
+
+
+//-------------------METRICS EVENTS-------------------
+/**
+ * Subscribe to MetricsUpdated vendor events, or renew or change a subscription.
+ * Optional request fields: subscriptionId (to renew or change one), metrics
+ * (comma-separated status readout keys such as "cpu,stream_bitrate"; default
+ * all), intervalMs (default 1000, whole seconds from 1000 to 60000),
+ * leaseSeconds (default 60; the subscription lapses unless renewed within it).
+ * Each event carries subscriptionId and a metrics object with only the
+ * readings that changed since that subscription's last event. Events go to
+ * every connected client, so any client can renew or end any subscription.
+ * @param request_data Request data from WebSocket
+ * @param response_data Response data to populate
+ * @param private_data Private data (unused)
+ */
+void WebsocketRequestSubscribeMetrics(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
+
+/**
+ * End a metrics subscription. Required request field: subscriptionId.
+ * @param request_data Request data from WebSocket
+ * @param response_data Response data to populate
+ * @param private_data Private data (unused)
+ */
+void WebsocketRequestUnsubscribeMetrics(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
+
+
+//-------------------TRACING-------------------
+/**
+ * Export the recorded tracing spans as Chrome/Perfetto trace JSON.
+ * Optional request fields: filePath (write the trace there instead of returning
+ * it as the "trace" string), clear (default false, forget the spans afterwards).
+ * Fails on builds without ENABLE_TRACING.
+ * @param request_data Request data from WebSocket
+ * @param response_data Response data to populate
+ * @param private_data Private data (unused)
+ */
+void WebsocketRequestExportTrace(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
+
+
+//-------------------BATCH-------------------
+/** The signature of every vendor request handler. */
+using RequestHandler = void (*)(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
+
+/**
+ * Make a vendor request available as a Batch sub-request. Called while the
+ * requests are registered, before Batch itself is.
+ * @param request_type The name the request is registered under
+ * @param handler The request's handler
+ * @param private_data Passed to the handler as it would be by obs-websocket
+ */
+void AddBatchRequest(const char *request_type, RequestHandler handler, void *private_data);
+
+/**
+ * Whether a handler's response reports success. Handlers say they failed
+ * either with an "error" string or with "success" set to false.
+ * @param response_data The response a handler filled in
+ */
+bool ResponseSucceeded(obs_data_t *response_data);
+
+/**
+ * Run a list of vendor requests in order and answer for all of them at once.
+ * Scenes and scene items are looked up once for the whole batch, so a run of
+ * SetBlendingMethod calls on one scene resolves it a single time.
+ * Required request field: requests, an array of {requestType, requestData}.
+ * Optional request fields: haltOnFailure (default false, stop at the first
+ * failed sub-request), atomic (default false, apply every change on the same
+ * frame; only Get/SetBlendingMethod and Get/SetScaleFiltering are allowed).
+ * The response has results, one {requestType, success, responseData} per
+ * sub-request that ran, and failedCount.
+ * @param request_data Request data from WebSocket
+ * @param response_data Response data to populate
+ * @param private_data Private data (unused)
+ */
+void WebsocketRequestBatch(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
+
+
+
+//-------------------VENDOR STATS-------------------
+/**
+ * Call counts, error counts and latency of every vendor request called since
+ * the last reset. The response has bucketBounds (the upper bound of each
+ * latency bucket in microseconds, leUs; one more bucket holds everything
+ * slower), secondsSinceReset, and requests: one {requestType, calls, errors,
+ * meanUs, maxUs, histogram} per request type, histogram being the count in
+ * each bucket. Optional request field: requestType, to return only that one.
+ * @param request_data Request data from WebSocket
+ * @param response_data Response data to populate
+ * @param private_data Private data (unused)
+ */
+void WebsocketRequestGetVendorStats(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
+
+/**
+ * Zero every vendor request counter.
+ * @param request_data Request data from WebSocket (unused)
+ * @param response_data Response data to populate
+ * @param private_data Private data (unused)
+ */
+void WebsocketRequestResetVendorStats(obs_data_t *request_data, obs_data_t *response_data, void *private_data);
+
 } // namespace WebSocketAPI
 } // namespace StreamUP
 
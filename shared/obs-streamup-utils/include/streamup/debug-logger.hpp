@@ -2,6 +2,7 @@
 #define STREAMUP_DEBUG_LOGGER_HPP
 
 #include <obs.h>
+#include <cstdint>
 #include <functional>
 #include <string>
 
@@ -112,12 +113,52 @@ void SetLogPrefix(const char* prefix);
  */
 void SetDebugLoggingPredicate(std::function<bool()> predicate);
 
+/**
+ * @brief Push the current state of the plugin's debug toggle
+ *
+ * The gate is checked before every debug line, so a plugin that can tell when
+ * its toggle changes should push the new state here: from then on the check is
+ * a single atomic load and the predicate is no longer called.
+ *
+ * @param enabled True while debug messages should be written
+ */
+void SetDebugLoggingEnabled(bool enabled);
+
 /**
  * @brief Check if debug logging is currently enabled
- * @return The predicate's answer, or false while no predicate is set
+ * @return The last state pushed with SetDebugLoggingEnabled(), otherwise the
+ *         predicate's answer, or false while neither is set
  */
 bool IsDebugLoggingEnabled();
 
+/**
+ * @brief Write debug lines from a background thread
+ *
+ * Once started, LogDebug() and LogDebugFormat() format into a per-thread buffer
+ * and push the line into a fixed-size lock-free queue that a single thread
+ * drains into blog(), so the caller never waits on the log file. Info, warning
+ * and error lines stay synchronous, and so can appear slightly ahead of debug
+ * lines logged just before them. If the queue is full the line is dropped and
+ * counted; the count is written to the log as a warning.
+ *
+ * Call once initialization is complete. A plugin that starts it must call
+ * StopAsyncLogging() before it unloads.
+ */
+void StartAsyncLogging();
+
+/**
+ * @brief Write out queued debug lines and stop the background thread
+ *
+ * Debug lines logged afterwards are written synchronously again.
+ */
+void StopAsyncLogging();
+
+/**
+ * @brief Number of debug lines dropped because the queue was full
+ * @return The count since the module loaded
+ */
+uint64_t GetDroppedDebugLineCount();
+
 } // namespace DebugLogger
 } // namespace StreamUP
 
@@ -0,0 +1,107 @@
+#ifndef STREAMUP_TRACE_HPP
+#define STREAMUP_TRACE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * Scoped timing spans for the UI, graphics and worker threads.
+ *
+ * STREAMUP_TRACE_SCOPE("Name") at the top of a function times it until the
+ * end of the enclosing scope. Each thread records into its own fixed-size
+ * buffer, newest spans overwriting the oldest, so recording never waits on
+ * another thread. ExportChromeJson() collects every buffer into the Trace Event
+ * format that chrome://tracing and ui.perfetto.dev open directly.
+ *
+ * Spans are only recorded when the plugin is built with STREAMUP_ENABLE_TRACING
+ * (the ENABLE_TRACING CMake option). Otherwise the macro expands to nothing and
+ * the export functions report that tracing is not built in.
+ */
+
+#ifdef STREAMUP_ENABLE_TRACING
+#define STREAMUP_TRACE_CONCAT_INNER(a, b) a##b
+#define STREAMUP_TRACE_CONCAT(a, b) STREAMUP_TRACE_CONCAT_INNER(a, b)
+/**
+ * @brief Time the rest of the enclosing scope
+ * @param name A string literal; only the pointer is stored
+ */
+#define STREAMUP_TRACE_SCOPE(name) ::StreamUP::Trace::Span STREAMUP_TRACE_CONCAT(streamupTraceSpan, __LINE__)(name)
+#else
+#define STREAMUP_TRACE_SCOPE(name) ((void)0)
+#endif
+
+namespace StreamUP {
+namespace Trace {
+
+/**
+ * @brief Monotonic clock the spans are measured on
+ * @return Nanoseconds since an arbitrary fixed point
+ */
+inline int64_t NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Store one finished span in the calling thread's buffer
+ * @param name Must outlive the trace, in practice a string literal
+ * @param beginNs Start time from NowNs()
+ * @param endNs End time from NowNs()
+ */
+void Record(const char* name, int64_t beginNs, int64_t endNs);
+
+/**
+ * @brief Records the time between its construction and destruction
+ *
+ * Use through STREAMUP_TRACE_SCOPE so it disappears from builds without
+ * tracing.
+ */
+class Span {
+public:
+    explicit Span(const char* name) : name_(name), beginNs_(NowNs()) {}
+    ~Span() { Record(name_, beginNs_, NowNs()); }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name_;
+    int64_t beginNs_;
+};
+
+/**
+ * @brief Check whether this build records spans at all
+ * @return True when built with STREAMUP_ENABLE_TRACING
+ */
+bool IsCompiledIn();
+
+/**
+ * @brief Label the calling thread in exported traces
+ * @param name Copied; e.g. "OBS UI"
+ */
+void SetThreadName(const char* name);
+
+/**
+ * @brief Collect every thread's spans as Chrome trace JSON
+ * @return The JSON document, or an empty string when tracing is not built in
+ */
+std::string ExportChromeJson();
+
+/**
+ * @brief Write ExportChromeJson() to a file
+ * @param path UTF-8 path of the file to create or replace
+ * @return True if the file was written
+ */
+bool WriteChromeJson(const std::string& path);
+
+/**
+ * @brief Forget every span recorded so far
+ */
+void Clear();
+
+} // namespace Trace
+} // namespace StreamUP
+
+#endif // STREAMUP_TRACE_HPP
@@ -1,10 +1,14 @@
 #include <streamup/debug-logger.hpp>
 #include <cstdarg>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <memory>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 
 namespace StreamUP {
 namespace DebugLogger {
@@ -12,29 +16,171 @@ namespace DebugLogger {
 // Thread-safe initialization tracking
 static std::atomic<bool> initializationComplete{false};
 
-// The prefix and the debug gate are both set once at module load and read from
-// every logging thread afterwards, so a plain mutex around the swap is enough:
-// it never contends in practice, and it keeps a half-written std::function or
-// std::string from being read mid-assignment.
+// The debug gate is set once at module load and read from every logging
+// thread afterwards, so a plain mutex around the swap is enough: it never
+// contends in practice, and it keeps a half-written std::function from being
+// read mid-assignment.
 static std::mutex configMutex;
-static std::string logPrefix = "[StreamUP]";
 static std::function<bool()> debugPredicate;
 
-static std::string Prefix()
+// The prefix is read on every line, so readers load a pointer instead of
+// copying a string under the lock. Prefixes are set once at load and never
+// freed, since another thread may still be formatting with the previous one.
+static const std::string defaultPrefix = "[StreamUP]";
+static std::atomic<const std::string *> logPrefix{&defaultPrefix};
+
+// Pushed by the plugin whenever its toggle changes. Until then the predicate
+// decides.
+enum DebugGate : int { GateUnset, GateOff, GateOn };
+static std::atomic<int> debugGate{GateUnset};
+
+static const std::string &Prefix()
 {
-    std::lock_guard<std::mutex> lock(configMutex);
-    return logPrefix;
+    return *logPrefix.load(std::memory_order_acquire);
 }
 
-static std::string FormatMessage(const char* feature, const char* operation, const char* message)
+//-------------------ASYNC DEBUG OUTPUT-------------------
+// Debug lines are formatted into a per-thread buffer and pushed into a bounded
+// ring that a single thread drains into blog(), so a caller on the render or UI
+// thread never waits on the log file. The ring is a Vyukov-style bounded queue:
+// each slot carries a sequence number, producers claim a position with one CAS
+// and publish by bumping the slot's sequence, and nothing takes a lock. When it
+// is full the line is counted and dropped rather than blocking the caller.
+
+static constexpr size_t kRingSize = 512;    // power of two
+static constexpr size_t kRecordText = 512;  // longer lines are written synchronously
+static constexpr size_t kArenaSize = 4096;  // longer lines are formatted on the heap
+static constexpr auto kDrainInterval = std::chrono::milliseconds(50);
+
+struct Record {
+    std::atomic<size_t> sequence{0};
+    size_t length = 0;
+    char text[kRecordText];
+};
+
+struct Ring {
+    Record records[kRingSize];
+    Ring()
+    {
+        for (size_t i = 0; i < kRingSize; ++i)
+            records[i].sequence.store(i, std::memory_order_relaxed);
+    }
+};
+
+static Ring ring;
+static std::atomic<size_t> enqueuePos{0};
+static size_t dequeuePos = 0; // drain thread only
+
+static std::atomic<bool> asyncActive{false};
+static std::atomic<int> producersInFlight{0};
+static std::atomic<uint64_t> droppedSinceReport{0};
+static std::atomic<uint64_t> droppedTotal{0};
+static std::atomic<bool> wakePending{false};
+static std::atomic<bool> drainStopping{false};
+static std::mutex drainMutex; // guards the thread handle and the wake wait
+static std::condition_variable drainWake;
+static std::thread drainThread;
+
+static bool PushRecord(const char *text, size_t length)
 {
-    if (operation && strlen(operation) > 0) {
-        return Prefix() + " [" + feature + "] " + operation + ": " + message;
-    } else {
-        return Prefix() + " [" + feature + "] " + message;
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Record *record = nullptr;
+    for (;;) {
+        record = &ring.records[pos & (kRingSize - 1)];
+        const size_t sequence = record->sequence.load(std::memory_order_acquire);
+        const intptr_t diff = intptr_t(sequence) - intptr_t(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            return false; // full
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    memcpy(record->text, text, length);
+    record->text[length] = '\0';
+    record->length = length;
+    record->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+// Drain thread only
+static bool DrainRecords()
+{
+    bool drained = false;
+    for (;;) {
+        Record &record = ring.records[dequeuePos & (kRingSize - 1)];
+        if (record.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+            break;
+        blog(LOG_DEBUG, "%s", record.text);
+        record.sequence.store(dequeuePos + kRingSize, std::memory_order_release);
+        ++dequeuePos;
+        drained = true;
+    }
+
+    const uint64_t dropped = droppedSinceReport.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        blog(LOG_WARNING, "%s [Logger] Dropped %llu debug line(s): the log queue was full", Prefix().c_str(),
+             (unsigned long long)dropped);
     }
+    return drained;
 }
 
+static void DrainLoop()
+{
+    for (;;) {
+        DrainRecords();
+        if (drainStopping.load(std::memory_order_acquire)) {
+            DrainRecords();
+            return;
+        }
+
+        // Producers do not take the mutex, so a wake can slip past just before
+        // the wait; the interval bounds how long a line can sit in the ring.
+        std::unique_lock<std::mutex> lock(drainMutex);
+        drainWake.wait_for(lock, kDrainInterval, [] {
+            return wakePending.load(std::memory_order_acquire) || drainStopping.load(std::memory_order_acquire);
+        });
+        wakePending.store(false, std::memory_order_release);
+    }
+}
+
+// Writes a finished debug line: through the ring when async output is on,
+// otherwise (or when the line is too long for a slot) straight to blog().
+static void EmitDebugLine(const char *text, size_t length)
+{
+    if (length < kRecordText) {
+        // Sequentially consistent, with the store and load in StopAsyncLogging:
+        // each side writes its flag then reads the other's, and only a single
+        // total order guarantees at least one of them sees the other's write.
+        producersInFlight.fetch_add(1, std::memory_order_seq_cst);
+        if (asyncActive.load(std::memory_order_seq_cst)) {
+            if (PushRecord(text, length)) {
+                if (!wakePending.exchange(true, std::memory_order_acq_rel))
+                    drainWake.notify_one();
+            } else {
+                droppedSinceReport.fetch_add(1, std::memory_order_relaxed);
+                droppedTotal.fetch_add(1, std::memory_order_relaxed);
+            }
+            producersInFlight.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        producersInFlight.fetch_sub(1, std::memory_order_release);
+    }
+    blog(LOG_DEBUG, "%s", text);
+}
+
+static bool DebugLineWanted()
+{
+    // During initialization, always log debug messages to avoid mutex deadlock
+    // After initialization, respect the user's debug logging setting
+    return !initializationComplete.load(std::memory_order_relaxed) || IsDebugLoggingEnabled();
+}
+
+static thread_local char arena[kArenaSize];
+
 static std::string FormatMessageSimple(const char* feature, const char* message)
 {
     return Prefix() + " [" + feature + "] " + message;
@@ -60,32 +206,69 @@ static std::string FormatStringArgs(const char* format, va_list args)
     return std::string(buffer.get());
 }
 
+// Formats "<prefix> [feature] operation: " into the arena and returns its length
+static int FormatDebugHeader(const char* feature, const char* operation)
+{
+    int length;
+    if (operation && *operation) {
+        length = snprintf(arena, kArenaSize, "%s [%s] %s: ", Prefix().c_str(), feature, operation);
+    } else {
+        length = snprintf(arena, kArenaSize, "%s [%s] ", Prefix().c_str(), feature);
+    }
+    return length;
+}
+
 void LogDebug(const char* feature, const char* operation, const char* message)
 {
-    // During initialization, always log debug messages to avoid mutex deadlock
-    // After initialization, respect the user's debug logging setting
-    if (!initializationComplete.load() || IsDebugLoggingEnabled()) {
-        std::string formatted = FormatMessage(feature, operation, message);
-        blog(LOG_DEBUG, "%s", formatted.c_str());
+    if (!DebugLineWanted()) {
+        return;
+    }
+
+    const int header = FormatDebugHeader(feature, operation);
+    if (header < 0 || size_t(header) >= kArenaSize) {
+        return;
+    }
+    const int body = snprintf(arena + header, kArenaSize - header, "%s", message);
+    if (body < 0) {
+        return;
+    }
+    if (size_t(header) + size_t(body) < kArenaSize) {
+        EmitDebugLine(arena, size_t(header) + size_t(body));
+    } else {
+        std::string formatted = std::string(arena, header) + message;
+        EmitDebugLine(formatted.c_str(), formatted.size());
     }
 }
 
 void LogDebugFormat(const char* feature, const char* operation, const char* format, ...)
 {
-    // During initialization, always log debug messages to avoid mutex deadlock
-    // After initialization, respect the user's debug logging setting
-    if (!initializationComplete.load() || IsDebugLoggingEnabled()) {
-        va_list args;
-        va_start(args, format);
-
-        std::string message = FormatStringArgs(format, args);
-        if (!message.empty()) {
-            std::string formatted = FormatMessage(feature, operation, message.c_str());
-            blog(LOG_DEBUG, "%s", formatted.c_str());
-        }
+    if (!DebugLineWanted()) {
+        return;
+    }
 
-        va_end(args);
+    const int header = FormatDebugHeader(feature, operation);
+    if (header < 0 || size_t(header) >= kArenaSize) {
+        return;
     }
+
+    va_list args;
+    va_start(args, format);
+    va_list args_copy;
+    va_copy(args_copy, args);
+    const int body = vsnprintf(arena + header, kArenaSize - header, format, args);
+    va_end(args);
+
+    if (body > 0) {
+        if (size_t(header) + size_t(body) < kArenaSize) {
+            EmitDebugLine(arena, size_t(header) + size_t(body));
+        } else {
+            // Too long for the arena: format it again on the heap
+            std::string message = FormatStringArgs(format, args_copy);
+            std::string formatted = std::string(arena, header) + message;
+            EmitDebugLine(formatted.c_str(), formatted.size());
+        }
+    }
+    va_end(args_copy);
 }
 
 void LogInfo(const char* feature, const char* message)
@@ -163,8 +346,7 @@ void SetLogPrefix(const char* prefix)
     if (!prefix || !*prefix) {
         return;
     }
-    std::lock_guard<std::mutex> lock(configMutex);
-    logPrefix = prefix;
+    logPrefix.store(new std::string(prefix), std::memory_order_release);
 }
 
 void SetDebugLoggingPredicate(std::function<bool()> predicate)
@@ -173,8 +355,18 @@ void SetDebugLoggingPredicate(std::function<bool()> predicate)
     debugPredicate = std::move(predicate);
 }
 
+void SetDebugLoggingEnabled(bool enabled)
+{
+    debugGate.store(enabled ? GateOn : GateOff, std::memory_order_relaxed);
+}
+
 bool IsDebugLoggingEnabled()
 {
+    const int gate = debugGate.load(std::memory_order_relaxed);
+    if (gate != GateUnset) {
+        return gate == GateOn;
+    }
+
     // Copy the predicate out before calling it, so it is never invoked with the
     // config lock held: the main plugin's predicate reads SettingsManager,
     // which takes locks of its own.
@@ -188,5 +380,45 @@ bool IsDebugLoggingEnabled()
     return predicate ? predicate() : false;
 }
 
+void StartAsyncLogging()
+{
+    std::lock_guard<std::mutex> lock(drainMutex);
+    if (drainThread.joinable()) {
+        return;
+    }
+    drainStopping.store(false, std::memory_order_release);
+    drainThread = std::thread(DrainLoop);
+    asyncActive.store(true, std::memory_order_release);
+}
+
+void StopAsyncLogging()
+{
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        if (!drainThread.joinable()) {
+            return;
+        }
+        asyncActive.store(false, std::memory_order_seq_cst);
+        thread.swap(drainThread);
+    }
+
+    // A caller that saw async output still on may be mid-push; let it finish
+    // so its line is in the ring before the final drain.
+    // seq_cst pairs with EmitDebugLine; see there.
+    while (producersInFlight.load(std::memory_order_seq_cst) > 0) {
+        std::this_thread::yield();
+    }
+
+    drainStopping.store(true, std::memory_order_release);
+    drainWake.notify_one();
+    thread.join();
+}
+
+uint64_t GetDroppedDebugLineCount()
+{
+    return droppedTotal.load(std::memory_order_relaxed);
+}
+
 } // namespace DebugLogger
 } // namespace StreamUP
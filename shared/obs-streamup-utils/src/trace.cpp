@@ -0,0 +1,244 @@
+#include <streamup/trace.hpp>
+#include <util/platform.h>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace StreamUP {
+namespace Trace {
+
+#ifdef STREAMUP_ENABLE_TRACING
+
+// Enough for a few minutes of per-frame spans on the graphics thread
+static constexpr size_t kEventsPerThread = 16384;
+
+// Buffers of threads that have exited are kept so their spans still export,
+// up to this many; after that the oldest are dropped.
+static constexpr size_t kMaxRetiredBuffers = 32;
+
+struct Event {
+    const char* name;
+    int64_t beginNs;
+    int64_t endNs;
+};
+
+// Only its own thread writes a buffer, so the lock is uncontended except
+// while an export copies it out.
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<Event> events;
+    size_t next = 0;
+    bool wrapped = false;
+    bool retired = false;
+    uint32_t tid = 0;
+    std::string threadName;
+};
+
+static std::mutex registryMutex;
+static std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+static uint32_t nextTid = 1;
+
+// Timestamps are exported relative to the first span, keeping them small
+static const int64_t traceEpochNs = NowNs();
+
+struct ThreadHandle {
+    std::shared_ptr<ThreadBuffer> buffer;
+
+    ~ThreadHandle()
+    {
+        if (buffer) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            buffer->retired = true;
+        }
+    }
+};
+
+static thread_local ThreadHandle threadHandle;
+
+static void PruneRetiredLocked()
+{
+    size_t retired = 0;
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        retired += buffer->retired ? 1 : 0;
+    }
+    for (auto it = buffers.begin(); it != buffers.end() && retired > kMaxRetiredBuffers;) {
+        bool isRetired;
+        {
+            std::lock_guard<std::mutex> lock((*it)->mutex);
+            isRetired = (*it)->retired;
+        }
+        if (isRetired) {
+            it = buffers.erase(it);
+            --retired;
+        } else {
+            ++it;
+        }
+    }
+}
+
+static ThreadBuffer& LocalBuffer()
+{
+    if (!threadHandle.buffer) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        buffer->events.resize(kEventsPerThread);
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->tid = nextTid++;
+        PruneRetiredLocked();
+        buffers.push_back(buffer);
+        threadHandle.buffer = std::move(buffer);
+    }
+    return *threadHandle.buffer;
+}
+
+void Record(const char* name, int64_t beginNs, int64_t endNs)
+{
+    ThreadBuffer& buffer = LocalBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events[buffer.next] = {name, beginNs, endNs};
+    if (++buffer.next == kEventsPerThread) {
+        buffer.next = 0;
+        buffer.wrapped = true;
+    }
+}
+
+bool IsCompiledIn()
+{
+    return true;
+}
+
+void SetThreadName(const char* name)
+{
+    ThreadBuffer& buffer = LocalBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = name ? name : "";
+}
+
+static void AppendEscaped(std::string& out, const char* text)
+{
+    for (const char* c = text; c && *c; ++c) {
+        switch (*c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(*c) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+                out += escaped;
+            } else {
+                out += *c;
+            }
+        }
+    }
+}
+
+std::string ExportChromeJson()
+{
+    struct Snapshot {
+        uint32_t tid;
+        std::string threadName;
+        std::vector<Event> events;
+    };
+
+    // Copy each buffer out under its own lock, oldest span first, then format
+    // without holding anything
+    std::vector<Snapshot> snapshots;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        snapshots.reserve(buffers.size());
+        for (const auto& buffer : buffers) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            Snapshot snapshot;
+            snapshot.tid = buffer->tid;
+            snapshot.threadName = buffer->threadName;
+            if (buffer->wrapped) {
+                snapshot.events.assign(buffer->events.begin() + buffer->next, buffer->events.end());
+            }
+            snapshot.events.insert(snapshot.events.end(), buffer->events.begin(),
+                                   buffer->events.begin() + buffer->next);
+            snapshots.push_back(std::move(snapshot));
+        }
+    }
+
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    char line[160];
+    for (const Snapshot& snapshot : snapshots) {
+        if (!snapshot.threadName.empty()) {
+            json += first ? "" : ",";
+            first = false;
+            snprintf(line, sizeof(line), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+                     snapshot.tid);
+            json += line;
+            AppendEscaped(json, snapshot.threadName.c_str());
+            json += "\"}}";
+        }
+        for (const Event& event : snapshot.events) {
+            json += first ? "" : ",";
+            first = false;
+            json += "{\"name\":\"";
+            AppendEscaped(json, event.name);
+            snprintf(line, sizeof(line), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", snapshot.tid,
+                     double(event.beginNs - traceEpochNs) / 1000.0, double(event.endNs - event.beginNs) / 1000.0);
+            json += line;
+        }
+    }
+    json += "]}";
+    return json;
+}
+
+void Clear()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->next = 0;
+        buffer->wrapped = false;
+    }
+}
+
+#else
+
+void Record(const char* name, int64_t beginNs, int64_t endNs)
+{
+    (void)name;
+    (void)beginNs;
+    (void)endNs;
+}
+
+bool IsCompiledIn()
+{
+    return false;
+}
+
+void SetThreadName(const char* name)
+{
+    (void)name;
+}
+
+std::string ExportChromeJson()
+{
+    return std::string();
+}
+
+void Clear() {}
+
+#endif
+
+bool WriteChromeJson(const std::string& path)
+{
+    if (!IsCompiledIn() || path.empty()) {
+        return false;
+    }
+    const std::string json = ExportChromeJson();
+    return os_quick_write_utf8_file_safe(path.c_str(), json.c_str(), json.size(), false, "tmp", nullptr);
+}
+
+} // namespace Trace
+} // namespace StreamUP
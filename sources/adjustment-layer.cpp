@@ -1,5 +1,6 @@
 #include "adjustment-layer.hpp"
 #include "version.h"
+#include <streamup/trace.hpp>
 
 #include <obs.h>
 #include <obs-module.h>
@@ -966,6 +967,7 @@ static uint32_t GetHeight(void *data)
 static void VideoTick(void *data, float seconds)
 {
 	UNUSED_PARAMETER(seconds);
+	STREAMUP_TRACE_SCOPE("AdjustmentLayer::VideoTick");
 	auto *d = static_cast<AdjustmentLayerData *>(data);
 
 	// Skip all work when the source isn't visible in any output
@@ -1056,6 +1058,7 @@ static void VideoTick(void *data, float seconds)
 static void VideoRender(void *data, gs_effect_t *effect)
 {
 	UNUSED_PARAMETER(effect);
+	STREAMUP_TRACE_SCOPE("AdjustmentLayer::VideoRender");
 	auto *d = static_cast<AdjustmentLayerData *>(data);
 
 	if (d->canvas_width == 0 || d->canvas_height == 0)
@@ -8,17 +8,27 @@
 #include "core/plugin-state.hpp"
 #include "core/plugin-manager.hpp"
 #include "core/source-manager.hpp"
+#include "core/source-state-tracker.hpp"
+#include "core/scene-item-cache.hpp"
+#include "core/backup-estimator.hpp"
 #include "core/backup-manager.hpp"
+#include "core/backup-jobs.hpp"
 #include "core/restore-manager.hpp"
+#include "core/stream-health.hpp"
 #include "ui/restore-dialog.hpp"
 #include "integrations/websocket-api.hpp"
+#include "integrations/metrics-events.hpp"
+#include "integrations/request-stats.hpp"
 #include "utilities/path-utils.hpp"
 #include <streamup/debug-logger.hpp>
+#include <streamup/trace.hpp>
 
 // UI modules
 #include "ui/dock/streamup-dock.hpp"
 #include "ui/scene-organiser/scene-organiser-dock.hpp"
 #include "ui/scene-organiser/scene-canvas.hpp"
+#include "ui/scene-organiser/scene-config-writer.hpp"
+#include "ui/icon-cache.hpp"
 #include "ui/streamup-toolbar.hpp"
 #include "ui/settings-manager.hpp"
 #include "ui/ui-helpers.hpp"
@@ -395,24 +405,31 @@ static void StreamUpOnItemSelect(void *, calldata_t *)
 
 // Emits vendor event "SourceStateChanged" carrying the aggregate lock state
 // (current scene + all scenes) and the selected source's visibility, so a
-// Stream Deck key can stay in sync when a source is (un)locked or shown/hidden
-// directly in OBS. Fires on the current scene's item_locked / item_visible.
-static void StreamUpEmitSourceStateChanged()
+// Stream Deck key can stay in sync when a source is (un)locked, selected or
+// shown/hidden directly in OBS. The state tracker keeps these as running
+// counts and calls this from the graphics thread, at most once a frame and
+// only when something in it changed.
+static void StreamUpEmitSourceStateChanged(const StreamUP::SourceManager::StateTracker::State &state)
 {
 	if (!vendor)
 		return;
 	obs_data_t *d = obs_data_create();
-	obs_data_set_bool(d, "allLocked", StreamUP::SourceManager::AreAllSourcesLockedInAllScenes());
-	obs_data_set_bool(d, "currentSceneLocked", StreamUP::SourceManager::AreAllSourcesLockedInCurrentScene());
-	obs_data_set_bool(d, "selectedVisible", StreamUP::SourceManager::CheckIfAnySelectedVisible());
-	obs_data_set_int(d, "selectionCount", StreamUP::SourceManager::GetSelectedSourceCount());
+	obs_data_set_bool(d, "allLocked", state.allLocked);
+	obs_data_set_bool(d, "currentSceneLocked", state.currentSceneLocked);
+	obs_data_set_bool(d, "selectedVisible", state.selectedVisible);
+	obs_data_set_int(d, "selectionCount", state.selectionCount);
 	obs_websocket_vendor_emit_event(vendor, "SourceStateChanged", d);
 	obs_data_release(d);
 }
 
-static void StreamUpOnItemState(void *, calldata_t *)
+static void StreamUpEmitBackupProgress(const StreamUP::Backup::Jobs::Status &status)
 {
-	StreamUpEmitSourceStateChanged();
+	if (!vendor)
+		return;
+	obs_data_t *d = obs_data_create();
+	StreamUP::WebSocketAPI::SetBackupJobFields(d, status);
+	obs_websocket_vendor_emit_event(vendor, "BackupProgress", d);
+	obs_data_release(d);
 }
 
 static void StreamUpUnhookSelectionScene()
@@ -423,8 +440,6 @@ static void StreamUpUnhookSelectionScene()
 	signal_handler_t *osh = obs_source_get_signal_handler(g_streamup_sel_scene);
 	signal_handler_disconnect(osh, "item_select", StreamUpOnItemSelect, nullptr);
 	signal_handler_disconnect(osh, "item_deselect", StreamUpOnItemSelect, nullptr);
-	signal_handler_disconnect(osh, "item_locked", StreamUpOnItemState, nullptr);
-	signal_handler_disconnect(osh, "item_visible", StreamUpOnItemState, nullptr);
 	obs_source_release(g_streamup_sel_scene);
 	g_streamup_sel_scene = nullptr;
 }
@@ -445,10 +460,9 @@ static void StreamUpHookSelectionScene()
 		signal_handler_t *sh = obs_source_get_signal_handler(scene);
 		signal_handler_connect(sh, "item_select", StreamUpOnItemSelect, nullptr);
 		signal_handler_connect(sh, "item_deselect", StreamUpOnItemSelect, nullptr);
-		signal_handler_connect(sh, "item_locked", StreamUpOnItemState, nullptr);
-		signal_handler_connect(sh, "item_visible", StreamUpOnItemState, nullptr);
 		g_streamup_sel_scene = scene;
 	}
+	StreamUP::SourceManager::StateTracker::SetCurrentScene(scene);
 }
 
 static void StreamUpSelectionFrontendEvent(enum obs_frontend_event event, void *)
@@ -458,17 +472,21 @@ static void StreamUpSelectionFrontendEvent(enum obs_frontend_event event, void *
 		// Drop the reference before OBS clears the old collection's scenes.
 		g_streamup_sel_collection_changing = true;
 		StreamUpUnhookSelectionScene();
+		StreamUP::SourceManager::StateTracker::SetCurrentScene(nullptr);
+		StreamUP::SourceManager::StateTracker::SetCollectionChanging(true);
 		break;
 	case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED:
 		g_streamup_sel_collection_changing = false;
+		// Recounts the new collection, which reports its state
+		StreamUP::SourceManager::StateTracker::SetCollectionChanging(false);
 		StreamUpHookSelectionScene();
 		StreamUpEmitSelectionChanged();
-		StreamUpEmitSourceStateChanged();
 		break;
 	case OBS_FRONTEND_EVENT_EXIT:
 		// Same again for shutdown: OBS clears scene data on the way out.
 		g_streamup_sel_collection_changing = true;
 		StreamUpUnhookSelectionScene();
+		StreamUP::SourceManager::StateTracker::Stop();
 		break;
 	case OBS_FRONTEND_EVENT_FINISHED_LOADING: // initial hook once OBS is up
 	case OBS_FRONTEND_EVENT_SCENE_CHANGED:     // re-hook + report on scene switch
@@ -476,9 +494,11 @@ static void StreamUpSelectionFrontendEvent(enum obs_frontend_event event, void *
 		// that are still being built. Ignore those; CHANGED does the re-hook.
 		if (g_streamup_sel_collection_changing)
 			break;
+		// Hooks and counts every scene the first time; a no-op after that.
+		// A scene switch changes the current-scene fields, which it reports.
+		StreamUP::SourceManager::StateTracker::Start(StreamUpEmitSourceStateChanged);
 		StreamUpHookSelectionScene();
 		StreamUpEmitSelectionChanged();
-		StreamUpEmitSourceStateChanged();
 		break;
 	default:
 		break;
@@ -489,6 +509,7 @@ static void StreamUpSelectionCleanup()
 {
 	obs_frontend_remove_event_callback(StreamUpSelectionFrontendEvent, nullptr);
 	StreamUpUnhookSelectionScene();
+	StreamUP::SourceManager::StateTracker::Stop();
 }
 
 void SettingsDialog()
@@ -498,6 +519,15 @@ void SettingsDialog()
 }
 
 //--------------------WEBSOCKET REGISTRATION--------------------
+// Register with obs-websocket, counted and timed for GetVendorStats, and make
+// the request available inside Batch
+static void RegisterVendorRequest(const char *request_type, obs_websocket_request_callback_function callback)
+{
+	void *record = StreamUP::RequestStats::Instrument(request_type, callback);
+	obs_websocket_vendor_register_request(vendor, request_type, StreamUP::RequestStats::Dispatch, record);
+	StreamUP::WebSocketAPI::AddBatchRequest(request_type, StreamUP::RequestStats::Dispatch, record);
+}
+
 static void RegisterWebsocketRequests()
 {
 	blog(LOG_INFO, "[StreamUP] RegisterWebsocketRequests: Starting WebSocket vendor registration");
@@ -510,88 +540,102 @@ static void RegisterWebsocketRequests()
 
 	// Register new properly named commands (PascalCase following OBS WebSocket conventions)
 	// Utility commands
-	obs_websocket_vendor_register_request(vendor, "GetStreamBitrate", StreamUP::WebSocketAPI::WebsocketRequestBitrate, nullptr);
-	obs_websocket_vendor_register_request(vendor, "GetPluginVersion", StreamUP::WebSocketAPI::WebsocketRequestVersion, nullptr);
+	RegisterVendorRequest("GetStreamBitrate", StreamUP::WebSocketAPI::WebsocketRequestBitrate);
+	RegisterVendorRequest("GetPluginVersion", StreamUP::WebSocketAPI::WebsocketRequestVersion);
 	
 	// Plugin management
-	obs_websocket_vendor_register_request(vendor, "CheckRequiredPlugins", StreamUP::WebSocketAPI::WebsocketRequestCheckPlugins, nullptr);
+	RegisterVendorRequest("CheckRequiredPlugins", StreamUP::WebSocketAPI::WebsocketRequestCheckPlugins);
 	
 	// Source management
-	obs_websocket_vendor_register_request(vendor, "ToggleLockAllSources", StreamUP::WebSocketAPI::WebsocketRequestLockAllSources, nullptr);
-	obs_websocket_vendor_register_request(vendor, "ToggleLockCurrentSceneSources", StreamUP::WebSocketAPI::WebsocketRequestLockCurrentSources, nullptr);
-	obs_websocket_vendor_register_request(vendor, "GetAllSourcesLocked", StreamUP::WebSocketAPI::WebsocketRequestGetAllSourcesLocked, nullptr);
-	obs_websocket_vendor_register_request(vendor, "GetCurrentSceneSourcesLocked", StreamUP::WebSocketAPI::WebsocketRequestGetCurrentSceneSourcesLocked, nullptr);
-	obs_websocket_vendor_register_request(vendor, "GetSelectedVisibility", StreamUP::WebSocketAPI::WebsocketRequestGetSelectedVisibility, nullptr);
-	obs_websocket_vendor_register_request(vendor, "RefreshAudioMonitoring", StreamUP::WebSocketAPI::WebsocketRequestRefreshAudioMonitoring, nullptr);
-	obs_websocket_vendor_register_request(vendor, "RefreshBrowserSources", StreamUP::WebSocketAPI::WebsocketRequestRefreshBrowserSources, nullptr);
-	obs_websocket_vendor_register_request(vendor, "GetSelectedSource", StreamUP::WebSocketAPI::WebsocketRequestGetCurrentSelectedSource, nullptr);
+	RegisterVendorRequest("ToggleLockAllSources", StreamUP::WebSocketAPI::WebsocketRequestLockAllSources);
+	RegisterVendorRequest("ToggleLockCurrentSceneSources", StreamUP::WebSocketAPI::WebsocketRequestLockCurrentSources);
+	RegisterVendorRequest("GetAllSourcesLocked", StreamUP::WebSocketAPI::WebsocketRequestGetAllSourcesLocked);
+	RegisterVendorRequest("GetCurrentSceneSourcesLocked", StreamUP::WebSocketAPI::WebsocketRequestGetCurrentSceneSourcesLocked);
+	RegisterVendorRequest("GetSelectedVisibility", StreamUP::WebSocketAPI::WebsocketRequestGetSelectedVisibility);
+	RegisterVendorRequest("RefreshAudioMonitoring", StreamUP::WebSocketAPI::WebsocketRequestRefreshAudioMonitoring);
+	RegisterVendorRequest("RefreshBrowserSources", StreamUP::WebSocketAPI::WebsocketRequestRefreshBrowserSources);
+	RegisterVendorRequest("GetSelectedSource", StreamUP::WebSocketAPI::WebsocketRequestGetCurrentSelectedSource);
 	
 	// Transition management
-	obs_websocket_vendor_register_request(vendor, "GetShowTransition", StreamUP::WebSocketAPI::WebsocketRequestGetShowTransition, nullptr);
-	obs_websocket_vendor_register_request(vendor, "GetHideTransition", StreamUP::WebSocketAPI::WebsocketRequestGetHideTransition, nullptr);
-	obs_websocket_vendor_register_request(vendor, "SetShowTransition", StreamUP::WebSocketAPI::WebsocketRequestSetShowTransition, nullptr);
-	obs_websocket_vendor_register_request(vendor, "SetHideTransition", StreamUP::WebSocketAPI::WebsocketRequestSetHideTransition, nullptr);
+	RegisterVendorRequest("GetShowTransition", StreamUP::WebSocketAPI::WebsocketRequestGetShowTransition);
+	RegisterVendorRequest("GetHideTransition", StreamUP::WebSocketAPI::WebsocketRequestGetHideTransition);
+	RegisterVendorRequest("SetShowTransition", StreamUP::WebSocketAPI::WebsocketRequestSetShowTransition);
+	RegisterVendorRequest("SetHideTransition", StreamUP::WebSocketAPI::WebsocketRequestSetHideTransition);
 	
 	// File and output management
-	obs_websocket_vendor_register_request(vendor, "GetRecordingOutputPath", StreamUP::WebSocketAPI::WebsocketRequestGetOutputFilePath, nullptr);
-	obs_websocket_vendor_register_request(vendor, "GetVLCCurrentFile", StreamUP::WebSocketAPI::WebsocketRequestVLCGetCurrentFile, nullptr);
-	obs_websocket_vendor_register_request(vendor, "LoadStreamUpFile", StreamUP::WebSocketAPI::WebsocketLoadStreamupFile, nullptr);
+	RegisterVendorRequest("GetRecordingOutputPath", StreamUP::WebSocketAPI::WebsocketRequestGetOutputFilePath);
+	RegisterVendorRequest("GetVLCCurrentFile", StreamUP::WebSocketAPI::WebsocketRequestVLCGetCurrentFile);
+	RegisterVendorRequest("LoadStreamUpFile", StreamUP::WebSocketAPI::WebsocketLoadStreamupFile);
 	
 	// Backup
-	obs_websocket_vendor_register_request(vendor, "CreateBackup", StreamUP::WebSocketAPI::WebsocketRequestCreateBackup, nullptr);
-	obs_websocket_vendor_register_request(vendor, "GetBackupInfo", StreamUP::WebSocketAPI::WebsocketRequestGetBackupInfo, nullptr);
+	RegisterVendorRequest("CreateBackup", StreamUP::WebSocketAPI::WebsocketRequestCreateBackup);
+	RegisterVendorRequest("GetBackupInfo", StreamUP::WebSocketAPI::WebsocketRequestGetBackupInfo);
+	RegisterVendorRequest("GetBackupJob", StreamUP::WebSocketAPI::WebsocketRequestGetBackupJob);
+	RegisterVendorRequest("CancelBackupJob", StreamUP::WebSocketAPI::WebsocketRequestCancelBackupJob);
+
+	// Diagnostics
+	RegisterVendorRequest("GetStreamHealth", StreamUP::WebSocketAPI::WebsocketRequestGetStreamHealth);
+	RegisterVendorRequest("SubscribeMetrics", StreamUP::WebSocketAPI::WebsocketRequestSubscribeMetrics);
+	RegisterVendorRequest("UnsubscribeMetrics", StreamUP::WebSocketAPI::WebsocketRequestUnsubscribeMetrics);
+	RegisterVendorRequest("ExportTrace", StreamUP::WebSocketAPI::WebsocketRequestExportTrace);
+	RegisterVendorRequest("GetVendorStats", StreamUP::WebSocketAPI::WebsocketRequestGetVendorStats);
+	RegisterVendorRequest("ResetVendorStats", StreamUP::WebSocketAPI::WebsocketRequestResetVendorStats);
 
 	// Source properties
-	obs_websocket_vendor_register_request(vendor, "GetBlendingMethod", StreamUP::WebSocketAPI::WebsocketRequestGetBlendingMethod, nullptr);
-	obs_websocket_vendor_register_request(vendor, "SetBlendingMethod", StreamUP::WebSocketAPI::WebsocketRequestSetBlendingMethod, nullptr);
-	obs_websocket_vendor_register_request(vendor, "GetDeinterlacing", StreamUP::WebSocketAPI::WebsocketRequestGetDeinterlacing, nullptr);
-	obs_websocket_vendor_register_request(vendor, "SetDeinterlacing", StreamUP::WebSocketAPI::WebsocketRequestSetDeinterlacing, nullptr);
-	obs_websocket_vendor_register_request(vendor, "GetScaleFiltering", StreamUP::WebSocketAPI::WebsocketRequestGetScaleFiltering, nullptr);
-	obs_websocket_vendor_register_request(vendor, "SetScaleFiltering", StreamUP::WebSocketAPI::WebsocketRequestSetScaleFiltering, nullptr);
-	obs_websocket_vendor_register_request(vendor, "GetDownmixMono", StreamUP::WebSocketAPI::WebsocketRequestGetDownmixMono, nullptr);
-	obs_websocket_vendor_register_request(vendor, "SetDownmixMono", StreamUP::WebSocketAPI::WebsocketRequestSetDownmixMono, nullptr);
+	RegisterVendorRequest("GetBlendingMethod", StreamUP::WebSocketAPI::WebsocketRequestGetBlendingMethod);
+	RegisterVendorRequest("SetBlendingMethod", StreamUP::WebSocketAPI::WebsocketRequestSetBlendingMethod);
+	RegisterVendorRequest("GetDeinterlacing", StreamUP::WebSocketAPI::WebsocketRequestGetDeinterlacing);
+	RegisterVendorRequest("SetDeinterlacing", StreamUP::WebSocketAPI::WebsocketRequestSetDeinterlacing);
+	RegisterVendorRequest("GetScaleFiltering", StreamUP::WebSocketAPI::WebsocketRequestGetScaleFiltering);
+	RegisterVendorRequest("SetScaleFiltering", StreamUP::WebSocketAPI::WebsocketRequestSetScaleFiltering);
+	RegisterVendorRequest("GetDownmixMono", StreamUP::WebSocketAPI::WebsocketRequestGetDownmixMono);
+	RegisterVendorRequest("SetDownmixMono", StreamUP::WebSocketAPI::WebsocketRequestSetDownmixMono);
 	
 	// UI interaction
-	obs_websocket_vendor_register_request(vendor, "OpenSourceProperties", StreamUP::WebSocketAPI::WebsocketOpenSourceProperties, nullptr);
-	obs_websocket_vendor_register_request(vendor, "OpenSourceFilters", StreamUP::WebSocketAPI::WebsocketOpenSourceFilters, nullptr);
-	obs_websocket_vendor_register_request(vendor, "OpenSourceInteraction", StreamUP::WebSocketAPI::WebsocketOpenSourceInteract, nullptr);
-	obs_websocket_vendor_register_request(vendor, "OpenSceneFilters", StreamUP::WebSocketAPI::WebsocketOpenSceneFilters, nullptr);
+	RegisterVendorRequest("OpenSourceProperties", StreamUP::WebSocketAPI::WebsocketOpenSourceProperties);
+	RegisterVendorRequest("OpenSourceFilters", StreamUP::WebSocketAPI::WebsocketOpenSourceFilters);
+	RegisterVendorRequest("OpenSourceInteraction", StreamUP::WebSocketAPI::WebsocketOpenSourceInteract);
+	RegisterVendorRequest("OpenSceneFilters", StreamUP::WebSocketAPI::WebsocketOpenSceneFilters);
 	
 	// Video capture device management
-	obs_websocket_vendor_register_request(vendor, "ActivateAllVideoCaptureDevices", StreamUP::WebSocketAPI::WebsocketActivateAllVideoCaptureDevices, nullptr);
-	obs_websocket_vendor_register_request(vendor, "DeactivateAllVideoCaptureDevices", StreamUP::WebSocketAPI::WebsocketDeactivateAllVideoCaptureDevices, nullptr);
-	obs_websocket_vendor_register_request(vendor, "RefreshAllVideoCaptureDevices", StreamUP::WebSocketAPI::WebsocketRefreshAllVideoCaptureDevices, nullptr);
+	RegisterVendorRequest("ActivateAllVideoCaptureDevices", StreamUP::WebSocketAPI::WebsocketActivateAllVideoCaptureDevices);
+	RegisterVendorRequest("DeactivateAllVideoCaptureDevices", StreamUP::WebSocketAPI::WebsocketDeactivateAllVideoCaptureDevices);
+	RegisterVendorRequest("RefreshAllVideoCaptureDevices", StreamUP::WebSocketAPI::WebsocketRefreshAllVideoCaptureDevices);
 
 	// Transition copy/paste
-	obs_websocket_vendor_register_request(vendor, "CopyShowTransition", StreamUP::WebSocketAPI::WebsocketCopyShowTransition, nullptr);
-	obs_websocket_vendor_register_request(vendor, "CopyHideTransition", StreamUP::WebSocketAPI::WebsocketCopyHideTransition, nullptr);
-	obs_websocket_vendor_register_request(vendor, "PasteShowTransition", StreamUP::WebSocketAPI::WebsocketPasteShowTransition, nullptr);
-	obs_websocket_vendor_register_request(vendor, "PasteHideTransition", StreamUP::WebSocketAPI::WebsocketPasteHideTransition, nullptr);
+	RegisterVendorRequest("CopyShowTransition", StreamUP::WebSocketAPI::WebsocketCopyShowTransition);
+	RegisterVendorRequest("CopyHideTransition", StreamUP::WebSocketAPI::WebsocketCopyHideTransition);
+	RegisterVendorRequest("PasteShowTransition", StreamUP::WebSocketAPI::WebsocketPasteShowTransition);
+	RegisterVendorRequest("PasteHideTransition", StreamUP::WebSocketAPI::WebsocketPasteHideTransition);
 
 	// Group and visibility management
-	obs_websocket_vendor_register_request(vendor, "GroupSelectedSources", StreamUP::WebSocketAPI::WebsocketGroupSelectedSources, nullptr);
-	obs_websocket_vendor_register_request(vendor, "ToggleVisibilitySelectedSources", StreamUP::WebSocketAPI::WebsocketToggleVisibilitySelectedSources, nullptr);
+	RegisterVendorRequest("GroupSelectedSources", StreamUP::WebSocketAPI::WebsocketGroupSelectedSources);
+	RegisterVendorRequest("ToggleVisibilitySelectedSources", StreamUP::WebSocketAPI::WebsocketToggleVisibilitySelectedSources);
 
 	// Backward compatibility - register old command names (deprecated)
-	obs_websocket_vendor_register_request(vendor, "getOutputFilePath", StreamUP::WebSocketAPI::WebsocketRequestGetOutputFilePath, nullptr);
-	obs_websocket_vendor_register_request(vendor, "getCurrentSource", StreamUP::WebSocketAPI::WebsocketRequestGetCurrentSelectedSource, nullptr);
-	obs_websocket_vendor_register_request(vendor, "getShowTransition", StreamUP::WebSocketAPI::WebsocketRequestGetShowTransition, nullptr);
-	obs_websocket_vendor_register_request(vendor, "getHideTransition", StreamUP::WebSocketAPI::WebsocketRequestGetHideTransition, nullptr);
-	obs_websocket_vendor_register_request(vendor, "setShowTransition", StreamUP::WebSocketAPI::WebsocketRequestSetShowTransition, nullptr);
-	obs_websocket_vendor_register_request(vendor, "setHideTransition", StreamUP::WebSocketAPI::WebsocketRequestSetHideTransition, nullptr);
-	obs_websocket_vendor_register_request(vendor, "toggleLockCurrentSources", StreamUP::WebSocketAPI::WebsocketRequestLockCurrentSources, nullptr);
-	obs_websocket_vendor_register_request(vendor, "toggleLockAllSources", StreamUP::WebSocketAPI::WebsocketRequestLockAllSources, nullptr);
-	obs_websocket_vendor_register_request(vendor, "getBitrate", StreamUP::WebSocketAPI::WebsocketRequestBitrate, nullptr);
-	obs_websocket_vendor_register_request(vendor, "version", StreamUP::WebSocketAPI::WebsocketRequestVersion, nullptr);
-	obs_websocket_vendor_register_request(vendor, "check_plugins", StreamUP::WebSocketAPI::WebsocketRequestCheckPlugins, nullptr);
-	obs_websocket_vendor_register_request(vendor, "refresh_audio_monitoring", StreamUP::WebSocketAPI::WebsocketRequestRefreshAudioMonitoring, nullptr);
-	obs_websocket_vendor_register_request(vendor, "refresh_browser_sources", StreamUP::WebSocketAPI::WebsocketRequestRefreshBrowserSources, nullptr);
-	obs_websocket_vendor_register_request(vendor, "vlcGetCurrentFile", StreamUP::WebSocketAPI::WebsocketRequestVLCGetCurrentFile, nullptr);
-	obs_websocket_vendor_register_request(vendor, "openSourceProperties", StreamUP::WebSocketAPI::WebsocketOpenSourceProperties, nullptr);
-	obs_websocket_vendor_register_request(vendor, "openSourceFilters", StreamUP::WebSocketAPI::WebsocketOpenSourceFilters, nullptr);
-	obs_websocket_vendor_register_request(vendor, "openSourceInteract", StreamUP::WebSocketAPI::WebsocketOpenSourceInteract, nullptr);
-	obs_websocket_vendor_register_request(vendor, "openSceneFilters", StreamUP::WebSocketAPI::WebsocketOpenSceneFilters, nullptr);
-	obs_websocket_vendor_register_request(vendor, "loadStreamupFile", StreamUP::WebSocketAPI::WebsocketLoadStreamupFile, nullptr);
+	RegisterVendorRequest("getOutputFilePath", StreamUP::WebSocketAPI::WebsocketRequestGetOutputFilePath);
+	RegisterVendorRequest("getCurrentSource", StreamUP::WebSocketAPI::WebsocketRequestGetCurrentSelectedSource);
+	RegisterVendorRequest("getShowTransition", StreamUP::WebSocketAPI::WebsocketRequestGetShowTransition);
+	RegisterVendorRequest("getHideTransition", StreamUP::WebSocketAPI::WebsocketRequestGetHideTransition);
+	RegisterVendorRequest("setShowTransition", StreamUP::WebSocketAPI::WebsocketRequestSetShowTransition);
+	RegisterVendorRequest("setHideTransition", StreamUP::WebSocketAPI::WebsocketRequestSetHideTransition);
+	RegisterVendorRequest("toggleLockCurrentSources", StreamUP::WebSocketAPI::WebsocketRequestLockCurrentSources);
+	RegisterVendorRequest("toggleLockAllSources", StreamUP::WebSocketAPI::WebsocketRequestLockAllSources);
+	RegisterVendorRequest("getBitrate", StreamUP::WebSocketAPI::WebsocketRequestBitrate);
+	RegisterVendorRequest("version", StreamUP::WebSocketAPI::WebsocketRequestVersion);
+	RegisterVendorRequest("check_plugins", StreamUP::WebSocketAPI::WebsocketRequestCheckPlugins);
+	RegisterVendorRequest("refresh_audio_monitoring", StreamUP::WebSocketAPI::WebsocketRequestRefreshAudioMonitoring);
+	RegisterVendorRequest("refresh_browser_sources", StreamUP::WebSocketAPI::WebsocketRequestRefreshBrowserSources);
+	RegisterVendorRequest("vlcGetCurrentFile", StreamUP::WebSocketAPI::WebsocketRequestVLCGetCurrentFile);
+	RegisterVendorRequest("openSourceProperties", StreamUP::WebSocketAPI::WebsocketOpenSourceProperties);
+	RegisterVendorRequest("openSourceFilters", StreamUP::WebSocketAPI::WebsocketOpenSourceFilters);
+	RegisterVendorRequest("openSourceInteract", StreamUP::WebSocketAPI::WebsocketOpenSourceInteract);
+	RegisterVendorRequest("openSceneFilters", StreamUP::WebSocketAPI::WebsocketOpenSceneFilters);
+	RegisterVendorRequest("loadStreamupFile", StreamUP::WebSocketAPI::WebsocketLoadStreamupFile);
+
+	// Last, so every request it can run is already in its table
+	obs_websocket_vendor_register_request(vendor, "Batch", StreamUP::RequestStats::Dispatch,
+					      StreamUP::RequestStats::Instrument("Batch", StreamUP::WebSocketAPI::WebsocketRequestBatch));
 
 	blog(LOG_INFO, "[StreamUP] RegisterWebsocketRequests: All WebSocket requests registered successfully");
 }
@@ -993,6 +1037,9 @@ bool obs_module_load()
 	StreamUP::DebugLogger::SetDebugLoggingPredicate(
 		[]() { return StreamUP::SettingsManager::IsDebugLoggingEnabled(); });
 
+	// Module load runs on the UI thread; name it for exported traces
+	StreamUP::Trace::SetThreadName("OBS UI");
+
 	// Before anything else: finish or confirm a restore staged in a previous
 	// session. Module load happens before OBS reads scene collections
 	// (OBSBasic::OBSInit loads modules at line ~1056, scene collections at
@@ -1155,6 +1202,10 @@ bool obs_module_load()
 		// Mark initialization as complete - debug logging will now respect user settings
 		StreamUP::DebugLogger::SetInitializationComplete(true);
 
+		// From here debug lines go through the logger's queue instead of
+		// writing to the log file on the calling thread
+		StreamUP::DebugLogger::StartAsyncLogging();
+
 		return true;
 	} catch (const std::exception& e) {
 		blog(LOG_ERROR, "[StreamUP] Exception during module load: %s", e.what());
@@ -1200,6 +1251,33 @@ static void OnOBSShutdown(enum obs_frontend_event event, void *private_data)
 		// an access violation on shutdown. Cleanup is idempotent (it nulls the
 		// pointer), so the unload-time call becomes a safe no-op.
 		StreamUpSelectionCleanup();
+
+		// Cancel a websocket backup still writing, so its worker is not left
+		// reading files out from under the shutdown save.
+		StreamUP::Backup::Jobs::Stop();
+
+		// The estimator's watcher and worker are Qt-side; stop them while Qt is still up.
+		StreamUP::Backup::LiveEstimator::Stop();
+
+		// Stop sampling stream health before the outputs it reads go away
+		StreamUP::StreamHealth::Stop();
+
+		// Unhook the scenes the item cache watches while they all still exist
+		StreamUP::SourceManager::SceneItemCache::Stop();
+
+		// Nobody can be sent MetricsUpdated events once OBS is closing
+		StreamUP::MetricsEvents::Stop();
+
+		// Write out any Scene Organiser saves still queued and stop the writer
+		// thread; a dock saving after this, as it is destroyed, writes inline.
+		StreamUP::SceneOrganiser::ConfigWriter::Stop();
+
+		// Save whatever icons were rendered this session for the next launch
+		StreamUP::IconCache::Stop();
+
+		// Write out a pending configs.json save and stop its writer; the
+		// settings saved during unload go straight to disk from here on.
+		StreamUP::SettingsManager::StopSettingsWriter();
 	}
 }
 
@@ -1260,6 +1338,27 @@ static void OnOBSFinishedLoading(enum obs_frontend_event event, void *private_da
 		// point that API is gone and nothing can be resolved from scratch.
 		StreamUP::Backup::ResolveLocations();
 
+		// Size up a backup in the background and keep it current from here
+		// on, so the backup dialog opens with its numbers already there.
+		StreamUP::Backup::LiveEstimator::Start();
+
+		// Load the rendered icon cache and fill in anything it is missing,
+		// both themes, in the background
+		StreamUP::IconCache::Start();
+
+		// Keep a few minutes of bitrate, frame and CPU history for the status
+		// tooltips and the GetStreamHealth request
+		StreamUP::StreamHealth::Start();
+
+		// Remember the scene items websocket requests find by name
+		StreamUP::SourceManager::SceneItemCache::Start();
+
+		// Serve MetricsUpdated subscriptions from the status readouts' sampler
+		StreamUP::MetricsEvents::Start(vendor);
+
+		// Take CreateBackup requests as background jobs from here on
+		StreamUP::Backup::Jobs::Start(StreamUpEmitBackupProgress);
+
 		// Apply style overrides to OBS native docks
 		ApplyOBSDockStyleOverrides();
 
@@ -1301,6 +1400,10 @@ static void OnOBSFinishedLoading(enum obs_frontend_event event, void *private_da
 			// This ensures cached data is available even if startup check is disabled
 			StreamUP::DebugLogger::LogDebug("Plugin", "Async Init", "Performing plugin check and cache");
 			StreamUP::PluginManager::PerformPluginCheckAndCache();
+
+			// Last session's automatic backup only got the cheap check on the
+			// way out; read every entry back now that nothing is waiting on it.
+			StreamUP::Backup::VerifyPendingAutomaticBackup();
 			
 			// Schedule startup UI to show on UI thread with delay
 			StreamUP::UIHelpers::ShowDialogOnUIThread([]() {
@@ -1400,6 +1503,9 @@ void obs_module_unload()
 	blog(LOG_INFO, "[StreamUP] Starting plugin unload process");
 	StreamUP::DebugLogger::LogDebug("Plugin", "Unload", "Starting plugin unload process");
 
+	// Write out queued debug lines so the unload steps log in order after them
+	StreamUP::DebugLogger::StopAsyncLogging();
+
 	// Reset initialization status during unload
 	StreamUP::DebugLogger::SetInitializationComplete(false);
 
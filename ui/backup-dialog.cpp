@@ -1,5 +1,6 @@
 #include "backup-dialog.hpp"
 
+#include "../core/backup-estimator.hpp"
 #include "../core/backup-manager.hpp"
 #include <streamup/debug-logger.hpp>
 #include "backup-ui-common.hpp"
@@ -209,15 +210,20 @@ void ShowCreateBackupDialog()
 	cardText(whatCard, obs_module_text("Backup.Includes.Excluded"), Colors::TEXT_SECONDARY, CardText::kCaption);
 
 	// ── What this will produce, measured now ───────────────────────────
+	// Normally instant: the live estimator has been keeping this current since
+	// OBS loaded. Measured the slow way only if it has not finished priming.
 	Options estimateOptions;
-	const Estimate estimate = EstimateBackup(estimateOptions);
 	const Locations loc = ResolveLocations();
-	const QList<MediaReference> media = ScanMediaReferences(loc);
-	int missingCount = 0;
-	for (const MediaReference &ref : media) {
-		if (!ref.exists)
-			missingCount++;
+	LiveEstimate live;
+	if (!LiveEstimator::Current(estimateOptions, live)) {
+		live.estimate = EstimateBackup(estimateOptions);
+		for (const MediaReference &ref : ScanMediaReferences(loc)) {
+			live.mediaReferenced++;
+			if (!ref.exists)
+				live.mediaMissing++;
+		}
 	}
+	const Estimate &estimate = live.estimate;
 
 	QVBoxLayout *sizeCard = sectionCard(layout, obs_module_text("Backup.Section.YourSetup"));
 	QGridLayout *grid = cardFacts(sizeCard);
@@ -226,13 +232,13 @@ void ShowCreateBackupDialog()
 	     QStringLiteral("%1  (%2)").arg(estimate.fileCount).arg(formatBytes(estimate.totalBytes)));
 	cardFact(grid, row++, obs_module_text("Backup.Fact.Mode"),
 	     loc.portable ? obs_module_text("Restore.Info.Portable") : obs_module_text("Restore.Info.Installed"));
-	if (!media.isEmpty())
+	if (live.mediaReferenced > 0)
 		cardFact(grid, row++, obs_module_text("Backup.Fact.Referenced"),
-		     missingCount > 0 ? QString(obs_module_text("Backup.Fact.ReferencedMissing"))
-						.arg(media.size())
-						.arg(missingCount)
-				      : QString::number(media.size()),
-		     missingCount > 0 ? Colors::COLOR_WARNING : Colors::TEXT_PRIMARY);
+		     live.mediaMissing > 0 ? QString(obs_module_text("Backup.Fact.ReferencedMissing"))
+						.arg(live.mediaReferenced)
+						.arg(live.mediaMissing)
+				      : QString::number(live.mediaReferenced),
+		     live.mediaMissing > 0 ? Colors::COLOR_WARNING : Colors::TEXT_PRIMARY);
 	if (estimate.largeFileCount > 0)
 		cardFact(grid, row++, obs_module_text("Backup.Fact.LargeSkipped"),
 		     QStringLiteral("%1  (%2)").arg(estimate.largeFileCount).arg(formatBytes(estimate.largeFileBytes)),
@@ -0,0 +1,444 @@
+#include "icon-cache.hpp"
+#include <streamup/debug-logger.hpp>
+#include <obs-module.h>
+#include <util/bmem.h>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDirIterator>
+#include <QFile>
+#include <QGuiApplication>
+#include <QHash>
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QSaveFile>
+#include <QScreen>
+#include <QSet>
+#include <QSvgRenderer>
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace StreamUP {
+namespace IconCache {
+
+namespace {
+
+constexpr quint32 kFileMagic = 0x53554943; // "SUIC"
+constexpr quint32 kFileVersion = 2; // 2: keys no longer carry a colour
+
+// Above this many images, ones nothing asked for this session are not saved
+constexpr int kMaxSavedImages = 2048;
+
+// Largest side accepted from the disk cache, in device pixels
+constexpr int kMaxImageSide = 512;
+
+// Toolbar icon sizes for the Small, Medium and Large tiers, matching
+// StreamUPToolbar::updateToolbarSize
+const QList<QSize> kPrefetchSizes = {QSize(12, 12), QSize(16, 16), QSize(22, 22)};
+
+struct CachedImage {
+	QImage image;
+	bool used = false; // asked for or prefetched this session
+};
+
+struct RenderJob {
+	QByteArray key;
+	QByteArray svg;
+	QSize size;
+	qreal ratio = 1.0;
+};
+
+std::mutex mutex;
+std::condition_variable wake;
+std::thread worker;
+QHash<QByteArray, CachedImage> images;
+std::deque<RenderJob> jobs;
+QSet<QByteArray> queuedKeys;
+QString cacheFile;
+QList<qreal> prefetchRatios;
+bool started = false;
+bool stopping = false;
+bool dirty = false;
+
+// What an icon was built for, less the screen ratios: those are the same for
+// every entry and dropping them all when a screen changes is simpler than
+// keying on them.
+struct IconKey {
+	QString path;
+	QSize size;
+
+	bool operator==(const IconKey &other) const { return path == other.path && size == other.size; }
+};
+
+size_t qHash(const IconKey &key, size_t seed = 0)
+{
+	return qHashMulti(seed, key.path, key.size.width(), key.size.height());
+}
+
+// UI thread only
+QHash<QString, QByteArray> resourceHashes;
+QHash<IconKey, QIcon> builtIcons;
+QList<qreal> knownRatios;
+QObject *screenWatcher = nullptr;
+
+QByteArray contentHash(const QByteArray &svg)
+{
+	return QCryptographicHash::hash(svg, QCryptographicHash::Sha1).toHex();
+}
+
+QByteArray imageKey(const QByteArray &hash, const QSize &size, qreal ratio)
+{
+	QByteArray key = hash;
+	key += '|';
+	key += QByteArray::number(size.width()) + 'x' + QByteArray::number(size.height());
+	key += '@';
+	key += QByteArray::number(ratio, 'f', 2);
+	return key;
+}
+
+QByteArray readSvg(const QString &path)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return QByteArray();
+	return file.readAll();
+}
+
+QList<qreal> screenRatios()
+{
+	QList<qreal> ratios;
+	for (QScreen *screen : QGuiApplication::screens()) {
+		const qreal ratio = screen->devicePixelRatio();
+		if (!ratios.contains(ratio))
+			ratios.append(ratio);
+	}
+	if (ratios.isEmpty())
+		ratios.append(1.0);
+	return ratios;
+}
+
+void forgetScreens()
+{
+	knownRatios.clear();
+	builtIcons.clear();
+}
+
+void watchScreen(QScreen *screen)
+{
+	QObject::connect(screen, &QScreen::logicalDotsPerInchChanged, screenWatcher, forgetScreens);
+	QObject::connect(screen, &QScreen::physicalDotsPerInchChanged, screenWatcher, forgetScreens);
+	QObject::connect(screen, &QScreen::geometryChanged, screenWatcher, forgetScreens);
+}
+
+// screenRatios(), worked out again only when a screen comes, goes or changes
+const QList<qreal> &currentRatios()
+{
+	if (!screenWatcher) {
+		screenWatcher = new QObject();
+		QObject::connect(qGuiApp, &QGuiApplication::screenAdded, screenWatcher, [](QScreen *screen) {
+			watchScreen(screen);
+			forgetScreens();
+		});
+		QObject::connect(qGuiApp, &QGuiApplication::screenRemoved, screenWatcher, forgetScreens);
+		for (QScreen *screen : QGuiApplication::screens())
+			watchScreen(screen);
+	}
+	if (knownRatios.isEmpty())
+		knownRatios = screenRatios();
+	return knownRatios;
+}
+
+// Safe off the UI thread: only QImage, QPainter on a QImage and QSvgRenderer
+QImage render(const QByteArray &svg, const QSize &size, qreal ratio)
+{
+	QSvgRenderer renderer(svg);
+	if (!renderer.isValid())
+		return QImage();
+
+	QImage image((QSizeF(size) * ratio).toSize(), QImage::Format_ARGB32_Premultiplied);
+	image.fill(Qt::transparent);
+
+	QPainter painter(&image);
+	painter.setRenderHint(QPainter::Antialiasing);
+	renderer.render(&painter);
+	painter.end();
+
+	image.setDevicePixelRatio(ratio);
+	return image;
+}
+
+void loadDiskCache(const QString &path)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+
+	QDataStream in(&file);
+	quint32 magic = 0, version = 0, count = 0;
+	in >> magic >> version >> count;
+	if (magic != kFileMagic || version != kFileVersion) {
+		StreamUP::DebugLogger::LogDebug("IconCache", "Load", "Ignoring icon cache from another version");
+		return;
+	}
+
+	QHash<QByteArray, CachedImage> loaded;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+		QByteArray key, bits;
+		qint32 width = 0, height = 0;
+		double ratio = 1.0;
+		in >> key >> width >> height >> ratio >> bits;
+		if (in.status() != QDataStream::Ok)
+			break;
+		if (width <= 0 || height <= 0 || width > kMaxImageSide || height > kMaxImageSide ||
+		    bits.size() != qsizetype(width) * height * 4)
+			continue;
+
+		QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+		std::memcpy(image.bits(), bits.constData(), size_t(bits.size()));
+		image.setDevicePixelRatio(ratio);
+		loaded.insert(key, {image, false});
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto it = loaded.cbegin(); it != loaded.cend(); ++it) {
+		// Anything rendered while the file was being read is at least as current
+		if (!images.contains(it.key()))
+			images.insert(it.key(), it.value());
+	}
+	StreamUP::DebugLogger::LogDebugFormat("IconCache", "Load", "Loaded %d cached icon images", int(loaded.size()));
+}
+
+void saveDiskCache(const QString &path, const QHash<QByteArray, CachedImage> &snapshot)
+{
+	// Everything used this session, then older images while there is room
+	QList<QByteArray> keys;
+	for (auto it = snapshot.cbegin(); it != snapshot.cend(); ++it) {
+		if (it.value().used)
+			keys.append(it.key());
+	}
+	for (auto it = snapshot.cbegin(); it != snapshot.cend() && keys.size() < kMaxSavedImages; ++it) {
+		if (!it.value().used)
+			keys.append(it.key());
+	}
+
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly)) {
+		StreamUP::DebugLogger::LogWarningFormat("IconCache", "Could not write %s", path.toUtf8().constData());
+		return;
+	}
+
+	QDataStream out(&file);
+	out << kFileMagic << kFileVersion << quint32(keys.size());
+	for (const QByteArray &key : keys) {
+		const QImage &image = snapshot.value(key).image;
+		out << key << qint32(image.width()) << qint32(image.height()) << double(image.devicePixelRatio())
+		    << QByteArray(reinterpret_cast<const char *>(image.constBits()), qsizetype(image.sizeInBytes()));
+	}
+	if (!file.commit())
+		StreamUP::DebugLogger::LogWarningFormat("IconCache", "Could not write %s", path.toUtf8().constData());
+}
+
+// Render unless it is already there; marks it used either way
+void renderIfMissing(const RenderJob &job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = images.find(job.key);
+		if (it != images.end()) {
+			it->used = true;
+			return;
+		}
+	}
+
+	const QImage image = render(job.svg, job.size, job.ratio);
+	if (image.isNull())
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	images.insert(job.key, {image, true});
+	dirty = true;
+}
+
+void prefetchUiIcons(const QList<qreal> &ratios)
+{
+	QDirIterator it(QStringLiteral(":/images/icons/ui"), {QStringLiteral("*.svg")}, QDir::Files);
+	while (it.hasNext()) {
+		const QByteArray svg = readSvg(it.next());
+		if (svg.isEmpty())
+			continue;
+		const QByteArray hash = contentHash(svg);
+		for (const QSize &size : kPrefetchSizes) {
+			for (qreal ratio : ratios) {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (stopping)
+						return;
+				}
+				renderIfMissing({imageKey(hash, size, ratio), svg, size, ratio});
+			}
+		}
+	}
+}
+
+void workerLoop()
+{
+	QString path;
+	QList<qreal> ratios;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		path = cacheFile;
+		ratios = prefetchRatios;
+	}
+
+	if (!path.isEmpty())
+		loadDiskCache(path);
+	prefetchUiIcons(ratios);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		wake.wait(lock, [] { return stopping || !jobs.empty(); });
+		if (stopping)
+			return;
+
+		RenderJob job = std::move(jobs.front());
+		jobs.pop_front();
+		lock.unlock();
+
+		renderIfMissing(job);
+
+		lock.lock();
+		queuedKeys.remove(job.key);
+	}
+}
+
+} // namespace
+
+QIcon Get(const QString &svgPath, const QSize &logicalSize)
+{
+	if (!svgPath.endsWith(QStringLiteral(".svg"), Qt::CaseInsensitive))
+		return QIcon(svgPath);
+
+	const IconKey iconKey{svgPath, logicalSize};
+
+	// Only resources are remembered by path; a file on disk can change under it
+	const bool isResource = svgPath.startsWith(QLatin1Char(':'));
+	if (isResource) {
+		auto built = builtIcons.constFind(iconKey);
+		if (built != builtIcons.constEnd())
+			return built.value();
+	}
+
+	QByteArray svg;
+	QByteArray hash;
+	if (isResource && resourceHashes.contains(svgPath)) {
+		hash = resourceHashes.value(svgPath);
+	} else {
+		svg = readSvg(svgPath);
+		if (svg.isEmpty())
+			return QIcon(svgPath);
+		hash = contentHash(svg);
+		if (isResource)
+			resourceHashes.insert(svgPath, hash);
+	}
+
+	const QList<qreal> &ratios = currentRatios();
+	QList<QImage> found;
+	QList<qreal> missing;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (qreal ratio : ratios) {
+			auto it = images.find(imageKey(hash, logicalSize, ratio));
+			if (it != images.end()) {
+				it->used = true;
+				found.append(it->image);
+			} else {
+				missing.append(ratio);
+			}
+		}
+	}
+
+	if (!missing.isEmpty()) {
+		if (svg.isEmpty())
+			svg = readSvg(svgPath);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!stopping) {
+			for (qreal ratio : missing) {
+				const QByteArray key = imageKey(hash, logicalSize, ratio);
+				if (queuedKeys.contains(key))
+					continue;
+				queuedKeys.insert(key);
+				jobs.push_back({key, svg, logicalSize, ratio});
+			}
+			wake.notify_one();
+		}
+	}
+
+	// The SVG engine stays underneath, so sizes that were not cached still
+	// come out sharp; the added pixmaps answer exact sizes.
+	QIcon icon(svgPath);
+	for (const QImage &image : found)
+		icon.addPixmap(QPixmap::fromImage(image));
+
+	if (isResource && missing.isEmpty())
+		builtIcons.insert(iconKey, icon);
+	return icon;
+}
+
+void Start()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (started)
+		return;
+	started = true;
+
+	char *path = obs_module_get_config_path(obs_current_module(), "icon-cache.bin");
+	if (path) {
+		cacheFile = QString::fromUtf8(path);
+		bfree(path);
+	}
+	prefetchRatios = currentRatios();
+	worker = std::thread(workerLoop);
+}
+
+void Stop()
+{
+	// The screen connections run code in this module, so they go before it does
+	delete screenWatcher;
+	screenWatcher = nullptr;
+	builtIcons.clear();
+
+	QHash<QByteArray, CachedImage> snapshot;
+	QString path;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (!started || stopping)
+			return;
+		stopping = true;
+		wake.notify_one();
+		lock.unlock();
+
+		// Queued renders are dropped; they are only ever a head start
+		worker.join();
+
+		lock.lock();
+		jobs.clear();
+		queuedKeys.clear();
+		if (!dirty)
+			return;
+		snapshot = images;
+		path = cacheFile;
+		dirty = false;
+	}
+
+	if (!path.isEmpty())
+		saveDiskCache(path, snapshot);
+}
+
+} // namespace IconCache
+} // namespace StreamUP
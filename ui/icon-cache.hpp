@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QIcon>
+#include <QSize>
+#include <QString>
+
+namespace StreamUP {
+namespace IconCache {
+
+//-------------------RASTERISED SVG ICONS-------------------
+/**
+ * Shared cache of SVG icons rasterised ahead of time.
+ *
+ * A QIcon built from an SVG path parses and renders the SVG on the UI thread
+ * the first time each button paints it, and again for every new QIcon; a theme
+ * switch swaps every toolbar icon for its other variant and pays that for all of
+ * them at once, per screen scale. Here icons are rendered on a worker thread at
+ * each screen's device pixel ratio and handed out as plain pixmaps.
+ *
+ * Rendered images are keyed by a hash of the SVG's content, the logical size
+ * and the device pixel ratio, so a changed file never matches a stale image. They are packed into one file in the plugin config folder and
+ * read back at startup, so after the first run both theme variants of every UI
+ * icon are ready before anything asks for them.
+ */
+
+/**
+ * Get an icon for the SVG at `svgPath` drawn at `logicalSize`.
+ *
+ * When every screen scale is cached this is a lookup. Otherwise the missing
+ * images are queued for the worker and the usual QIcon(svgPath) is returned in
+ * the meantime, with whatever scales are cached added to it. Paths that are not
+ * SVGs are passed straight to QIcon. UI thread only.
+ */
+QIcon Get(const QString &svgPath, const QSize &logicalSize);
+
+/**
+ * Read the disk cache and render the UI icon set for both themes at the
+ * toolbar sizes, all on the worker. Call once OBS has finished loading.
+ */
+void Start();
+
+/** Wait for the worker and write the disk cache if anything new was rendered. */
+void Stop();
+
+} // namespace IconCache
+} // namespace StreamUP
@@ -1,5 +1,6 @@
 #include "icon-selector-dialog.hpp"
 #include "ui-helpers.hpp"
+#include "icon-cache.hpp"
 #include <streamup/ui/window-chrome.hpp>
 #include <streamup/ui/pill-button.hpp>
 #include <streamup/ui/dialogs.hpp>
@@ -485,6 +486,11 @@ QString IconSelectorDialog::getIconDisplayName(const QString& iconPath) {
 }
 
 QIcon IconSelectorDialog::loadPreviewIcon(const QString& iconPath) {
+    // Bundled and user SVGs come pre-rendered from the shared icon cache
+    if (iconPath.endsWith(".svg", Qt::CaseInsensitive) && QFile::exists(iconPath)) {
+        return StreamUP::IconCache::Get(iconPath, QSize(StreamUP::UIStyles::S(ICON_SIZE), StreamUP::UIStyles::S(ICON_SIZE)));
+    }
+
     // Try direct file path first (for full paths from OBS icons)
     QIcon directIcon(iconPath);
     if (!directIcon.isNull()) {
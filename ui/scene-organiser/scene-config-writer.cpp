@@ -0,0 +1,140 @@
+#include "scene-config-writer.hpp"
+#include "../../utilities/write-behind.hpp"
+#include <streamup/debug-logger.hpp>
+#include <util/platform.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace StreamUP {
+namespace SceneOrganiser {
+namespace ConfigWriter {
+
+namespace {
+
+// How long the worker lets a burst of saves settle before writing. Flush()
+// cuts the wait short.
+constexpr auto kSettleDelay = std::chrono::milliseconds(250);
+
+struct PendingWrite {
+    QString path;
+    QString collection;                  // scene tree writes only
+    QByteArray text;                     // text writes only
+    obs_data_array_t *folders = nullptr; // scene tree writes only, owned
+};
+
+// Keyed by path, plus the collection for scene tree writes
+using PendingMap = std::map<QString, PendingWrite>;
+
+void releaseWrite(PendingWrite &write)
+{
+    if (write.folders) {
+        obs_data_array_release(write.folders);
+        write.folders = nullptr;
+    }
+}
+
+void writeAll(PendingMap &writes)
+{
+    // Scene tree entries for one file are applied together, so the file is
+    // read and written once however many collections are queued for it
+    std::map<QString, std::vector<PendingWrite *>> treesByPath;
+
+    for (auto &entry : writes) {
+        PendingWrite &write = entry.second;
+        if (write.folders) {
+            treesByPath[write.path].push_back(&write);
+            continue;
+        }
+        const QByteArray path = write.path.toUtf8();
+        if (!os_quick_write_utf8_file_safe(path.constData(), write.text.constData(), size_t(write.text.size()),
+                                           false, "tmp", nullptr)) {
+            StreamUP::DebugLogger::LogWarningFormat("SceneOrganiser", "Failed to write %s", path.constData());
+        }
+    }
+
+    for (auto &tree : treesByPath) {
+        const QByteArray path = tree.first.toUtf8();
+        obs_data_t *root = obs_data_create_from_json_file(path.constData());
+        if (!root)
+            root = obs_data_create();
+        for (PendingWrite *write : tree.second)
+            obs_data_set_array(root, write->collection.toUtf8().constData(), write->folders);
+        if (!obs_data_save_json_safe(root, path.constData(), "tmp", nullptr))
+            StreamUP::DebugLogger::LogWarningFormat("SceneOrganiser", "Failed to write %s", path.constData());
+        obs_data_release(root);
+    }
+
+    for (auto &entry : writes)
+        releaseWrite(entry.second);
+
+    StreamUP::DebugLogger::LogDebugFormat("SceneOrganiser", "Save", "Wrote %d config file(s) in the background",
+                                          int(writes.size()));
+}
+
+// Guarded by the writer
+PendingMap pending;
+
+WriteBehind writer(kSettleDelay, [] {
+    auto writes = std::make_shared<PendingMap>();
+    writes->swap(pending);
+    return WriteBehind::Work([writes] { writeAll(*writes); });
+});
+
+void enqueue(const QString &key, PendingWrite &&write)
+{
+    const bool queued = writer.Queue([&key, &write] {
+        auto it = pending.find(key);
+        if (it != pending.end()) {
+            releaseWrite(it->second);
+            it->second = std::move(write);
+        } else {
+            pending.emplace(key, std::move(write));
+        }
+    });
+    if (queued)
+        return;
+
+    // After Stop(): nothing to hand it to, so write it now
+    PendingMap writes;
+    writes.emplace(key, std::move(write));
+    writeAll(writes);
+}
+
+} // namespace
+
+void QueueText(const QString &path, const QString &text)
+{
+    PendingWrite write;
+    write.path = path;
+    write.text = text.toUtf8();
+    enqueue(path, std::move(write));
+}
+
+void QueueSceneTree(const QString &path, const QString &collection, obs_data_array_t *folders)
+{
+    if (!folders)
+        return;
+    PendingWrite write;
+    write.path = path;
+    write.collection = collection;
+    write.folders = folders;
+    enqueue(path + QLatin1Char('\n') + collection, std::move(write));
+}
+
+void Flush()
+{
+    writer.Flush();
+}
+
+void Stop()
+{
+    writer.Stop();
+}
+
+} // namespace ConfigWriter
+} // namespace SceneOrganiser
+} // namespace StreamUP
@@ -0,0 +1,49 @@
+#pragma once
+
+// Write-behind persistence for the Scene Organiser's config files.
+//
+// Saving used to rewrite the lock state, hidden scenes, expansion state and
+// scene tree on the UI thread every time, and the scene tree save re-reads and
+// re-serialises the whole per-canvas JSON file (every collection) to change one
+// key. A drag-and-drop reorder, a rename and the debounced dock save could each
+// do that within a second of one another.
+//
+// Now the dock captures its state on the UI thread (the model is only safe to
+// walk there) and queues it here. Queued writes are keyed by file, and for the
+// scene tree by file and collection, so a newer save replaces one still
+// waiting. A single worker thread lets a burst settle, then reads, serialises
+// and writes each file once, through a temporary file and a rename so a crash
+// mid-write leaves the previous file intact.
+//
+// Flush() blocks until everything queued is on disk. The dock calls it where
+// durability matters: before a scene collection switch, at exit, when it is
+// destroyed, and before it reads any of these files back.
+//
+// All calls are UI-thread calls.
+
+#include <obs.h>
+
+#include <QString>
+
+namespace StreamUP {
+namespace SceneOrganiser {
+namespace ConfigWriter {
+
+// Queue `text` as the whole content of `path`
+void QueueText(const QString &path, const QString &text);
+
+// Queue `folders` as the entry for `collection` in the scene tree file at
+// `path`, leaving other collections in that file as they are. Takes over the
+// caller's reference to `folders`.
+void QueueSceneTree(const QString &path, const QString &collection, obs_data_array_t *folders);
+
+// Wait until every write queued so far has finished
+void Flush();
+
+// Flush and stop the worker. Anything queued afterwards is written inline, so
+// a dock saving on its way out after this still reaches the disk.
+void Stop();
+
+} // namespace ConfigWriter
+} // namespace SceneOrganiser
+} // namespace StreamUP
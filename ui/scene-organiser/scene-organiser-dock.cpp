@@ -1,5 +1,6 @@
 #include "scene-organiser-dock.hpp"
 #include "scene-canvas.hpp"
+#include "scene-config-writer.hpp"
 #include <streamup/ui/dialogs.hpp>
 #include <streamup/ui/color-picker.hpp>
 #include <streamup/ui/window-chrome.hpp>
@@ -7,6 +8,7 @@
 #include "../ui-helpers.hpp"
 #include "../settings-manager.hpp"
 #include <streamup/debug-logger.hpp>
+#include <streamup/trace.hpp>
 #include "../../utilities/obs-data-helpers.hpp"
 #include "../../utilities/path-utils.hpp"
 #include "../../core/plugin-manager.hpp"
@@ -34,7 +36,6 @@
 #include <QStyle>
 #include <QFile>
 #include <QTextStream>
-#include <QtSvg/QSvgRenderer>
 #include <QSortFilterProxyModel>
 #include <QScreen>
 #include <QGuiApplication>
@@ -80,11 +81,8 @@ static const QList<QColor> &PresetColors()
     return presets;
 }
 
-// Data role marking the scene item that is currently LIVE on program.
-// Painted by CustomColorDelegate as a distinct green "on air" indicator that is
-// independent of the tree's normal (blue) selection. UserRole+1 is the custom
-// colour, UserRole+100 is the creation timestamp, so +2 is free.
-static constexpr int ProgramSceneRole = Qt::UserRole + 2;
+// ProgramSceneRole and HiddenSceneRole live in scene-tree-node.hpp, beside
+// the items that answer them.
 
 // Optimized theme icon cache
 static QHash<QString, QIcon> s_themeIconCache;
@@ -123,50 +121,10 @@ static QIcon GetThemeIcon(const QString& propertyName)
     return icon;
 }
 
-// Optimized colored icon cache
-static QHash<QString, QIcon> s_coloredIconCache;
-
-// Helper function to create colored icons from SVG resources (optimized with caching)
-static QIcon CreateColoredIcon(const QString& svgPath, const QColor& color, const QSize& size = QSize(16, 16))
-{
-    // Create cache key from path, color, and size
-    QString cacheKey = QString("%1_%2_%3x%4").arg(svgPath, color.name(), QString::number(size.width()), QString::number(size.height()));
-
-    // Check cache first
-    auto it = s_coloredIconCache.find(cacheKey);
-    if (it != s_coloredIconCache.end()) {
-        return it.value();
-    }
-
-    // Create the icon only if not cached
-    QPixmap pixmap(size);
-    pixmap.fill(Qt::transparent);
-
-    QPainter painter(&pixmap);
-    painter.setRenderHint(QPainter::Antialiasing);
-
-    QSvgRenderer renderer(svgPath);
-    if (renderer.isValid()) {
-        renderer.render(&painter);
-
-        // Apply color overlay
-        painter.setCompositionMode(QPainter::CompositionMode_SourceIn);
-        painter.fillRect(pixmap.rect(), color);
-    }
-
-    QIcon icon(pixmap);
-
-    // Cache the result for future use
-    s_coloredIconCache.insert(cacheKey, icon);
-
-    return icon;
-}
-
 // Cache management functions
 static void ClearIconCaches()
 {
     s_themeIconCache.clear();
-    s_coloredIconCache.clear();
     s_cachedMainWindow = nullptr;
     StreamUP::DebugLogger::LogDebug("SceneOrganiser", "Cache", "Cleared icon caches");
 }
@@ -176,7 +134,6 @@ static void OnThemeChanged()
 {
     // Clear theme-dependent caches
     s_themeIconCache.clear();
-    s_coloredIconCache.clear(); // Color icons may also be theme-dependent
     StreamUP::DebugLogger::LogDebug("SceneOrganiser", "Theme", "Cleared caches for theme change");
 }
 
@@ -280,6 +237,14 @@ SceneOrganiserDock::~SceneOrganiserDock()
     obs_frontend_remove_event_callback(onFrontendEvent, this);
     disconnectCanvasSignals();
 
+    // Changes queued but not yet applied still hold a weak reference each
+    {
+        std::lock_guard<std::mutex> lock(m_canvasChangesMutex);
+        for (const CanvasSceneChange &change : m_canvasChanges)
+            obs_weak_source_release(change.weak);
+        m_canvasChanges.clear();
+    }
+
     // Clean up copy filters source
     if (m_copyFiltersSource) {
         obs_weak_source_release(m_copyFiltersSource);
@@ -288,6 +253,7 @@ SceneOrganiserDock::~SceneOrganiserDock()
 
     s_dockInstances.removeAll(this);
     SaveConfiguration();
+    ConfigWriter::Flush();
     StreamUP::DebugLogger::LogDebug("SceneOrganiser", "Cleanup", "Scene Organiser Dock destroyed");
 }
 
@@ -320,10 +286,11 @@ void SceneOrganiserDock::setupUI()
     m_model = new SceneTreeModel(m_canvasType, this);
 
     // Create proxy model for search/filtering
-    m_proxyModel = new QSortFilterProxyModel(this);
+    m_proxyModel = new SceneNodeFilterProxy(this);
     m_proxyModel->setSourceModel(m_model);
     m_proxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
-    m_proxyModel->setRecursiveFilteringEnabled(true);
+    // No recursive filtering: the proxy accepts the ancestors of every match
+    // itself, so rows under a folder without matches are not visited.
 
     // Create tree view - SceneTreeView only for event handling, no custom styling
     m_treeView = new SceneTreeView(this);
@@ -906,34 +873,74 @@ void SceneOrganiserDock::disconnectCanvasSignals()
 
 // Signal callbacks arrive on OBS threads, never the UI thread, so every one of
 // these hops to the dock's thread before touching the model or widgets.
-void SceneOrganiserDock::OnCanvasSourceAdded(void *data, calldata_t *)
+//
+// Adds, removes and renames are not a refresh each. Loading a collection or
+// pasting a batch of scenes raises dozens of them back to back, so they are
+// queued with what the signal said, and the first one into an empty queue
+// schedules a single pass that applies the lot. Only scenes are ever shown, so
+// anything else on the canvas is dropped before it is queued.
+void SceneOrganiserDock::OnCanvasSourceAdded(void *data, calldata_t *cd)
 {
-    auto *dock = static_cast<SceneOrganiserDock *>(data);
-    QMetaObject::invokeMethod(dock, [dock]() {
-        if (!dock->m_initialLoadComplete)
-            return;
-        dock->refreshSceneList();
-    }, Qt::QueuedConnection);
+    static_cast<SceneOrganiserDock *>(data)->queueCanvasChange(CanvasSceneChange::Kind::Added, cd);
 }
 
-void SceneOrganiserDock::OnCanvasSourceRemoved(void *data, calldata_t *)
+void SceneOrganiserDock::OnCanvasSourceRemoved(void *data, calldata_t *cd)
 {
-    auto *dock = static_cast<SceneOrganiserDock *>(data);
-    QMetaObject::invokeMethod(dock, [dock]() {
-        if (!dock->m_initialLoadComplete)
-            return;
-        dock->refreshSceneList();
-    }, Qt::QueuedConnection);
+    static_cast<SceneOrganiserDock *>(data)->queueCanvasChange(CanvasSceneChange::Kind::Removed, cd);
 }
 
-void SceneOrganiserDock::OnCanvasSourceRenamed(void *data, calldata_t *)
+void SceneOrganiserDock::OnCanvasSourceRenamed(void *data, calldata_t *cd)
 {
-    auto *dock = static_cast<SceneOrganiserDock *>(data);
-    QMetaObject::invokeMethod(dock, [dock]() {
-        if (!dock->m_initialLoadComplete)
-            return;
-        dock->refreshSceneList();
-    }, Qt::QueuedConnection);
+    static_cast<SceneOrganiserDock *>(data)->queueCanvasChange(CanvasSceneChange::Kind::Renamed, cd);
+}
+
+void SceneOrganiserDock::queueCanvasChange(CanvasSceneChange::Kind kind, calldata_t *cd)
+{
+    obs_source_t *source = static_cast<obs_source_t *>(calldata_ptr(cd, "source"));
+    if (!source || !obs_scene_from_source(source))
+        return;
+
+    CanvasSceneChange change;
+    change.kind = kind;
+    change.key = source;
+    // Held until the change is applied, so the weak reference (and with it the
+    // identity check) outlives a source that is being removed right now.
+    change.weak = obs_source_get_weak_source(source);
+    if (kind == CanvasSceneChange::Kind::Renamed)
+        change.name = QString::fromUtf8(calldata_string(cd, "new_name"));
+
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(m_canvasChangesMutex);
+        first = m_canvasChanges.empty();
+        m_canvasChanges.push_back(std::move(change));
+    }
+    if (first)
+        QMetaObject::invokeMethod(this, [this]() { applyCanvasChanges(); }, Qt::QueuedConnection);
+}
+
+void SceneOrganiserDock::applyCanvasChanges()
+{
+    std::vector<CanvasSceneChange> changes;
+    {
+        std::lock_guard<std::mutex> lock(m_canvasChangesMutex);
+        changes.swap(m_canvasChanges);
+    }
+
+    // Before the first load the tree is built from scratch anyway
+    const bool changed = m_initialLoadComplete && m_model->applySceneChanges(changes);
+
+    for (const CanvasSceneChange &change : changes)
+        obs_weak_source_release(change.weak);
+
+    if (!changed)
+        return;
+
+    // Sorting and saving ride on modelChanged; the rest is once per batch
+    updateActiveSceneHighlight();
+    updateHiddenScenesStyling();
+    applySceneVisibility();
+    updateExpandCollapseButtonState();
 }
 
 void SceneOrganiserDock::OnCanvasChannelChanged(void *data, calldata_t *)
@@ -962,7 +969,12 @@ void SceneOrganiserDock::setupSearchBar()
     // Layout search elements
     m_searchLayout->addWidget(m_searchEdit);
 
-    // Connect search functionality
+    // Connect search functionality. Typing is debounced so a burst of keys
+    // filters once; clearing applies at once.
+    m_searchDebounceTimer = new QTimer(this);
+    m_searchDebounceTimer->setSingleShot(true);
+    m_searchDebounceTimer->setInterval(60);
+    connect(m_searchDebounceTimer, &QTimer::timeout, this, [this]() { applySearchText(m_searchEdit->text()); });
     connect(m_searchEdit, &QLineEdit::textChanged, this, &SceneOrganiserDock::onSearchTextChanged);
 
     // Add Escape key shortcut to clear search
@@ -984,6 +996,33 @@ void SceneOrganiserDock::refreshSceneList()
     updateExpandCollapseButtonState();
 }
 
+// The model's sort spec for one of the organiser's sort options
+static SceneNodeModel::SortSpec sortSpecFor(StreamUP::SettingsManager::SceneSortMethod method, bool groupFolders)
+{
+    using Method = StreamUP::SettingsManager::SceneSortMethod;
+    SceneNodeModel::SortSpec spec;
+    spec.foldersFirst = groupFolders;
+    switch (method) {
+    case Method::AlphabeticalAZ:
+        spec.key = SceneNodeModel::SortSpec::Key::Name;
+        break;
+    case Method::AlphabeticalZA:
+        spec.key = SceneNodeModel::SortSpec::Key::Name;
+        spec.descending = true;
+        break;
+    case Method::NewestFirst:
+        spec.key = SceneNodeModel::SortSpec::Key::Created;
+        spec.descending = true;
+        break;
+    case Method::OldestFirst:
+        spec.key = SceneNodeModel::SortSpec::Key::Created;
+        break;
+    case Method::None:
+        break;
+    }
+    return spec;
+}
+
 void SceneOrganiserDock::applySortingIfEnabled()
 {
     StreamUP::SettingsManager::PluginSettings settings = StreamUP::SettingsManager::GetCurrentSettings();
@@ -996,131 +1035,13 @@ void SceneOrganiserDock::applySortingIfEnabled()
     QStandardItem *root = m_model->invisibleRootItem();
     if (!root) return;
 
-    bool groupFolders = settings.sceneOrganiserGroupFolders;
-    auto sortMethod = settings.sceneOrganiserSortMethod;
-
-    // Recursively sort items within each parent
-    std::function<void(QStandardItem*)> sortItemsRecursive = [&](QStandardItem *parent) {
-        if (!parent) return;
-
-        int rowCount = parent->rowCount();
-        if (rowCount <= 1) return;
-
-        // Simple bubble sort to swap rows into correct position
-        bool swapped;
-        do {
-            swapped = false;
-            for (int i = 0; i < parent->rowCount() - 1; ++i) {
-                QStandardItem *item1 = parent->child(i);
-                QStandardItem *item2 = parent->child(i + 1);
-
-                if (!item1 || !item2) continue;
-
-                bool item1IsFolder = (item1->type() == SceneFolderItem::UserType + 1);
-                bool item2IsFolder = (item2->type() == SceneFolderItem::UserType + 1);
-
-                bool shouldSwap = false;
-
-                if (groupFolders) {
-                    // Folders should come before scenes
-                    if (!item1IsFolder && item2IsFolder) {
-                        shouldSwap = true;
-                    }
-                    // Within same type, sort by selected method
-                    else if (item1IsFolder == item2IsFolder) {
-                        if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::AlphabeticalAZ ||
-                            sortMethod == StreamUP::SettingsManager::SceneSortMethod::AlphabeticalZA) {
-                            int comparison = QString::compare(item1->text(), item2->text(), Qt::CaseInsensitive);
-                            if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::AlphabeticalAZ) {
-                                shouldSwap = (comparison > 0);
-                            } else {
-                                shouldSwap = (comparison < 0);
-                            }
-                        } else if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::NewestFirst ||
-                                   sortMethod == StreamUP::SettingsManager::SceneSortMethod::OldestFirst) {
-                            // Get timestamps
-                            qint64 timestamp1 = 0, timestamp2 = 0;
-                            if (item1IsFolder) {
-                                SceneFolderItem *folder1 = static_cast<SceneFolderItem*>(item1);
-                                SceneFolderItem *folder2 = static_cast<SceneFolderItem*>(item2);
-                                timestamp1 = folder1->getCreationTimestamp();
-                                timestamp2 = folder2->getCreationTimestamp();
-                            } else {
-                                SceneTreeItem *scene1 = static_cast<SceneTreeItem*>(item1);
-                                SceneTreeItem *scene2 = static_cast<SceneTreeItem*>(item2);
-                                timestamp1 = scene1->getCreationTimestamp();
-                                timestamp2 = scene2->getCreationTimestamp();
-                            }
-
-                            if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::NewestFirst) {
-                                // Newest first: higher timestamp comes first
-                                shouldSwap = (timestamp1 < timestamp2);
-                            } else {
-                                // Oldest first: lower timestamp comes first
-                                shouldSwap = (timestamp1 > timestamp2);
-                            }
-                        }
-                    }
-                } else {
-                    // Mix folders and scenes, sort by selected method
-                    if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::AlphabeticalAZ ||
-                        sortMethod == StreamUP::SettingsManager::SceneSortMethod::AlphabeticalZA) {
-                        int comparison = QString::compare(item1->text(), item2->text(), Qt::CaseInsensitive);
-                        if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::AlphabeticalAZ) {
-                            shouldSwap = (comparison > 0);
-                        } else {
-                            shouldSwap = (comparison < 0);
-                        }
-                    } else if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::NewestFirst ||
-                               sortMethod == StreamUP::SettingsManager::SceneSortMethod::OldestFirst) {
-                        // Get timestamps (works for both folders and scenes)
-                        qint64 timestamp1 = 0, timestamp2 = 0;
-                        if (item1->type() == SceneFolderItem::UserType + 1) {
-                            SceneFolderItem *folder1 = static_cast<SceneFolderItem*>(item1);
-                            timestamp1 = folder1->getCreationTimestamp();
-                        } else {
-                            SceneTreeItem *scene1 = static_cast<SceneTreeItem*>(item1);
-                            timestamp1 = scene1->getCreationTimestamp();
-                        }
-
-                        if (item2->type() == SceneFolderItem::UserType + 1) {
-                            SceneFolderItem *folder2 = static_cast<SceneFolderItem*>(item2);
-                            timestamp2 = folder2->getCreationTimestamp();
-                        } else {
-                            SceneTreeItem *scene2 = static_cast<SceneTreeItem*>(item2);
-                            timestamp2 = scene2->getCreationTimestamp();
-                        }
-
-                        if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::NewestFirst) {
-                            shouldSwap = (timestamp1 < timestamp2);
-                        } else {
-                            shouldSwap = (timestamp1 > timestamp2);
-                        }
-                    }
-                }
-
-                if (shouldSwap) {
-                    // Swap the two rows
-                    QList<QStandardItem*> row1 = parent->takeRow(i);
-                    QList<QStandardItem*> row2 = parent->takeRow(i); // i because we just removed row i
-                    parent->insertRow(i, row2);
-                    parent->insertRow(i + 1, row1);
-                    swapped = true;
-                }
-            }
-        } while (swapped);
-
-        // Recursively sort all folders
-        for (int i = 0; i < parent->rowCount(); ++i) {
-            QStandardItem *item = parent->child(i);
-            if (item && item->type() == SceneFolderItem::UserType + 1) {
-                sortItemsRecursive(item);
-            }
-        }
-    };
-
-    sortItemsRecursive(root);
-    m_model->saveSceneTree();
+    // Names are compared through keys cached on each item, and folders that
+    // are already in order are left alone; a refresh that changes nothing
+    // neither moves rows nor saves.
+    m_model->setSortSpec(sortSpecFor(settings.sceneOrganiserSortMethod, settings.sceneOrganiserGroupFolders));
+    if (m_model->sortTree(root)) {
+        m_model->saveSceneTree();
+    }
 }
 
 void SceneOrganiserDock::sortManually(StreamUP::SettingsManager::SceneSortMethod method, QStandardItem *parent)
@@ -1134,129 +1055,12 @@ void SceneOrganiserDock::sortManually(StreamUP::SettingsManager::SceneSortMethod
 
     // Get grouping setting
     StreamUP::SettingsManager::PluginSettings settings = StreamUP::SettingsManager::GetCurrentSettings();
-    bool groupFolders = settings.sceneOrganiserGroupFolders;
 
     // Use the same sorting logic as applySortingIfEnabled
-    std::function<void(QStandardItem*, StreamUP::SettingsManager::SceneSortMethod)> sortItemsRecursive =
-        [&](QStandardItem *currentParent, StreamUP::SettingsManager::SceneSortMethod sortMethod) {
-        if (!currentParent) return;
-
-        int rowCount = currentParent->rowCount();
-        if (rowCount <= 1) return;
-
-        // Simple bubble sort to swap rows into correct position
-        bool swapped;
-        do {
-            swapped = false;
-            for (int i = 0; i < currentParent->rowCount() - 1; ++i) {
-                QStandardItem *item1 = currentParent->child(i);
-                QStandardItem *item2 = currentParent->child(i + 1);
-
-                if (!item1 || !item2) continue;
-
-                bool item1IsFolder = (item1->type() == SceneFolderItem::UserType + 1);
-                bool item2IsFolder = (item2->type() == SceneFolderItem::UserType + 1);
-
-                bool shouldSwap = false;
-
-                if (groupFolders) {
-                    // Folders should come before scenes
-                    if (!item1IsFolder && item2IsFolder) {
-                        shouldSwap = true;
-                    }
-                    // Within same type, sort by selected method
-                    else if (item1IsFolder == item2IsFolder) {
-                        if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::AlphabeticalAZ ||
-                            sortMethod == StreamUP::SettingsManager::SceneSortMethod::AlphabeticalZA) {
-                            int comparison = QString::compare(item1->text(), item2->text(), Qt::CaseInsensitive);
-                            if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::AlphabeticalAZ) {
-                                shouldSwap = (comparison > 0);
-                            } else {
-                                shouldSwap = (comparison < 0);
-                            }
-                        } else if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::NewestFirst ||
-                                   sortMethod == StreamUP::SettingsManager::SceneSortMethod::OldestFirst) {
-                            // Get timestamps
-                            qint64 timestamp1 = 0, timestamp2 = 0;
-                            if (item1IsFolder) {
-                                SceneFolderItem *folder1 = static_cast<SceneFolderItem*>(item1);
-                                SceneFolderItem *folder2 = static_cast<SceneFolderItem*>(item2);
-                                timestamp1 = folder1->getCreationTimestamp();
-                                timestamp2 = folder2->getCreationTimestamp();
-                            } else {
-                                SceneTreeItem *scene1 = static_cast<SceneTreeItem*>(item1);
-                                SceneTreeItem *scene2 = static_cast<SceneTreeItem*>(item2);
-                                timestamp1 = scene1->getCreationTimestamp();
-                                timestamp2 = scene2->getCreationTimestamp();
-                            }
-
-                            if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::NewestFirst) {
-                                shouldSwap = (timestamp1 < timestamp2);
-                            } else {
-                                shouldSwap = (timestamp1 > timestamp2);
-                            }
-                        }
-                    }
-                } else {
-                    // Mix folders and scenes, sort by selected method
-                    if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::AlphabeticalAZ ||
-                        sortMethod == StreamUP::SettingsManager::SceneSortMethod::AlphabeticalZA) {
-                        int comparison = QString::compare(item1->text(), item2->text(), Qt::CaseInsensitive);
-                        if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::AlphabeticalAZ) {
-                            shouldSwap = (comparison > 0);
-                        } else {
-                            shouldSwap = (comparison < 0);
-                        }
-                    } else if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::NewestFirst ||
-                               sortMethod == StreamUP::SettingsManager::SceneSortMethod::OldestFirst) {
-                        // Get timestamps (works for both folders and scenes)
-                        qint64 timestamp1 = 0, timestamp2 = 0;
-                        if (item1->type() == SceneFolderItem::UserType + 1) {
-                            SceneFolderItem *folder1 = static_cast<SceneFolderItem*>(item1);
-                            timestamp1 = folder1->getCreationTimestamp();
-                        } else {
-                            SceneTreeItem *scene1 = static_cast<SceneTreeItem*>(item1);
-                            timestamp1 = scene1->getCreationTimestamp();
-                        }
-
-                        if (item2->type() == SceneFolderItem::UserType + 1) {
-                            SceneFolderItem *folder2 = static_cast<SceneFolderItem*>(item2);
-                            timestamp2 = folder2->getCreationTimestamp();
-                        } else {
-                            SceneTreeItem *scene2 = static_cast<SceneTreeItem*>(item2);
-                            timestamp2 = scene2->getCreationTimestamp();
-                        }
-
-                        if (sortMethod == StreamUP::SettingsManager::SceneSortMethod::NewestFirst) {
-                            shouldSwap = (timestamp1 < timestamp2);
-                        } else {
-                            shouldSwap = (timestamp1 > timestamp2);
-                        }
-                    }
-                }
-
-                if (shouldSwap) {
-                    // Swap the two rows
-                    QList<QStandardItem*> row1 = currentParent->takeRow(i);
-                    QList<QStandardItem*> row2 = currentParent->takeRow(i);
-                    currentParent->insertRow(i, row2);
-                    currentParent->insertRow(i + 1, row1);
-                    swapped = true;
-                }
-            }
-        } while (swapped);
-
-        // Recursively sort all folders
-        for (int i = 0; i < currentParent->rowCount(); ++i) {
-            QStandardItem *item = currentParent->child(i);
-            if (item && item->type() == SceneFolderItem::UserType + 1) {
-                sortItemsRecursive(item, sortMethod);
-            }
-        }
-    };
-
-    sortItemsRecursive(parent, method);
-    m_model->saveSceneTree();
+    m_model->setSortSpec(sortSpecFor(method, settings.sceneOrganiserGroupFolders));
+    if (m_model->sortTree(parent)) {
+        m_model->saveSceneTree();
+    }
 }
 
 void SceneOrganiserDock::updateFromObsScenes()
@@ -1854,7 +1658,7 @@ void SceneOrganiserDock::refreshColorMenuState()
 {
     QColor current;
     if (m_currentContextItem) {
-        QVariant colorData = m_currentContextItem->data(Qt::UserRole + 1);
+        QVariant colorData = m_currentContextItem->data(CustomColorRole);
         if (colorData.isValid()) {
             current = colorData.value<QColor>();
         }
@@ -1905,7 +1709,7 @@ void SceneOrganiserDock::applyPresetColor(int presetIndex)
     }
 
     const QColor color = presets[presetIndex];
-    m_currentContextItem->setData(color, Qt::UserRole + 1);
+    m_currentContextItem->setData(color, CustomColorRole);
     applyCustomColorToItem(m_currentContextItem, color);
     m_saveTimer->start();
     forceTreeViewRepaint();
@@ -1932,7 +1736,7 @@ void SceneOrganiserDock::onSetCustomColorClicked()
     }
 
     // Get current color if any
-    QVariant colorData = m_currentContextItem->data(Qt::UserRole + 1);
+    QVariant colorData = m_currentContextItem->data(CustomColorRole);
     QColor currentColor = colorData.isValid() ? colorData.value<QColor>() : QColor();
 
     // Open branded color picker dialog (replaces native QColorDialog; no alpha
@@ -1963,7 +1767,7 @@ void SceneOrganiserDock::onSetCustomColorClicked()
                 QColor selectedColor = cp->color();
                 if (selectedColor.isValid()) {
                     // Store the color in the item
-                    item->setData(selectedColor, Qt::UserRole + 1);
+                    item->setData(selectedColor, CustomColorRole);
 
                     // Apply the color immediately
                     self->applyCustomColorToItem(item, selectedColor);
@@ -1995,7 +1799,7 @@ void SceneOrganiserDock::onClearCustomColorClicked()
     }
 
     // Remove the custom color
-    m_currentContextItem->setData(QVariant(), Qt::UserRole + 1);
+    m_currentContextItem->setData(QVariant(), CustomColorRole);
 
     // Clear the color styling
     clearCustomColorFromItem(m_currentContextItem);
@@ -2014,7 +1818,7 @@ void SceneOrganiserDock::applyCustomColorToItem(QStandardItem *item, const QColo
         return;
     }
 
-    // The colour itself lives on UserRole + 1; CustomColorDelegate reads it there
+    // The colour itself lives on CustomColorRole; CustomColorDelegate reads it there
     // and paints the row. Nothing is set on Qt::BackgroundRole on purpose.
     //
     // Setting it as well would paint the colour twice: the style fills the whole
@@ -2057,7 +1861,7 @@ void SceneOrganiserDock::applyAllCustomColors(QStandardItem *parent)
         if (!item) continue;
 
         // Check if this item has a custom color stored
-        QVariant colorData = item->data(Qt::UserRole + 1);
+        QVariant colorData = item->data(CustomColorRole);
         if (colorData.isValid()) {
             QColor color = colorData.value<QColor>();
             if (color.isValid()) {
@@ -2308,9 +2112,9 @@ void SceneOrganiserDock::onSettingsChanged()
 
 void SceneOrganiserDock::onIconsChanged()
 {
-    // Update all existing items to show/hide icons based on current setting
+    // Items read their icon from the model's style, so this is one change
     if (m_model) {
-        updateAllItemIcons(m_model->invisibleRootItem());
+        m_model->refreshNodeStyle();
     }
 
     // Update checkmarks in context menus
@@ -2357,44 +2161,55 @@ void SceneOrganiserDock::updateActiveSceneHighlight()
         return;
     }
 
+    // Both scenes are looked up by source in the model's tracking index, so a
+    // switch costs two hash lookups however large the tree is.
     QString current_scene_name;
-    QString preview_scene_name;
-
-    // Get the current active (program) scene from OBS
+    QStandardItem *programItem = nullptr;
     obs_source_t *current_scene = Canvas::GetCurrentScene(m_canvasType);
     if (current_scene) {
         current_scene_name = QString::fromUtf8(obs_source_get_name(current_scene));
+        programItem = m_model->findSceneItemForSource(current_scene);
         obs_source_release(current_scene);
     }
 
     // If in studio mode, also get the preview scene
+    QString preview_scene_name;
+    QStandardItem *previewItem = nullptr;
     const bool studioMode = studioModeFor(m_canvasType);
     if (studioMode) {
         obs_source_t *preview_scene = obs_frontend_get_current_preview_scene();
         if (preview_scene) {
             preview_scene_name = QString::fromUtf8(obs_source_get_name(preview_scene));
+            previewItem = m_model->findSceneItemForSource(preview_scene);
             obs_source_release(preview_scene);
         }
     }
 
-    // Mark the LIVE program scene throughout the tree with the dedicated
-    // ProgramSceneRole. The CustomColorDelegate paints these items with a
-    // distinct green "on air" indicator that is INDEPENDENT of the tree's
-    // normal (blue) selection. This tracks the real program scene no matter
-    // how it changed (Stream Deck, hotkey, websocket, OBS scene list, etc.).
-    updateActiveSceneHighlightRecursive(m_model->invisibleRootItem(), current_scene_name, preview_scene_name);
+    // Mark the LIVE program scene with the dedicated ProgramSceneRole. The
+    // CustomColorDelegate paints it with a distinct green "on air" indicator
+    // that is INDEPENDENT of the tree's normal (blue) selection. This tracks
+    // the real program scene no matter how it changed (Stream Deck, hotkey,
+    // websocket, OBS scene list, etc.).
+    //
+    // Only the item that had the marker and the item that gets it are
+    // touched: each setData is one dataChanged for one row, which also
+    // repaints just that row. The previous item is held as a persistent index
+    // so a rebuilt or re-dropped item simply drops out rather than dangling.
+    QStandardItem *previousItem = m_programIndex.isValid() ? m_model->itemFromIndex(m_programIndex) : nullptr;
+    if (previousItem && previousItem != programItem && previousItem->data(ProgramSceneRole).toBool()) {
+        previousItem->setData(false, ProgramSceneRole);
+    }
+    if (programItem && !programItem->data(ProgramSceneRole).toBool()) {
+        programItem->setData(true, ProgramSceneRole);
+    }
+    m_programIndex = programItem ? QPersistentModelIndex(programItem->index()) : QPersistentModelIndex();
 
     // In studio mode, keep the tree SELECTION (blue preview indicator) in sync
     // with OBS' current preview scene, so external preview changes are
     // reflected. Outside studio mode the selection is left entirely to the user
     // (clicks + arrow keys) and is never moved by program changes.
-    if (studioMode && !preview_scene_name.isEmpty()) {
-        selectSceneByName(preview_scene_name);
-    }
-
-    // Repaint so the program indicator refreshes immediately.
-    if (m_treeView->viewport()) {
-        m_treeView->viewport()->update();
+    if (studioMode && previewItem) {
+        selectSceneItem(previewItem);
     }
 
     QString debugMsg = QString("Updated active scene highlight - Program: %1").arg(current_scene_name);
@@ -2404,75 +2219,17 @@ void SceneOrganiserDock::updateActiveSceneHighlight()
     StreamUP::DebugLogger::LogDebug("SceneOrganiser", "ActiveScene", debugMsg.toUtf8().constData());
 }
 
-// Walks the tree and sets ProgramSceneRole=true on the scene item matching the
-// live program scene, clearing it on every other scene item. Does NOT touch
-// selection.
-void SceneOrganiserDock::updateActiveSceneHighlightRecursive(QStandardItem *parent, const QString &activeSceneName, const QString &previewSceneName)
-{
-    Q_UNUSED(previewSceneName);
-
-    if (!parent) {
-        return;
-    }
-
-    for (int i = 0; i < parent->rowCount(); ++i) {
-        QStandardItem *item = parent->child(i);
-        if (!item) {
-            continue;
-        }
-
-        if (item->type() == SceneTreeItem::UserType + 2) {
-            const bool isProgram = !activeSceneName.isEmpty() && item->text() == activeSceneName;
-            // Only write when the state actually changes to avoid needless
-            // dataChanged/repaint churn.
-            if (item->data(ProgramSceneRole).toBool() != isProgram) {
-                item->setData(isProgram, ProgramSceneRole);
-            }
-        }
-
-        // Recurse into folders.
-        if (item->rowCount() > 0) {
-            updateActiveSceneHighlightRecursive(item, activeSceneName, previewSceneName);
-        }
-    }
-}
-
-// Moves the tree selection (blue preview/selected indicator) to the named
-// scene. Programmatic selection only updates toolbar button state
+// Moves the tree selection (blue preview/selected indicator) to a scene item.
+// Programmatic selection only updates toolbar button state
 // (onSceneSelectionChanged); it does NOT switch OBS scenes, so there is no
 // feedback loop back to OBS.
-void SceneOrganiserDock::selectSceneByName(const QString &sceneName)
+void SceneOrganiserDock::selectSceneItem(QStandardItem *item)
 {
-    if (!m_model || !m_treeView || !m_proxyModel || sceneName.isEmpty()) {
-        return;
-    }
-
-    QStandardItem *match = nullptr;
-    std::function<void(QStandardItem *)> findItem = [&](QStandardItem *parent) {
-        if (!parent || match) {
-            return;
-        }
-        for (int i = 0; i < parent->rowCount(); ++i) {
-            QStandardItem *item = parent->child(i);
-            if (!item) {
-                continue;
-            }
-            if (item->type() == SceneTreeItem::UserType + 2 && item->text() == sceneName) {
-                match = item;
-                return;
-            }
-            if (item->rowCount() > 0) {
-                findItem(item);
-            }
-        }
-    };
-    findItem(m_model->invisibleRootItem());
-
-    if (!match) {
+    if (!m_model || !m_treeView || !m_proxyModel || !item) {
         return;
     }
 
-    QModelIndex proxyIndex = m_proxyModel->mapFromSource(match->index());
+    QModelIndex proxyIndex = m_proxyModel->mapFromSource(item->index());
     if (!proxyIndex.isValid()) {
         return; // e.g. filtered out by the search box
     }
@@ -2525,30 +2282,6 @@ void SceneOrganiserDock::triggerActivateSelectedScene()
     obs_source_release(source);
 }
 
-void SceneOrganiserDock::updateAllItemIcons(QStandardItem *parent)
-{
-    if (!parent) return;
-
-    for (int i = 0; i < parent->rowCount(); ++i) {
-        QStandardItem *item = parent->child(i);
-        if (!item) continue;
-
-        // Update icon for this item
-        if (item->type() == SceneFolderItem::UserType + 1) {
-            // Folder item
-            SceneFolderItem *folderItem = static_cast<SceneFolderItem*>(item);
-            folderItem->updateIcon();
-        } else if (item->type() == SceneTreeItem::UserType + 2) {
-            // Scene item
-            SceneTreeItem *sceneItem = static_cast<SceneTreeItem*>(item);
-            sceneItem->updateIcon();
-        }
-
-        // Recursively update children
-        updateAllItemIcons(item);
-    }
-}
-
 // The one-time load: config, saved folder tree, scenes, colours, then enable
 // saves. Normally driven by FINISHED_LOADING, but a dock created AFTER that
 // event has already fired (the Vertical dock, which only exists once its canvas
@@ -2608,6 +2341,8 @@ void SceneOrganiserDock::onFrontendEvent(enum obs_frontend_event event, void *pr
             dock->m_model->saveSceneTree();
             dock->SaveConfiguration();
         }
+        // On disk before OBS moves to the next collection
+        ConfigWriter::Flush();
         // Disable saves during collection switch to prevent race conditions
         dock->m_initialLoadComplete = false;
         break;
@@ -2679,6 +2414,7 @@ void SceneOrganiserDock::onFrontendEvent(enum obs_frontend_event event, void *pr
             StreamUP::DebugLogger::LogDebug("SceneOrganiser", "Exit",
                 "Saved scene tree on OBS exit");
         }
+        ConfigWriter::Flush();
         break;
     default:
         break;
@@ -2716,24 +2452,17 @@ void SceneOrganiserDock::SaveConfiguration()
         return;
     }
 
+    // Everything below is captured here and written by ConfigWriter in the
+    // background; a save queued before this one is replaced, not repeated.
+
     // Save lock state per scene collection
     QString lockStateFile = configDir + "/" + m_configKey + "_" + sceneCollectionName + "_lock_state.txt";
-    QFile file(lockStateFile);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&file);
-        out << (m_isLocked ? "locked" : "unlocked");
-        file.close();
-    }
+    ConfigWriter::QueueText(lockStateFile, m_isLocked ? "locked" : "unlocked");
 
     // Save hidden scenes per scene collection
     QString hiddenScenesFile = configDir + "/" + m_configKey + "_" + sceneCollectionName + "_hidden_scenes.txt";
-    QFile hiddenFile(hiddenScenesFile);
-    if (hiddenFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&hiddenFile);
-        QStringList hiddenScenesList = QStringList(m_hiddenScenes.begin(), m_hiddenScenes.end());
-        out << hiddenScenesList.join("\n");
-        hiddenFile.close();
-    }
+    QStringList hiddenScenesList = QStringList(m_hiddenScenes.begin(), m_hiddenScenes.end());
+    ConfigWriter::QueueText(hiddenScenesFile, hiddenScenesList.join("\n"));
 
     // Now using DigitOtter approach - save is handled by saveSceneTree()
     // which is called automatically on OBS frontend events
@@ -2753,6 +2482,9 @@ void SceneOrganiserDock::SaveConfiguration()
 
 void SceneOrganiserDock::LoadConfiguration()
 {
+    // Read back what was last saved, not what was on disk before it
+    ConfigWriter::Flush();
+
     char *scene_collection = obs_frontend_get_current_scene_collection();
     if (!scene_collection) return;
 
@@ -2907,12 +2639,22 @@ void SceneOrganiserDock::LoadConfiguration()
 
 // Search functionality implementation
 void SceneOrganiserDock::onSearchTextChanged(const QString &text)
+{
+    if (text.isEmpty()) {
+        m_searchDebounceTimer->stop();
+        applySearchText(text);
+        return;
+    }
+    m_searchDebounceTimer->start();
+}
+
+void SceneOrganiserDock::applySearchText(const QString &text)
 {
     if (!m_proxyModel) return;
 
     // Check if we have search text for expansion logic
     bool hasText = !text.isEmpty();
-    bool hadText = !m_proxyModel->filterRegularExpression().pattern().isEmpty();
+    bool hadText = m_proxyModel->isSearchActive();
 
     // Save expansion state when starting a search
     if (hasText && !hadText) {
@@ -2920,11 +2662,15 @@ void SceneOrganiserDock::onSearchTextChanged(const QString &text)
     }
 
     // Apply filter to proxy model
-    m_proxyModel->setFilterWildcard(text);
+    m_proxyModel->setSearchText(text);
 
-    // Expand all items when searching to show matches
+    // Expand only the folders leading to a match
     if (hasText) {
-        m_treeView->expandAll();
+        for (const QStandardItem *folder : m_proxyModel->searchAncestors()) {
+            QModelIndex proxyIndex = m_proxyModel->mapFromSource(folder->index());
+            if (proxyIndex.isValid())
+                m_treeView->expand(proxyIndex);
+        }
     } else {
         // Restore previous expansion state when search is cleared
         restoreExpansionState();
@@ -3056,15 +2802,10 @@ void SceneOrganiserDock::saveFolderExpansionState()
 
     // Save to file
     QString expansionFile = configDir + "/" + m_configKey + "_" + sceneCollectionName + "_expansion_state.txt";
-    QFile file(expansionFile);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&file);
-        out << expandedFolders.join("\n");
-        file.close();
+    ConfigWriter::QueueText(expansionFile, expandedFolders.join("\n"));
 
-        StreamUP::DebugLogger::LogDebug("SceneOrganiser", "Config",
-            QString("Saved expansion state for %1 folders").arg(expandedFolders.size()).toUtf8().constData());
-    }
+    StreamUP::DebugLogger::LogDebug("SceneOrganiser", "Config",
+        QString("Queued expansion state for %1 folders").arg(expandedFolders.size()).toUtf8().constData());
 }
 
 void SceneOrganiserDock::restoreFolderExpansionState()
@@ -3086,6 +2827,7 @@ void SceneOrganiserDock::restoreFolderExpansionState()
     bfree(scene_collection);
 
     // Load from file
+    ConfigWriter::Flush();
     QString expansionFile = configDir + "/" + m_configKey + "_" + sceneCollectionName + "_expansion_state.txt";
     QFile file(expansionFile);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -3295,13 +3037,10 @@ void SceneOrganiserDock::applySceneVisibility()
 {
     if (!m_model || !m_treeView) return;
 
-    // Recursively apply visibility to all scene items in the tree
+    // Flag the scenes to hide; SceneNodeFilterProxy drops them. Only items whose
+    // flag actually flips emit anything, and the proxy re-filters just those
+    // rows, so there is no full invalidate afterwards.
     applySceneVisibilityRecursive(m_model->invisibleRootItem());
-
-    // Force update of the proxy model to refresh the view
-    if (m_proxyModel) {
-        m_proxyModel->invalidate();
-    }
 }
 
 void SceneOrganiserDock::applySceneVisibilityRecursive(QStandardItem *parent)
@@ -3312,18 +3051,9 @@ void SceneOrganiserDock::applySceneVisibilityRecursive(QStandardItem *parent)
         QStandardItem *child = parent->child(i);
         if (!child) continue;
 
-        if (child->type() == SceneTreeItem::UserType + 2) { // Scene item
-            QString sceneName = child->text();
-            bool shouldHide = m_isLocked && m_hiddenScenes.contains(sceneName);
-
-            // Get the model index for this item
-            QModelIndex index = child->index();
-            if (m_treeView) {
-                // Map to proxy model index
-                QModelIndex proxyIndex = m_proxyModel->mapFromSource(index);
-                // Hide/show the row in the tree view
-                m_treeView->setRowHidden(proxyIndex.row(), proxyIndex.parent(), shouldHide);
-            }
+        if (child->type() == SceneItemType) {
+            const bool shouldHide = m_isLocked && m_hiddenScenes.contains(child->text());
+            child->setData(shouldHide, HiddenSceneRole);
         } else if (child->hasChildren()) {
             // Recursively check folder contents
             applySceneVisibilityRecursive(child);
@@ -3700,10 +3430,11 @@ void SceneOrganiserDock::populateProjectorMenu()
 //==============================================================================
 
 SceneTreeModel::SceneTreeModel(CanvasType canvasType, QObject *parent)
-    : QStandardItemModel(parent)
+    : SceneNodeModel(parent)
     , m_canvasType(canvasType)
 {
     setupRootItem();
+    refreshNodeStyle();
     // Don't call refreshFromObs() here - let the dock load configuration first
 }
 
@@ -3718,6 +3449,18 @@ void SceneTreeModel::setupRootItem()
     setHorizontalHeaderLabels(QStringList() << "Scenes");
 }
 
+void SceneTreeModel::refreshNodeStyle()
+{
+    // Settings are read once here rather than once per item as it is created
+    StreamUP::SettingsManager::PluginSettings settings = StreamUP::SettingsManager::GetCurrentSettings();
+    NodeStyle style;
+    style.showIcons = settings.sceneOrganiserShowIcons;
+    // OBS group and scene icons from the theme's main window properties
+    style.folderIcon = GetThemeIcon("groupIcon");
+    style.sceneIcon = GetThemeIcon("sceneIcon");
+    setNodeStyle(style);
+}
+
 Qt::DropActions SceneTreeModel::supportedDropActions() const
 {
     return Qt::MoveAction;
@@ -3892,9 +3635,9 @@ bool SceneTreeModel::dropMimeData(const QMimeData *data, Qt::DropAction action,
             QStandardItem *newItem = new SceneTreeItem(originalItem->text(), weak_source);
 
             // Copy custom color from original item
-            QVariant customColor = originalItem->data(Qt::UserRole + 1);
+            QVariant customColor = originalItem->data(CustomColorRole);
             if (customColor.isValid()) {
-                newItem->setData(customColor, Qt::UserRole + 1);
+                newItem->setData(customColor, CustomColorRole);
                 // Apply the color visually
                 QColor color = customColor.value<QColor>();
                 if (color.isValid()) {
@@ -3919,7 +3662,7 @@ bool SceneTreeModel::dropMimeData(const QMimeData *data, Qt::DropAction action,
                 .arg(newItem->text()).arg(newItem->row()).arg(parentItem->rowCount()).toUtf8().constData());
 
             // Update tracking map with new item
-            m_scenesInTree[weak_source] = newItem;
+            setTrackedItem(weak_source, newItem);
 
             StreamUP::DebugLogger::LogDebug("SceneOrganiser", "DragDrop",
                 QString("Updated tracking for scene '%1' - new item at %2")
@@ -3960,18 +3703,20 @@ bool SceneTreeModel::dropMimeData(const QMimeData *data, Qt::DropAction action,
 
 void SceneTreeModel::updateTree(const QModelIndex &selectedIndex)
 {
+    STREAMUP_TRACE_SCOPE("SceneOrganiser::SceneTreeModel::updateTree");
+
     // Get the scenes on this dock's canvas. obs_frontend_get_scenes only ever
     // returns main-canvas scenes, so a vertical dock has to go through the
     // canvas API to see anything at all.
     std::vector<obs_source_t *> scene_list = Canvas::GetScenes(m_canvasType);
 
     source_map_t new_scene_tree;
+    new_scene_tree.reserve(scene_list.size());
 
     StreamUP::DebugLogger::LogDebug("SceneOrganiser", "UpdateTree",
         QString("Processing %1 scenes from OBS").arg(scene_list.size()).toUtf8().constData());
 
-    for (size_t i = 0; i < scene_list.size(); i++) {
-        obs_source_t *source = scene_list[i];
+    for (obs_source_t *source : scene_list) {
         if (!source) continue;
 
         obs_scene_t *scene = obs_scene_from_source(source);
@@ -3979,40 +3724,28 @@ void SceneTreeModel::updateTree(const QModelIndex &selectedIndex)
 
         if (!isManagedScene(source)) continue;
 
-        obs_weak_source_t *weak = obs_source_get_weak_source(source);
-        source_map_t::iterator scene_it;
-
-        // Check if scene already in tree by comparing actual sources, not weak pointers
-        // Different weak references can point to the same source
-        scene_it = m_scenesInTree.end();
-        for (auto it = m_scenesInTree.begin(); it != m_scenesInTree.end(); ++it) {
-            obs_source_t *existing_source = obs_weak_source_get_source(it->first);
-            bool same_source = (existing_source == source);
-            obs_source_release(existing_source);
-
-            if (same_source) {
-                scene_it = it;
-                break;
-            }
-        }
-
-        if (scene_it != m_scenesInTree.end()) {
+        // Look the scene up by its source pointer. A match alone is not proof:
+        // a deleted scene's address can be handed to a new one, so the entry's
+        // weak reference has to agree, which it can say without a ref/release.
+        TrackedScene tracked;
+        auto scene_it = m_scenesInTree.find(source);
+        if (scene_it != m_scenesInTree.end() &&
+            obs_weak_source_references_source(scene_it->second.weak, source)) {
             // Move existing scene to new tree
-            auto new_scene_it = new_scene_tree.emplace(scene_it->first, scene_it->second).first;
+            tracked = scene_it->second;
             m_scenesInTree.erase(scene_it);
-            scene_it = new_scene_it;
-            obs_weak_source_release(weak); // Release the duplicate weak reference
         } else {
-            // Add new scene
-            scene_it = new_scene_tree.emplace(weak, nullptr).first;
+            // New scene. A stale entry under the same pointer stays behind and
+            // is removed with the other scenes OBS no longer has.
+            tracked.weak = obs_source_get_weak_source(source);
         }
 
-        if (!scene_it->second) {
+        const char *name = obs_source_get_name(source);
+        if (!tracked.item) {
             // Scene not yet in tree, add it
-            const char *name = obs_source_get_name(source);
             if (name) {
                 QString sceneName = QString::fromUtf8(name);
-                QStandardItem *newSceneItem = new SceneTreeItem(sceneName, scene_it->first);
+                QStandardItem *newSceneItem = new SceneTreeItem(sceneName, tracked.weak);
 
                 // Determine where to add the scene
                 QStandardItem *parent = invisibleRootItem();
@@ -4026,35 +3759,40 @@ void SceneTreeModel::updateTree(const QModelIndex &selectedIndex)
                 }
 
                 parent->appendRow(newSceneItem);
-                scene_it->second = newSceneItem;
+                tracked.item = newSceneItem;
 
                 StreamUP::DebugLogger::LogDebug("SceneOrganiser", "UpdateTree",
                     QString("Added new scene: %1").arg(sceneName).toUtf8().constData());
             }
-        } else {
-            // Update existing scene name
-            const char *name = obs_source_get_name(source);
-            if (name) {
-                scene_it->second->setText(QString::fromUtf8(name));
-            }
+        } else if (name) {
+            // Update existing scene name, only when it changed so an ordinary
+            // refresh does not emit a dataChanged for every row
+            const QString sceneName = QString::fromUtf8(name);
+            if (tracked.item->text() != sceneName)
+                tracked.item->setText(sceneName);
         }
+
+        new_scene_tree.emplace(source, tracked);
     }
 
     // Remove scenes that are no longer in OBS
     for (auto &old_scene : m_scenesInTree) {
-        if (old_scene.second) {
-            QStandardItem *parent = old_scene.second->parent();
+        const TrackedScene &tracked = old_scene.second;
+        if (tracked.item) {
+            QStandardItem *parent = tracked.item->parent();
             if (!parent) parent = invisibleRootItem();
 
-            QString sceneName = old_scene.second->text();
-            int row = old_scene.second->row();
+            QString sceneName = tracked.item->text();
+            int row = tracked.item->row();
+            // The item owns the weak reference and releases it as it goes
             parent->removeRow(row);
 
             StreamUP::DebugLogger::LogDebug("SceneOrganiser", "UpdateTree",
                 QString("Removed scene: %1").arg(sceneName).toUtf8().constData());
+        } else {
+            // Never got an item, so the reference is still ours to release
+            obs_weak_source_release(tracked.weak);
         }
-        // Release the weak source reference
-        obs_weak_source_release(old_scene.first);
     }
 
     // Update our scene tree
@@ -4068,6 +3806,84 @@ void SceneTreeModel::updateTree(const QModelIndex &selectedIndex)
     emit modelChanged();
 }
 
+bool SceneTreeModel::applySceneChanges(const std::vector<CanvasSceneChange> &changes)
+{
+    bool changed = false;
+
+    for (const CanvasSceneChange &change : changes) {
+        // The queue holds a reference to the weak source, so comparing it
+        // with the tracked one is an exact identity check
+        auto it = m_scenesInTree.find(change.key);
+        const bool tracked = it != m_scenesInTree.end() && it->second.weak == change.weak;
+
+        switch (change.kind) {
+        case CanvasSceneChange::Kind::Added: {
+            if (tracked) break;
+
+            // Gone again before this ran: nothing to show
+            obs_source_t *source = obs_weak_source_get_source(change.weak);
+            if (!source) break;
+
+            const char *name = obs_source_get_name(source);
+            if (isManagedScene(source) && name) {
+                // A stale entry left under a reused address goes first
+                if (it != m_scenesInTree.end())
+                    removeTracked(it);
+
+                const QString sceneName = QString::fromUtf8(name);
+                obs_weak_source_addref(change.weak); // the item's own reference
+                QStandardItem *item = new SceneTreeItem(sceneName, change.weak);
+                invisibleRootItem()->appendRow(item);
+                m_scenesInTree[change.key] = {change.weak, item};
+                changed = true;
+
+                StreamUP::DebugLogger::LogDebug("SceneOrganiser", "UpdateTree",
+                    QString("Added new scene: %1").arg(sceneName).toUtf8().constData());
+            }
+            obs_source_release(source);
+            break;
+        }
+        case CanvasSceneChange::Kind::Removed:
+            if (!tracked) break;
+            removeTracked(it);
+            changed = true;
+            break;
+        case CanvasSceneChange::Kind::Renamed:
+            if (!tracked || !it->second.item || change.name.isEmpty()) break;
+            if (it->second.item->text() != change.name) {
+                it->second.item->setText(change.name);
+                changed = true;
+            }
+            break;
+        }
+    }
+
+    if (changed)
+        emit modelChanged();
+    return changed;
+}
+
+void SceneTreeModel::removeTracked(source_map_t::iterator it)
+{
+    const TrackedScene tracked = it->second;
+    m_scenesInTree.erase(it);
+
+    if (tracked.item) {
+        QStandardItem *parent = tracked.item->parent();
+        if (!parent) parent = invisibleRootItem();
+
+        const QString sceneName = tracked.item->text();
+        // The item owns the weak reference and releases it as it goes
+        parent->removeRow(tracked.item->row());
+
+        StreamUP::DebugLogger::LogDebug("SceneOrganiser", "UpdateTree",
+            QString("Removed scene: %1").arg(sceneName).toUtf8().constData());
+    } else {
+        // Never got an item, so the reference is still ours to release
+        obs_weak_source_release(tracked.weak);
+    }
+}
+
 bool SceneTreeModel::isValidSceneForCanvas(obs_scene_t *scene)
 {
     if (!scene) return false;
@@ -4084,10 +3900,38 @@ bool SceneTreeModel::isValidSceneForCanvas(obs_scene_t *scene)
 }
 
 
+obs_source_t *SceneTreeModel::trackingKey(obs_weak_source_t *weak_source)
+{
+    obs_source_t *source = obs_weak_source_get_source(weak_source);
+    // Only the address is wanted; the map never dereferences its keys
+    obs_source_release(source);
+    return source;
+}
+
+void SceneTreeModel::setTrackedItem(obs_weak_source_t *weak_source, QStandardItem *item)
+{
+    obs_source_t *key = trackingKey(weak_source);
+    if (!key) return;
+
+    auto it = m_scenesInTree.find(key);
+    if (it != m_scenesInTree.end())
+        it->second.item = item;
+    else
+        m_scenesInTree[key] = {weak_source, item};
+}
+
+QStandardItem *SceneTreeModel::findSceneItemForSource(obs_source_t *source)
+{
+    auto it = m_scenesInTree.find(source);
+    if (it == m_scenesInTree.end() || !obs_weak_source_references_source(it->second.weak, source))
+        return nullptr;
+    return it->second.item;
+}
+
 QStandardItem *SceneTreeModel::findSceneItem(obs_weak_source_t *weak_source)
 {
-    auto it = m_scenesInTree.find(weak_source);
-    return (it != m_scenesInTree.end()) ? it->second : nullptr;
+    auto it = m_scenesInTree.find(trackingKey(weak_source));
+    return (it != m_scenesInTree.end()) ? it->second.item : nullptr;
 }
 
 QStandardItem *SceneTreeModel::findFolderItem(const QString &folderName)
@@ -4222,7 +4066,7 @@ void SceneTreeModel::moveSceneItem(QStandardItem *item, int row, QStandardItem *
     QStandardItem *takenItem = oldParent->takeChild(item->row());
     if (takenItem) {
         parentItem->insertRow(row, takenItem);
-        m_scenesInTree[weak] = takenItem;
+        setTrackedItem(weak, takenItem);
 
         StreamUP::DebugLogger::LogDebug("SceneOrganiser", "Move",
             QString("Moved scene '%1' to row %2").arg(sceneName).arg(row).toUtf8().constData());
@@ -4259,9 +4103,9 @@ void SceneTreeModel::moveSceneFolder(QStandardItem *item, int row, QStandardItem
     }
 
     // Copy custom color from original folder
-    QVariant customColor = item->data(Qt::UserRole + 1);
+    QVariant customColor = item->data(CustomColorRole);
     if (customColor.isValid()) {
-        newFolder->setData(customColor, Qt::UserRole + 1);
+        newFolder->setData(customColor, CustomColorRole);
         // Apply the color visually
         QColor color = customColor.value<QColor>();
         if (color.isValid()) {
@@ -4359,26 +4203,15 @@ void SceneTreeModel::saveSceneTree()
 
     bfree(configPath);
 
-    // Load existing data first to preserve other scene collections
-    obs_data_t *root_data = obs_data_create_from_json_file(configFile.toUtf8().constData());
-    if (!root_data) {
-        // File doesn't exist yet, create new data
-        root_data = obs_data_create();
-    }
-
-    // Update only the current scene collection's data
+    // Only the walk of the model happens here. Merging it into the file, which
+    // holds every collection, and writing it out is ConfigWriter's job.
     obs_data_array_t *folder_array = createFolderArray(*invisibleRootItem());
-    obs_data_set_array(root_data, scene_collection, folder_array);
-    obs_data_array_release(folder_array);
-
-    // Save to file (now preserves other collections)
-    obs_data_save_json(root_data, configFile.toUtf8().constData());
-    obs_data_release(root_data);
+    ConfigWriter::QueueSceneTree(configFile, sceneCollectionName, folder_array);
 
     bfree(scene_collection);
 
     StreamUP::DebugLogger::LogDebug("SceneOrganiser", "Save",
-        QString("Saved scene tree for collection '%1' to: %2").arg(sceneCollectionName, configFile).toUtf8().constData());
+        QString("Queued scene tree for collection '%1' to: %2").arg(sceneCollectionName, configFile).toUtf8().constData());
 }
 
 void SceneTreeModel::loadSceneTree()
@@ -4404,7 +4237,8 @@ void SceneTreeModel::loadSceneTree()
     // Clean up previous tree
     cleanupSceneTree();
 
-    // Load from file
+    // Load from file, once any save still queued for it has landed
+    ConfigWriter::Flush();
     obs_data_t *root_data = obs_data_create_from_json_file(configFile.toUtf8().constData());
     if (root_data) {
         obs_data_array_t *folder_array = obs_data_get_array(root_data, scene_collection);
@@ -4450,6 +4284,9 @@ bool SceneTreeModel::migrateFromOriginalPlugin(const QString &originalConfigPath
         return false;
     }
 
+    // This reads and rewrites the file directly; let queued saves land first
+    ConfigWriter::Flush();
+
     QString configDir = QString::fromUtf8(configPath);
     QString configFile = configDir + "/" + sceneTreeFileName(m_canvasType);
     bfree(configPath);
@@ -4638,6 +4475,9 @@ bool SceneTreeModel::migrateCurrentCollection()
     QString configFile = configDir + "/" + sceneTreeFileName(m_canvasType);
     bfree(our_config_path);
 
+    // This reads and rewrites the file directly; let queued saves land first
+    ConfigWriter::Flush();
+
     // Load existing data to preserve other collections
     obs_data_t *root_data = obs_data_create_from_json_file(configFile.toUtf8().constData());
     if (!root_data) {
@@ -4667,7 +4507,7 @@ void SceneTreeModel::loadOriginalFolderArray(obs_data_array_t *folder_array, QSt
 
 void SceneTreeModel::removeSceneFromTracking(obs_weak_source_t *weak_source)
 {
-    auto it = m_scenesInTree.find(weak_source);
+    auto it = m_scenesInTree.find(trackingKey(weak_source));
     if (it != m_scenesInTree.end()) {
         m_scenesInTree.erase(it);
         // Note: Don't release weak_source here - it will be released by the SceneTreeItem destructor
@@ -4698,7 +4538,7 @@ obs_data_array_t *SceneTreeModel::createFolderArray(QStandardItem &parent)
             obs_data_set_bool(item_data, "expanded", true);
 
             // Save custom color if set
-            QVariant colorData = child->data(Qt::UserRole + 1);
+            QVariant colorData = child->data(CustomColorRole);
             if (colorData.isValid()) {
                 QColor color = colorData.value<QColor>();
                 // HexArgb: the preset colours carry alpha, which QColor::name() would drop.
@@ -4716,7 +4556,7 @@ obs_data_array_t *SceneTreeModel::createFolderArray(QStandardItem &parent)
             obs_data_set_string(item_data, "type", "scene");
 
             // Save custom color if set
-            QVariant colorData = child->data(Qt::UserRole + 1);
+            QVariant colorData = child->data(CustomColorRole);
             if (colorData.isValid()) {
                 QColor color = colorData.value<QColor>();
                 // HexArgb: the preset colours carry alpha, which QColor::name() would drop.
@@ -4760,7 +4600,7 @@ void SceneTreeModel::loadFolderArray(obs_data_array_t *folder_array, QStandardIt
                 if (colorName && strlen(colorName) > 0) {
                     QColor color(colorName);
                     if (color.isValid()) {
-                        folderItem->setData(color, Qt::UserRole + 1);
+                        folderItem->setData(color, CustomColorRole);
                     }
                 }
 
@@ -4785,12 +4625,12 @@ void SceneTreeModel::loadFolderArray(obs_data_array_t *folder_array, QStandardIt
                 if (colorName && strlen(colorName) > 0) {
                     QColor color(colorName);
                     if (color.isValid()) {
-                        sceneItem->setData(color, Qt::UserRole + 1);
+                        sceneItem->setData(color, CustomColorRole);
                     }
                 }
 
                 // Add to our tracking map
-                m_scenesInTree[weak] = sceneItem;
+                m_scenesInTree[source] = {weak, sceneItem};
 
                 obs_source_release(source);
 
@@ -4862,7 +4702,7 @@ void SceneTreeView::drawRow(QPainter *painter, const QStyleOptionViewItem &optio
     // The delegate's own copy of the state was already cleared, which is why an
     // unselected coloured row looked right and only the selected one did not:
     // this fill happens a level above the delegate and needed clearing too.
-    const bool hasCustomColour = index.data(Qt::UserRole + 1).isValid();
+    const bool hasCustomColour = index.data(CustomColorRole).isValid();
     const bool isProgram = index.data(ProgramSceneRole).toBool();
 
     if (!hasCustomColour && !isProgram) {
@@ -4922,7 +4762,7 @@ void SceneTreeView::keyPressEvent(QKeyEvent *event)
 //==============================================================================
 
 SceneFolderItem::SceneFolderItem(const QString &folderName)
-    : QStandardItem(folderName)
+    : SceneNodeItem(folderName)
 {
     setupFolderItem();
     // Set creation timestamp to current time
@@ -4931,39 +4771,25 @@ SceneFolderItem::SceneFolderItem(const QString &folderName)
 
 void SceneFolderItem::setupFolderItem()
 {
-    // NO custom styling - pure OBS theme
-    updateIcon();
+    // NO custom styling - pure OBS theme. The icon comes from the model's style.
     setDropEnabled(true);
     setDragEnabled(true);
 }
 
-void SceneFolderItem::updateIcon()
-{
-    StreamUP::SettingsManager::PluginSettings settings = StreamUP::SettingsManager::GetCurrentSettings();
-    if (settings.sceneOrganiserShowIcons) {
-        // Use OBS group icon for folders from theme properties
-        QIcon groupIcon = GetThemeIcon("groupIcon");
-        setIcon(groupIcon);
-    } else {
-        setIcon(QIcon());
-    }
-}
-
 qint64 SceneFolderItem::getCreationTimestamp() const
 {
-    return data(Qt::UserRole + 100).toLongLong();
+    return data(CreationTimestampRole).toLongLong();
 }
 
 void SceneFolderItem::setCreationTimestamp(qint64 timestamp)
 {
-    setData(timestamp, Qt::UserRole + 100);
+    setData(timestamp, CreationTimestampRole);
 }
 
 SceneTreeItem::SceneTreeItem(const QString &sceneName, obs_weak_source_t *weak_source)
-    : QStandardItem(sceneName), m_weakSource(weak_source)
+    : SceneNodeItem(sceneName), m_weakSource(weak_source)
 {
     setupSceneItem();
-    updateFromObs();
     // Set creation timestamp to current time
     setCreationTimestamp(QDateTime::currentMSecsSinceEpoch());
 }
@@ -4979,54 +4805,19 @@ SceneTreeItem::~SceneTreeItem()
 
 void SceneTreeItem::setupSceneItem()
 {
-    // NO custom styling - pure OBS theme
-    updateIcon();
+    // NO custom styling - pure OBS theme. The icon comes from the model's style.
     setDropEnabled(false);
     setDragEnabled(true);
 }
 
-void SceneTreeItem::updateIcon()
-{
-    StreamUP::SettingsManager::PluginSettings settings = StreamUP::SettingsManager::GetCurrentSettings();
-    if (settings.sceneOrganiserShowIcons) {
-        // Use scene icon from theme properties
-        QIcon sceneIcon = GetThemeIcon("sceneIcon");
-        setIcon(sceneIcon);
-
-        // Could add special styling for current scene in the future
-        // obs_source_t *current_scene = Canvas::GetCurrentScene(m_canvasType);
-        // obs_source_t *this_scene = obs_weak_source_get_source(m_weakSource);
-        // if (current_scene && this_scene && obs_source_get_ref(current_scene) == obs_source_get_ref(this_scene)) {
-        //     // Current scene - could use different color or styling
-        // }
-        // if (current_scene) obs_source_release(current_scene);
-        // if (this_scene) obs_source_release(this_scene);
-    } else {
-        setIcon(QIcon());
-    }
-}
-
 qint64 SceneTreeItem::getCreationTimestamp() const
 {
-    return data(Qt::UserRole + 100).toLongLong();
+    return data(CreationTimestampRole).toLongLong();
 }
 
 void SceneTreeItem::setCreationTimestamp(qint64 timestamp)
 {
-    setData(timestamp, Qt::UserRole + 100);
-}
-
-void SceneTreeItem::updateFromObs()
-{
-    // Update icon in case current scene changed
-    updateIcon();
-
-    // Get scene info from OBS and update display
-    obs_source_t *source = obs_get_source_by_name(text().toUtf8().constData());
-    if (source) {
-        // Could show additional info like scene item count, etc.
-        obs_source_release(source);
-    }
+    setData(timestamp, CreationTimestampRole);
 }
 
 } // namespace SceneOrganiser
@@ -5085,8 +4876,8 @@ void StreamUP::SceneOrganiser::SceneOrganiserDock::onThemeChanged()
         if (dock && dock->m_model) {
             // Update theme state
             dock->currentThemeIsDark = StreamUP::UIHelpers::IsOBSThemeDark();
-            // Update all icons with the new theme
-            dock->updateAllItemIcons(dock->m_model->invisibleRootItem());
+            // Pick up the new theme's icons
+            dock->m_model->refreshNodeStyle();
             // Schedule viewport repaint
             dock->scheduleOptimizedUpdate();
         }
@@ -5134,7 +4925,7 @@ void StreamUP::SceneOrganiser::CustomColorDelegate::paint(QPainter *painter, con
     const bool isProgram = item->data(ProgramSceneRole).toBool();
 
     // Check if this item has a custom color
-    QVariant colorData = item->data(Qt::UserRole + 1);
+    QVariant colorData = item->data(CustomColorRole);
     QColor customColor = colorData.isValid() ? colorData.value<QColor>() : QColor();
 
     if (!isProgram && !customColor.isValid()) {
@@ -5213,7 +5004,7 @@ QSize StreamUP::SceneOrganiser::CustomColorDelegate::sizeHint(const QStyleOption
     // whole row scales - not just the icon. Without this the row height is only the
     // implicit max(icon, text) height, which stops tracking once the icon dominates.
     QSize size = QStyledItemDelegate::sizeHint(option, index);
-    int rowHeight = StreamUP::SettingsManager::GetCurrentSettings().sceneOrganiserItemHeight;
+    int rowHeight = StreamUP::SettingsManager::GetSettingsSnapshot()->sceneOrganiserItemHeight;
     if (rowHeight < 19) {
         rowHeight = 24;
     } else if (rowHeight > 48) {
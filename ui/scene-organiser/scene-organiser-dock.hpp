@@ -23,9 +23,13 @@
 #include <QSortFilterProxyModel>
 #include <QCheckBox>
 #include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <obs.h>
 #include <obs-frontend-api.h>
 #include "../settings-manager.hpp"
+#include "scene-tree-node.hpp"
 
 namespace StreamUP {
 namespace SceneOrganiser {
@@ -44,6 +48,16 @@ enum class CanvasType {
     Vertical
 };
 
+// One scene added, removed or renamed on a canvas, as the canvas signal
+// reported it. Queued from the OBS thread and applied in batches on the UI one.
+struct CanvasSceneChange {
+    enum class Kind { Added, Removed, Renamed };
+    Kind kind = Kind::Added;
+    obs_source_t *key = nullptr;       // tracking key only, never dereferenced
+    obs_weak_source_t *weak = nullptr; // one reference, owned by the queue
+    QString name;                      // the new name, for renames
+};
+
 class SceneOrganiserDock : public QFrame {
     Q_OBJECT
 
@@ -120,6 +134,7 @@ private:
     void setupObsSignals();
     void setupSearchBar();
     void onSearchTextChanged(const QString &text);
+    void applySearchText(const QString &text);
     void onClearSearch();
     void saveExpansionState();
     void restoreExpansionState();
@@ -134,13 +149,11 @@ private:
     void showFolderContextMenu(const QPoint &pos, const QModelIndex &index);
     void showSceneContextMenu(const QPoint &pos, const QModelIndex &index);
     void showBackgroundContextMenu(const QPoint &pos);
-    void updateAllItemIcons(QStandardItem *parent);
     void updateToggleIconsState();
     void updateLockActionStates();
     void updateActiveSceneHighlight();
-    void updateActiveSceneHighlightRecursive(QStandardItem *parent, const QString &activeSceneName, const QString &previewSceneName = QString());
-    // Moves the tree selection (preview/blue indicator) to a scene by name.
-    void selectSceneByName(const QString &sceneName);
+    // Moves the tree selection (preview/blue indicator) to a scene item.
+    void selectSceneItem(QStandardItem *item);
     void onSetCustomColorClicked();
     void onClearCustomColorClicked();
     // "Set Colour" submenu, mimicking OBS' native Sources menu: Clear, Custom
@@ -193,15 +206,22 @@ public:
     static void OnCanvasSourceRemoved(void *data, calldata_t *cd);
     static void OnCanvasSourceRenamed(void *data, calldata_t *cd);
     static void OnCanvasChannelChanged(void *data, calldata_t *cd);
+    // Canvas add/remove/rename are queued here and applied once per event-loop
+    // turn, so loading a collection is one pass rather than one per source.
+    std::mutex m_canvasChangesMutex;
+    std::vector<CanvasSceneChange> m_canvasChanges;
+    void queueCanvasChange(CanvasSceneChange::Kind kind, calldata_t *cd);
+    void applyCanvasChanges();
     QVBoxLayout *m_mainLayout;
     SceneTreeView *m_treeView;
     SceneTreeModel *m_model;
-    QSortFilterProxyModel *m_proxyModel;
+    SceneNodeFilterProxy *m_proxyModel;
 
     // Search functionality
     QWidget *m_searchWidget;
     QHBoxLayout *m_searchLayout;
     QLineEdit *m_searchEdit;
+    QTimer *m_searchDebounceTimer = nullptr;
     QMap<QPersistentModelIndex, bool> m_savedExpansionState;
 
     // Toolbar and buttons
@@ -282,6 +302,10 @@ public:
     // Scene visibility management
     QSet<QString> m_hiddenScenes;
 
+    // The scene item currently carrying the program marker, so a switch only
+    // has to clear this one and set the new one
+    QPersistentModelIndex m_programIndex;
+
     // Click tracking for rename functionality
     QPersistentModelIndex m_lastClickedIndex;
     // Action references removed - using direct button approach for right-side buttons
@@ -303,7 +327,7 @@ public:
 };
 
 // Custom tree model for scene organization
-class SceneTreeModel : public QStandardItemModel {
+class SceneTreeModel : public SceneNodeModel {
     Q_OBJECT
 
 public:
@@ -321,11 +345,19 @@ public:
     bool dropMimeData(const QMimeData *data, Qt::DropAction action,
                      int row, int column, const QModelIndex &parent) override;
 
+    // Re-read the icon setting and theme icons into the node style
+    void refreshNodeStyle();
+
     // Scene management
     void updateTree(const QModelIndex &selectedIndex = QModelIndex());
+    // Apply queued canvas changes in place, without re-listing the canvas.
+    // Emits modelChanged once if anything changed; true when something did.
+    bool applySceneChanges(const std::vector<CanvasSceneChange> &changes);
     void saveSceneTree();
     void loadSceneTree();
     QStandardItem *findSceneItem(obs_weak_source_t *weak_source);
+    // O(1) through the tracking map; null for a scene this model does not show
+    QStandardItem *findSceneItemForSource(obs_source_t *source);
     QStandardItem *findFolderItem(const QString &folderName);
     QStandardItem *createFolderItem(const QString &folderName);
     QStandardItem *createSceneItem(const QString &sceneName, obs_weak_source_t *weak_source);
@@ -360,9 +392,22 @@ private:
     // Migration helpers
     void loadOriginalFolderArray(obs_data_array_t *folder_array, QStandardItem &parent);
 
-    // DigitOtter-style scene tracking
-    using source_map_t = std::map<obs_weak_source_t*, QStandardItem*>;
+    // Point the tracking entry for a scene at the item that now shows it
+    void setTrackedItem(obs_weak_source_t *weak_source, QStandardItem *item);
+    // The source a weak reference points at, as a tracking key only (not held)
+    static obs_source_t *trackingKey(obs_weak_source_t *weak_source);
+
+    // DigitOtter-style scene tracking, keyed by the source pointer seen when
+    // the scene was added so a refresh finds each scene in O(1). The weak
+    // reference is what proves a pointer still means the same scene.
+    struct TrackedScene {
+        obs_weak_source_t *weak = nullptr;
+        QStandardItem *item = nullptr;
+    };
+    using source_map_t = std::unordered_map<obs_source_t*, TrackedScene>;
     source_map_t m_scenesInTree;
+    // Take a scene out of the tree and stop tracking it
+    void removeTracked(source_map_t::iterator it);
 
     CanvasType m_canvasType;
 
@@ -393,7 +438,7 @@ private:
 };
 
 // Standard item types for the tree
-class SceneFolderItem : public QStandardItem {
+class SceneFolderItem : public SceneNodeItem {
 public:
     explicit SceneFolderItem(const QString &folderName);
 
@@ -404,14 +449,11 @@ public:
     qint64 getCreationTimestamp() const;
     void setCreationTimestamp(qint64 timestamp);
 
-public:
-    void updateIcon();
-
 private:
     void setupFolderItem();
 };
 
-class SceneTreeItem : public QStandardItem {
+class SceneTreeItem : public SceneNodeItem {
 public:
     explicit SceneTreeItem(const QString &sceneName, obs_weak_source_t *weak_source);
     ~SceneTreeItem();
@@ -420,7 +462,6 @@ public:
     bool isScene() const { return true; }
 
     obs_weak_source_t* getWeakSource() const { return m_weakSource; }
-    void updateIcon();
 
     // Timestamp management
     qint64 getCreationTimestamp() const;
@@ -428,7 +469,6 @@ public:
 
 private:
     void setupSceneItem();
-    void updateFromObs();
 
     obs_weak_source_t* m_weakSource;
 };
@@ -0,0 +1,397 @@
+#include "scene-tree-node.hpp"
+
+#include <QRegularExpression>
+
+namespace StreamUP {
+namespace SceneOrganiser {
+
+//==============================================================================
+// SceneNodeItem
+//==============================================================================
+
+SceneNodeItem::SceneNodeItem(const QString &text)
+    : QStandardItem(text)
+    , m_hasColor(0)
+    , m_program(0)
+    , m_hidden(0)
+    , m_sortNameValid(0)
+{
+}
+
+const QString &SceneNodeItem::sortName() const
+{
+    if (!m_sortNameValid) {
+        m_sortName = text().toCaseFolded();
+        m_sortNameValid = 1;
+    }
+    return m_sortName;
+}
+
+bool SceneNodeItem::operator<(const QStandardItem &other) const
+{
+    if (const auto *nodeModel = dynamic_cast<const SceneNodeModel *>(model()))
+        return nodeModel->lessThan(this, &other);
+    return QStandardItem::operator<(other);
+}
+
+QVariant SceneNodeItem::data(int role) const
+{
+    switch (role) {
+    case CustomColorRole:
+        return m_hasColor ? QVariant(QColor::fromRgba(m_color)) : QVariant();
+    case ProgramSceneRole:
+        return bool(m_program);
+    case HiddenSceneRole:
+        return bool(m_hidden);
+    case Qt::DecorationRole:
+        // Owned by a SceneNodeModel in the plugin; anywhere else (a drag's
+        // temporary model, say) falls back to whatever the item holds.
+        if (const auto *nodeModel = dynamic_cast<const SceneNodeModel *>(model())) {
+            const SceneNodeModel::NodeStyle &style = nodeModel->nodeStyle();
+            if (!style.showIcons)
+                return QVariant();
+            return type() == SceneFolderItemType ? style.folderIcon : style.sceneIcon;
+        }
+        break;
+    default:
+        break;
+    }
+    return QStandardItem::data(role);
+}
+
+void SceneNodeItem::setData(const QVariant &value, int role)
+{
+    switch (role) {
+    case CustomColorRole: {
+        // An invalid colour clears it, the same as an empty value
+        const QColor color = value.isValid() ? value.value<QColor>() : QColor();
+        const quint8 has = color.isValid() ? 1 : 0;
+        const QRgb rgba = has ? color.rgba() : 0;
+        if (has == m_hasColor && rgba == m_color)
+            return;
+        m_hasColor = has;
+        m_color = rgba;
+        emitDataChanged();
+        return;
+    }
+    case ProgramSceneRole:
+    case HiddenSceneRole: {
+        const quint8 bit = value.toBool() ? 1 : 0;
+        quint8 current = role == ProgramSceneRole ? m_program : m_hidden;
+        if (current == bit)
+            return; // no dataChanged for a write that changes nothing
+        if (role == ProgramSceneRole)
+            m_program = bit;
+        else
+            m_hidden = bit;
+        emitDataChanged();
+        return;
+    }
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+        m_sortNameValid = 0;
+        QStandardItem::setData(value, role);
+        return;
+    default:
+        QStandardItem::setData(value, role);
+        return;
+    }
+}
+
+//==============================================================================
+// SceneNodeModel
+//==============================================================================
+
+SceneNodeModel::SceneNodeModel(QObject *parent)
+    : QStandardItemModel(parent)
+{
+}
+
+void SceneNodeModel::setNodeStyle(const NodeStyle &style)
+{
+    m_nodeStyle = style;
+    emitDecorationChanged(QModelIndex());
+}
+
+void SceneNodeModel::emitDecorationChanged(const QModelIndex &parent)
+{
+    const int rows = rowCount(parent);
+    if (rows == 0)
+        return;
+
+    emit dataChanged(index(0, 0, parent), index(rows - 1, 0, parent), {Qt::DecorationRole});
+
+    // Only folders have rows of their own to notify
+    for (int row = 0; row < rows; ++row) {
+        const QModelIndex child = index(row, 0, parent);
+        if (hasChildren(child))
+            emitDecorationChanged(child);
+    }
+}
+
+bool SceneNodeModel::lessThan(const QStandardItem *a, const QStandardItem *b) const
+{
+    if (m_sortSpec.foldersFirst) {
+        const bool aFolder = a->type() == SceneFolderItemType;
+        const bool bFolder = b->type() == SceneFolderItemType;
+        if (aFolder != bFolder)
+            return aFolder;
+    }
+
+    // Swap the operands for descending so equal items still compare false
+    const QStandardItem *first = m_sortSpec.descending ? b : a;
+    const QStandardItem *second = m_sortSpec.descending ? a : b;
+
+    switch (m_sortSpec.key) {
+    case SortSpec::Key::Name: {
+        const auto *firstNode = dynamic_cast<const SceneNodeItem *>(first);
+        const auto *secondNode = dynamic_cast<const SceneNodeItem *>(second);
+        if (firstNode && secondNode)
+            return firstNode->sortName() < secondNode->sortName();
+        return QString::compare(first->text(), second->text(), Qt::CaseInsensitive) < 0;
+    }
+    case SortSpec::Key::Created:
+        return first->data(CreationTimestampRole).toLongLong() < second->data(CreationTimestampRole).toLongLong();
+    case SortSpec::Key::None:
+        break;
+    }
+    return false;
+}
+
+bool SceneNodeModel::isInOrder(const QStandardItem *parent) const
+{
+    for (int row = 1; row < parent->rowCount(); ++row) {
+        const QStandardItem *previous = parent->child(row - 1);
+        const QStandardItem *current = parent->child(row);
+        if (previous && current && lessThan(current, previous))
+            return false;
+    }
+    return true;
+}
+
+bool SceneNodeModel::sortTree(QStandardItem *parent)
+{
+    if (!parent || m_sortSpec.key == SortSpec::Key::None)
+        return false;
+
+    if (!isInOrder(parent)) {
+        // A stable sort through operator< above. sortChildren also sorts
+        // every folder below, and keeps persistent indexes pointing at the
+        // same items as they move.
+        parent->sortChildren(0, Qt::AscendingOrder);
+        return true;
+    }
+
+    bool moved = false;
+    for (int row = 0; row < parent->rowCount(); ++row) {
+        QStandardItem *child = parent->child(row);
+        if (child && child->type() == SceneFolderItemType && child->hasChildren())
+            moved = sortTree(child) || moved;
+    }
+    return moved;
+}
+
+//==============================================================================
+// SceneNodeFilterProxy
+//==============================================================================
+
+SceneNodeFilterProxy::SceneNodeFilterProxy(QObject *parent)
+    : QSortFilterProxyModel(parent)
+{
+}
+
+void SceneNodeFilterProxy::setSourceModel(QAbstractItemModel *model)
+{
+    // Only our own connections; the base class has its own to the same model
+    for (const QMetaObject::Connection &connection : m_sourceConnections)
+        disconnect(connection);
+    m_sourceConnections.clear();
+
+    m_foldedNames.clear();
+    m_indexValid = false;
+    m_matches.clear();
+    m_matchesValid = false;
+
+    QSortFilterProxyModel::setSourceModel(model);
+
+    if (!model)
+        return;
+    m_sourceConnections << connect(model, &QAbstractItemModel::rowsInserted, this, [this]() { onRowsChanged(); })
+                        << connect(model, &QAbstractItemModel::rowsRemoved, this, [this]() { onRowsChanged(); })
+                        << connect(model, &QAbstractItemModel::rowsMoved, this, [this]() { onRowsChanged(); })
+                        << connect(model, &QAbstractItemModel::modelReset, this, [this]() { onRowsChanged(); })
+                        << connect(model, &QAbstractItemModel::dataChanged, this, &SceneNodeFilterProxy::onNamesChanged);
+}
+
+QStandardItemModel *SceneNodeFilterProxy::itemModel() const
+{
+    return qobject_cast<QStandardItemModel *>(sourceModel());
+}
+
+void SceneNodeFilterProxy::setSearchText(const QString &text)
+{
+    const QString query = text.toCaseFolded();
+    if (query == m_query && m_indexValid)
+        return;
+
+    const bool incremental = m_matchesValid && !m_query.isEmpty() && query.contains(m_query);
+    m_query = query;
+
+    if (m_query.isEmpty()) {
+        m_matches.clear();
+        m_matchesValid = false;
+        m_accepted.clear();
+        m_ancestors.clear();
+        invalidateFilter();
+        return;
+    }
+
+    runSearch(incremental);
+}
+
+void SceneNodeFilterProxy::rebuildIndex()
+{
+    m_foldedNames.clear();
+    m_matches.clear();
+    m_matchesValid = false;
+    if (QStandardItemModel *model = itemModel())
+        indexRows(model->invisibleRootItem());
+    m_indexValid = true;
+}
+
+void SceneNodeFilterProxy::indexRows(const QStandardItem *parent)
+{
+    for (int row = 0; row < parent->rowCount(); ++row) {
+        const QStandardItem *child = parent->child(row);
+        if (!child)
+            continue;
+        m_foldedNames.insert(child, child->text().toCaseFolded());
+        if (child->hasChildren())
+            indexRows(child);
+    }
+}
+
+void SceneNodeFilterProxy::onRowsChanged()
+{
+    // Items may be gone; nothing keyed on them is trusted until the next rebuild
+    m_foldedNames.clear();
+    m_matches.clear();
+    m_matchesValid = false;
+    m_indexValid = false;
+    queueRefresh();
+}
+
+void SceneNodeFilterProxy::onNamesChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight,
+                                          const QList<int> &roles)
+{
+    if (!m_indexValid)
+        return;
+    // Node flags change with no roles listed, so an empty list is not enough
+    // on its own; compare the names instead.
+    if (!roles.isEmpty() && !roles.contains(Qt::DisplayRole) && !roles.contains(Qt::EditRole))
+        return;
+
+    QStandardItemModel *model = itemModel();
+    if (!model)
+        return;
+
+    bool renamed = false;
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const QStandardItem *item = model->itemFromIndex(model->index(row, 0, topLeft.parent()));
+        auto it = m_foldedNames.find(item);
+        if (it == m_foldedNames.end())
+            continue;
+        const QString folded = item->text().toCaseFolded();
+        if (*it != folded) {
+            *it = folded;
+            renamed = true;
+        }
+    }
+
+    if (renamed) {
+        // A rename can add or drop a match anywhere; the next pass tests everything
+        m_matches.clear();
+        m_matchesValid = false;
+        queueRefresh();
+    }
+}
+
+void SceneNodeFilterProxy::queueRefresh()
+{
+    if (m_query.isEmpty() || m_refreshQueued)
+        return;
+    // Once per burst of model changes, after the model has settled
+    m_refreshQueued = true;
+    QMetaObject::invokeMethod(
+        this,
+        [this]() {
+            m_refreshQueued = false;
+            if (!m_query.isEmpty())
+                runSearch(false);
+        },
+        Qt::QueuedConnection);
+}
+
+void SceneNodeFilterProxy::runSearch(bool incremental)
+{
+    if (!m_indexValid)
+        rebuildIndex();
+    if (!m_matchesValid)
+        incremental = false;
+
+    const bool wildcard = m_query.contains(QLatin1Char('*')) || m_query.contains(QLatin1Char('?'));
+    QList<const QStandardItem *> matches;
+
+    if (wildcard) {
+        const QRegularExpression pattern(
+            QRegularExpression::wildcardToRegularExpression(m_query, QRegularExpression::UnanchoredWildcardConversion));
+        for (auto it = m_foldedNames.cbegin(); it != m_foldedNames.cend(); ++it) {
+            if (pattern.match(it.value()).hasMatch())
+                matches.append(it.key());
+        }
+    } else if (incremental) {
+        // Anything containing the new query contains the old one too
+        for (const QStandardItem *item : m_matches) {
+            if (m_foldedNames.value(item).contains(m_query))
+                matches.append(item);
+        }
+    } else {
+        for (auto it = m_foldedNames.cbegin(); it != m_foldedNames.cend(); ++it) {
+            if (it.value().contains(m_query))
+                matches.append(it.key());
+        }
+    }
+
+    // A wildcard's matches are not a superset of a longer query's
+    m_matches = matches;
+    m_matchesValid = !wildcard;
+
+    m_accepted.clear();
+    m_ancestors.clear();
+    for (const QStandardItem *item : matches) {
+        m_accepted.insert(item);
+        for (const QStandardItem *parent = item->parent(); parent; parent = parent->parent()) {
+            if (m_ancestors.contains(parent))
+                break;
+            m_ancestors.insert(parent);
+            m_accepted.insert(parent);
+        }
+    }
+
+    invalidateFilter();
+}
+
+bool SceneNodeFilterProxy::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
+    if (index.data(HiddenSceneRole).toBool())
+        return false;
+    if (m_query.isEmpty())
+        return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+
+    const QStandardItemModel *model = itemModel();
+    return model && m_accepted.contains(model->itemFromIndex(index));
+}
+
+} // namespace SceneOrganiser
+} // namespace StreamUP
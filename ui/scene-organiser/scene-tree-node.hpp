@@ -0,0 +1,160 @@
+#pragma once
+
+#include <QColor>
+#include <QHash>
+#include <QIcon>
+#include <QSet>
+#include <QSortFilterProxyModel>
+#include <QStandardItem>
+#include <QStandardItemModel>
+
+namespace StreamUP {
+namespace SceneOrganiser {
+
+// Item roles used across the scene organiser. CreationTimestampRole is the
+// creation time that the newest/oldest sorts use. The colour, program and
+// hidden roles are node state: answered from fields on the item rather than
+// kept in its role map, since the delegate and drawRow read them for every
+// row on every paint.
+//
+// CustomColorRole holds the colour the user picked for a row, as a QColor, or
+// no value when the row has none. ProgramSceneRole marks the scene item that
+// is currently LIVE on program, painted by CustomColorDelegate as a green
+// "on air" indicator independent of the tree's normal (blue) selection.
+// HiddenSceneRole marks a scene the user hid from the locked dock;
+// SceneNodeFilterProxy leaves those rows out.
+constexpr int CustomColorRole = Qt::UserRole + 1;
+constexpr int ProgramSceneRole = Qt::UserRole + 2;
+constexpr int HiddenSceneRole = Qt::UserRole + 3;
+constexpr int CreationTimestampRole = Qt::UserRole + 100;
+
+// Item types, matching SceneFolderItem::type() and SceneTreeItem::type()
+constexpr int SceneFolderItemType = QStandardItem::UserType + 1;
+constexpr int SceneItemType = QStandardItem::UserType + 2;
+
+// Common base for folder and scene items. Carries the per-node flags as a
+// bitfield and works out its icon when asked, from the owning model's style,
+// instead of every item holding its own QIcon in its role map. Switching icons
+// on or off, or a theme change, is then one style change on the model rather
+// than a setIcon on every node of a 2,000-scene tree.
+class SceneNodeItem : public QStandardItem {
+public:
+    QVariant data(int role = CustomColorRole) const override;
+    void setData(const QVariant &value, int role = CustomColorRole) override;
+
+    bool isProgram() const { return m_program; }
+    bool isHiddenScene() const { return m_hidden; }
+
+    // The name as sorting compares it: case-folded once, after creation or a
+    // rename, instead of case-insensitively on every comparison
+    const QString &sortName() const;
+
+    // Orders by the owning model's sort spec, so sortChildren() follows it
+    bool operator<(const QStandardItem &other) const override;
+
+protected:
+    explicit SceneNodeItem(const QString &text);
+
+private:
+    mutable QString m_sortName;
+    QRgb m_color = 0;
+    quint8 m_hasColor : 1;
+    quint8 m_program : 1;
+    quint8 m_hidden : 1;
+    mutable quint8 m_sortNameValid : 1;
+};
+
+// Model side of the above: holds what every node reads at paint time.
+class SceneNodeModel : public QStandardItemModel {
+public:
+    struct NodeStyle {
+        bool showIcons = true;
+        QIcon folderIcon;
+        QIcon sceneIcon;
+    };
+
+    explicit SceneNodeModel(QObject *parent = nullptr);
+
+    // How the organiser's sort options order one folder's children
+    struct SortSpec {
+        enum class Key { None, Name, Created };
+        Key key = Key::None;
+        bool descending = false;
+        bool foldersFirst = false;
+    };
+
+    const NodeStyle &nodeStyle() const { return m_nodeStyle; }
+
+    // Swap the style and tell views the decoration changed. One dataChanged
+    // per parent row range; no item is written to.
+    void setNodeStyle(const NodeStyle &style);
+
+    const SortSpec &sortSpec() const { return m_sortSpec; }
+    void setSortSpec(const SortSpec &spec) { m_sortSpec = spec; }
+
+    // Whether `a` goes before `b` under the sort spec. Ties keep their order.
+    bool lessThan(const QStandardItem *a, const QStandardItem *b) const;
+
+    // Sort `parent` and the folders below it by the sort spec. A folder whose
+    // children are already in order is checked in one pass and left alone,
+    // so a refresh that changes nothing moves nothing. Returns whether any
+    // rows moved.
+    bool sortTree(QStandardItem *parent);
+
+private:
+    void emitDecorationChanged(const QModelIndex &parent);
+    bool isInOrder(const QStandardItem *parent) const;
+
+    NodeStyle m_nodeStyle;
+    SortSpec m_sortSpec;
+};
+
+// Search proxy that also leaves out scenes flagged hidden. The flag changes
+// through setData, so the proxy re-filters just that row as it flips instead
+// of the dock walking the view with setRowHidden and invalidating everything.
+//
+// Search runs against a case-folded copy of every node's name, built when a
+// search starts and kept current as rows and names change. A query that
+// contains the previous one only re-tests the previous matches. The matches
+// and their ancestors are kept as a set, so filterAcceptsRow is a lookup and
+// rows under a folder with no matches are never visited; leave recursive
+// filtering off. A query with * or ? is matched as a wildcard, as before.
+class SceneNodeFilterProxy : public QSortFilterProxyModel {
+public:
+    explicit SceneNodeFilterProxy(QObject *parent = nullptr);
+
+    void setSourceModel(QAbstractItemModel *model) override;
+
+    void setSearchText(const QString &text);
+    bool isSearchActive() const { return !m_query.isEmpty(); }
+
+    // Folders with a match somewhere below them; the dock expands just these
+    const QSet<const QStandardItem *> &searchAncestors() const { return m_ancestors; }
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    QStandardItemModel *itemModel() const;
+    void rebuildIndex();
+    void indexRows(const QStandardItem *parent);
+    void onRowsChanged();
+    void onNamesChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+    void queueRefresh();
+    void runSearch(bool incremental);
+
+    QList<QMetaObject::Connection> m_sourceConnections;
+
+    QHash<const QStandardItem *, QString> m_foldedNames;
+    bool m_indexValid = false;
+    bool m_refreshQueued = false;
+
+    QString m_query; // case-folded
+    QList<const QStandardItem *> m_matches;
+    bool m_matchesValid = false; // m_matches is every match of m_query
+    QSet<const QStandardItem *> m_accepted; // matches and their ancestors
+    QSet<const QStandardItem *> m_ancestors;
+};
+
+} // namespace SceneOrganiser
+} // namespace StreamUP
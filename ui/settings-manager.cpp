@@ -5,6 +5,7 @@
 #include <streamup/ui/section-card.hpp>
 #include <algorithm>
 #include <streamup/debug-logger.hpp>
+#include <streamup/trace.hpp>
 #include "../utilities/path-utils.hpp"
 #include "ui-helpers.hpp"
 #include <streamup/ui/window-chrome.hpp> // ShadowDialog, RoundedContainer, makeWindow, WindowShell
@@ -17,6 +18,7 @@
 #include <streamup/ui/dialogs.hpp>       // confirm, info, prompt
 #include "../version.h"                  // PROJECT_VERSION
 #include "../utilities/obs-data-helpers.hpp"
+#include "../utilities/write-behind.hpp"
 #include "plugin-manager.hpp"
 #include "plugin-state.hpp"
 #include "hotkey-manager.hpp"
@@ -56,10 +58,13 @@
 #include <QMessageBox>
 #include <QDir>
 #include <QFileInfo>
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <algorithm>
 #include <functional>
+#include <string>
 #include <vector>
 #include <util/platform.h>
 
@@ -178,6 +183,59 @@ static obs_data_t* cachedSettings = nullptr;
 static bool settingsLoadLogged = false;
 static std::mutex settingsCacheMutex; // Thread safety for settings cache
 
+// Parsed PluginSettings, rebuilt only when configs.json is saved. Readers take
+// a reference with std::atomic_load and never touch the mutex or obs_data, so
+// source callbacks and other threads can read settings while the UI saves.
+// Publishing happens with settingsCacheMutex held.
+static std::shared_ptr<const PluginSettings> settingsSnapshot;
+
+// Mirrors of hot flags from the last published snapshot, for per-call checks
+static std::atomic<bool> debugLoggingFlag{false};
+static std::atomic<bool> debugLoggingFlagKnown{false};
+
+static void PublishSnapshotLocked(obs_data_t *data);
+
+// Write-behind for configs.json. SaveSettings() serialises on the calling
+// thread (callers keep mutating the cached obs_data, so the worker must not
+// read it) and hands the text to one worker, which lets a burst of saves
+// settle and writes only the newest through a temporary file and a rename.
+static constexpr auto kSettingsSettleDelay = std::chrono::milliseconds(300);
+static std::string pendingPath; // guarded by settingsWriter
+static std::string pendingJson;
+
+static bool WriteSettingsFile(const std::string &path, const std::string &json)
+{
+	if (os_quick_write_utf8_file_safe(path.c_str(), json.c_str(), json.size(), false, "tmp", nullptr))
+		return true;
+	StreamUP::DebugLogger::LogWarning("Settings", "Failed to save settings to file");
+	return false;
+}
+
+// Let a burst of toggles or toolbar drags settle, then write only the newest
+static StreamUP::WriteBehind settingsWriter(kSettingsSettleDelay, [] {
+	auto path = std::make_shared<std::string>();
+	auto json = std::make_shared<std::string>();
+	path->swap(pendingPath);
+	json->swap(pendingJson);
+	return StreamUP::WriteBehind::Work([path, json] { WriteSettingsFile(*path, *json); });
+});
+
+// Queues `json` as the whole of configs.json, replacing a write still waiting
+static bool QueueSettingsWrite(const char *path, const char *json)
+{
+	if (!path || !json)
+		return false;
+
+	if (settingsWriter.Queue([path, json] {
+		    pendingPath = path;
+		    pendingJson = json;
+	    }))
+		return true;
+
+	// After StopSettingsWriter(): shutdown saves go straight to disk
+	return WriteSettingsFile(path, json);
+}
+
 // Helper function to extract domain from URL
 QString ExtractDomain(const QString &url)
 {
@@ -392,6 +450,10 @@ obs_data_t *LoadSettings()
 		return cachedSettings;
 	}
 
+	// The file can lag the last save by the settle delay, so let it catch up
+	// before reading it back
+	FlushSettings();
+
 	char *configPath = StreamUP::PathUtils::GetOBSConfigPath("configs.json");
 	obs_data_t *data = obs_data_create_from_json_file(configPath);
 
@@ -439,7 +501,7 @@ obs_data_t *LoadSettings()
 		obs_data_set_obj(data, "dock_tools", dockData);
 		obs_data_release(dockData);
 
-		if (obs_data_save_json(data, configPath)) {
+		if (QueueSettingsWrite(configPath, obs_data_get_json(data))) {
 		} else {
 			StreamUP::DebugLogger::LogWarning("Settings", "Failed to save default settings to file");
 		}
@@ -465,14 +527,20 @@ bool SaveSettings(obs_data_t *settings)
 	char *configPath = StreamUP::PathUtils::GetOBSConfigPath("configs.json");
 	bool success = false;
 
-	if (obs_data_save_json(settings, configPath)) {
+	if (settings && QueueSettingsWrite(configPath, obs_data_get_json(settings))) {
 		success = true;
 
-		// Invalidate cache so next load picks up the updated settings
-		if (cachedSettings) {
-			obs_data_release(cachedSettings);
-			cachedSettings = nullptr;
+		// Cache what was saved rather than dropping the cache: the file is
+		// written behind, so reloading it now could read the previous settings
+		if (cachedSettings != settings) {
+			obs_data_addref(settings);
+			if (cachedSettings)
+				obs_data_release(cachedSettings);
+			cachedSettings = settings;
 		}
+
+		// What was saved is what readers see from now on
+		PublishSnapshotLocked(settings);
 	} else {
 		StreamUP::DebugLogger::LogWarning("Settings", "Failed to save settings to file");
 	}
@@ -481,10 +549,9 @@ bool SaveSettings(obs_data_t *settings)
 	return success;
 }
 
-PluginSettings GetCurrentSettings()
+static PluginSettings ParseSettings(obs_data_t *data)
 {
 	PluginSettings settings;
-	obs_data_t *data = LoadSettings();
 
 	if (data) {
 		settings.runAtStartup = StreamUP::OBSDataHelpers::GetBoolWithDefault(data, "run_at_startup", true);
@@ -612,6 +679,8 @@ PluginSettings GetCurrentSettings()
 		settings.backupLocation = backupDir ? backupDir : "";
 		const char *lastAuto = StreamUP::OBSDataHelpers::GetStringWithDefault(data, "backup_last_auto", "");
 		settings.backupLastAutoDate = lastAuto ? lastAuto : "";
+		const char *pendingVerify = StreamUP::OBSDataHelpers::GetStringWithDefault(data, "backup_pending_verify", "");
+		settings.backupPendingVerify = pendingVerify ? pendingVerify : "";
 
 		// Load module enable/disable settings
 		LoadModuleSettings(data, settings.modules);
@@ -633,13 +702,47 @@ PluginSettings GetCurrentSettings()
 			obs_data_release(dockData);
 		} else {
 		}
-
-		obs_data_release(data);
 	}
 
 	return settings;
 }
 
+// Called with settingsCacheMutex held
+static void PublishSnapshotLocked(obs_data_t *data)
+{
+	std::shared_ptr<const PluginSettings> snapshot = std::make_shared<const PluginSettings>(ParseSettings(data));
+	debugLoggingFlag.store(snapshot->debugLoggingEnabled, std::memory_order_relaxed);
+	StreamUP::DebugLogger::SetDebugLoggingEnabled(snapshot->debugLoggingEnabled);
+	debugLoggingFlagKnown.store(true, std::memory_order_release);
+	std::atomic_store(&settingsSnapshot, std::move(snapshot));
+}
+
+std::shared_ptr<const PluginSettings> GetSettingsSnapshot()
+{
+	std::shared_ptr<const PluginSettings> snapshot = std::atomic_load(&settingsSnapshot);
+	if (snapshot)
+		return snapshot;
+
+	obs_data_t *data = LoadSettings();
+	{
+		std::lock_guard<std::mutex> lock(settingsCacheMutex);
+		// A save may have published newer settings while we were loading
+		snapshot = std::atomic_load(&settingsSnapshot);
+		if (!snapshot) {
+			PublishSnapshotLocked(data);
+			snapshot = std::atomic_load(&settingsSnapshot);
+		}
+	}
+	if (data)
+		obs_data_release(data);
+	return snapshot;
+}
+
+PluginSettings GetCurrentSettings()
+{
+	return *GetSettingsSnapshot();
+}
+
 void UpdateSettings(const PluginSettings &settings)
 {
 	// Load existing settings to preserve fields not in PluginSettings struct (like toolbar_configuration)
@@ -756,6 +859,7 @@ void UpdateSettings(const PluginSettings &settings)
 	obs_data_set_int(data, "backup_keep_count", settings.backupKeepCount);
 	obs_data_set_string(data, "backup_location", settings.backupLocation.c_str());
 	obs_data_set_string(data, "backup_last_auto", settings.backupLastAutoDate.c_str());
+	obs_data_set_string(data, "backup_pending_verify", settings.backupPendingVerify.c_str());
 
 	// Save dock tool settings
 	obs_data_t *dockData = obs_data_create();
@@ -1100,6 +1204,38 @@ void ShowSettingsDialog(int tabIndex)
 		debugLoggingLayout->addWidget(debugLoggingSwitch);
 		generalLayout->addLayout(debugLoggingLayout);
 
+		// Trace export, only in builds that record spans
+		if (StreamUP::Trace::IsCompiledIn()) {
+			QHBoxLayout *traceLayout = new QHBoxLayout();
+
+			QLabel *traceLabel = new QLabel(obs_module_text("Settings.Debug.Trace"));
+			traceLabel->setStyleSheet(StreamUP::UIStyles::scale_qss(QString("color: %1; font-size: %2px; background: transparent;")
+							  .arg(StreamUP::UIStyles::Colors::TEXT_PRIMARY)
+							  .arg(StreamUP::UIStyles::Sizes::FONT_SIZE_NORMAL)));
+			traceLabel->setToolTip(obs_module_text("Settings.Debug.TraceTooltip"));
+
+			QPushButton *traceButton =
+				new StreamUP::UIStyles::PillButton(obs_module_text("Settings.Debug.TraceExport"), "neutral");
+			traceButton->setToolTip(obs_module_text("Settings.Debug.TraceTooltip"));
+
+			QObject::connect(traceButton, &QPushButton::clicked, [dialog]() {
+				const QString path = QFileDialog::getSaveFileName(
+					dialog, obs_module_text("Settings.Debug.TraceExport"),
+					QDir::home().filePath(QStringLiteral("streamup-trace.json")),
+					QStringLiteral("Trace JSON (*.json)"));
+				if (path.isEmpty())
+					return;
+				if (!StreamUP::Trace::WriteChromeJson(path.toStdString()))
+					su::info(dialog, obs_module_text("Settings.Debug.TraceExport"),
+						 obs_module_text("Settings.Debug.TraceFailed"));
+			});
+
+			traceLayout->addWidget(traceLabel);
+			traceLayout->addStretch();
+			traceLayout->addWidget(traceButton);
+			generalLayout->addLayout(traceLayout);
+		}
+
 		generalContentLayout->addWidget(generalSettingsWidget);
 		generalContentLayout->addStretch();
 		
@@ -3578,8 +3714,11 @@ void ShowDockConfigInline(const StreamUP::UIStyles::StandardDialogComponents &co
 
 bool IsDebugLoggingEnabled()
 {
-	PluginSettings settings = GetCurrentSettings();
-	return settings.debugLoggingEnabled;
+	// Checked before every debug log line, so read the mirrored flag rather
+	// than copying the whole settings struct
+	if (!debugLoggingFlagKnown.load(std::memory_order_acquire))
+		GetSettingsSnapshot();
+	return debugLoggingFlag.load(std::memory_order_relaxed);
 }
 
 void SetDebugLoggingEnabled(bool enabled)
@@ -3596,16 +3735,33 @@ void InvalidateSettingsCache()
 		obs_data_release(cachedSettings);
 		cachedSettings = nullptr;
 	}
+	// Rebuilt from disk by the next reader; the hot flags keep their last value until then
+	std::atomic_store(&settingsSnapshot, std::shared_ptr<const PluginSettings>());
+}
+
+void FlushSettings()
+{
+	settingsWriter.Flush();
+}
+
+void StopSettingsWriter()
+{
+	settingsWriter.Stop();
 }
 
 void CleanupSettingsCache()
 {
+	// Normally already stopped at frontend exit; this covers an unload without one
+	StopSettingsWriter();
+
 	std::lock_guard<std::mutex> lock(settingsCacheMutex);
 	// Release cached settings on plugin shutdown
 	if (cachedSettings) {
 		obs_data_release(cachedSettings);
 		cachedSettings = nullptr;
 	}
+	std::atomic_store(&settingsSnapshot, std::shared_ptr<const PluginSettings>());
+	debugLoggingFlagKnown.store(false, std::memory_order_release);
 	settingsLoadLogged = false;
 }
 
@@ -2,6 +2,7 @@
 
 #include <obs-data.h>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -185,11 +186,12 @@ struct PluginSettings {
     int backupKeepCount;              // how many automatic backups to keep
     std::string backupLocation;       // override folder, empty = default
     std::string backupLastAutoDate;   // yyyy-MM-dd of the last automatic backup
+    std::string backupPendingVerify;  // automatic backup still waiting for its deep verify, empty = none
     ModuleSettings modules;
     bool moduleSetupComplete;       // Legacy wizard sentinel (kept for compat)
     std::string wizardVersionShown; // PROJECT_VERSION when the wizard last ran. Drives the upgrader prompt.
 
-    PluginSettings() : runAtStartup(true), notificationsMute(false), showCPHIntegration(true), showToolbar(true), debugLoggingEnabled(false), sceneOrganiserShowIcons(true), sceneOrganiserGroupFolders(true), sceneOrganiserRememberFolderState(true), sceneOrganiserDisablePreviewSwitchingInStudioMode(false), sceneOrganiserDisableTransitionInStudioMode(false), sceneOrganiserSwitchToNewScene(false), sceneOrganiserItemHeight(24), sceneOrganiserSwitchMode(SceneSwitchMode::SingleClick), sceneOrganiserSortMethod(SceneSortMethod::None), toolbarPosition(ToolbarPosition::Top), toolbarSize(ToolbarSize::Medium), toolbarAlignment(ToolbarAlignment::Start), backupAutomatic(true), backupKeepCount(10), backupLocation(), backupLastAutoDate(), moduleSetupComplete(false), wizardVersionShown() {}
+    PluginSettings() : runAtStartup(true), notificationsMute(false), showCPHIntegration(true), showToolbar(true), debugLoggingEnabled(false), sceneOrganiserShowIcons(true), sceneOrganiserGroupFolders(true), sceneOrganiserRememberFolderState(true), sceneOrganiserDisablePreviewSwitchingInStudioMode(false), sceneOrganiserDisableTransitionInStudioMode(false), sceneOrganiserSwitchToNewScene(false), sceneOrganiserItemHeight(24), sceneOrganiserSwitchMode(SceneSwitchMode::SingleClick), sceneOrganiserSortMethod(SceneSortMethod::None), toolbarPosition(ToolbarPosition::Top), toolbarSize(ToolbarSize::Medium), toolbarAlignment(ToolbarAlignment::Start), backupAutomatic(true), backupKeepCount(10), backupLocation(), backupLastAutoDate(), backupPendingVerify(), moduleSetupComplete(false), wizardVersionShown() {}
 };
 
 /**
@@ -200,17 +202,43 @@ obs_data_t* LoadSettings();
 
 /**
  * @brief Save settings to configuration file
+ *
+ * The settings are serialised and cached straight away; the file itself is
+ * written on a background thread once a burst of saves has settled, through a
+ * temporary file and a rename. Use FlushSettings() where it must be on disk.
  * @param settings The settings data to save
- * @return bool True if save was successful, false otherwise
+ * @return bool True if the save was queued, false otherwise
  */
 bool SaveSettings(obs_data_t* settings);
 
+/**
+ * @brief Block until every queued settings save has been written to disk
+ */
+void FlushSettings();
+
+/**
+ * @brief Flush queued settings saves and stop the writer thread
+ *
+ * Saves made afterwards are written synchronously. Called at frontend exit.
+ */
+void StopSettingsWriter();
+
 /**
  * @brief Get current plugin settings as a structure
- * @return PluginSettings Current settings values
+ * @return PluginSettings Copy of the current settings snapshot
  */
 PluginSettings GetCurrentSettings();
 
+/**
+ * @brief Get the current settings snapshot without copying it
+ *
+ * The snapshot is immutable and rebuilt only when settings are saved, so
+ * holding on to it is safe from any thread. Prefer this over
+ * GetCurrentSettings() on paths that only read a field or two.
+ * @return std::shared_ptr<const PluginSettings> Never null
+ */
+std::shared_ptr<const PluginSettings> GetSettingsSnapshot();
+
 /**
  * @brief Update plugin settings from structure
  * @param settings The new settings to apply
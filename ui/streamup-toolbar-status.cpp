@@ -1,6 +1,8 @@
 #include "streamup-toolbar-status.hpp"
 #include "../streamup.hpp"
 #include "ui-helpers.hpp"
+#include "../core/stream-health.hpp"
+#include <streamup/trace.hpp>
 
 #include <obs-module.h>
 
@@ -11,7 +13,9 @@
 #include <QEvent>
 #include <QIcon>
 #include <QFontMetrics>
+#include <QHelpEvent>
 #include <QStyle>
+#include <QToolTip>
 
 namespace StreamUP {
 namespace ToolbarStatus {
@@ -21,13 +25,18 @@ namespace {
 // OBS's status bar runs at 1Hz and that is plenty for all of these.
 constexpr int kTickMs = 1000;
 
+// With no item on screen (all hidden, or the window minimised), just often
+// enough to keep the readings and the overload check roughly current.
+constexpr int kHiddenTickMs = 5000;
+
 // A message stays up for this long and then clears itself, the same way OBS's
 // own transient messages do.
 constexpr qint64 kMessageHoldMs = 8000;
 
 // Overload is judged over a window rather than a single tick, so one bad second
-// during a scene change does not light the warning.
-constexpr int kOverloadWindowTicks = 5;
+// during a scene change does not light the warning. Measured in time rather
+// than ticks, since the tick slows down while nothing is on screen.
+constexpr qint64 kOverloadWindowMs = 5000;
 constexpr double kOverloadSkipRatio = 0.05;
 
 QString moduleText(const char *key)
@@ -252,14 +261,50 @@ Monitor::~Monitor()
 		os_cpu_usage_info_destroy(cpuInfo_);
 }
 
-void Monitor::addObserver()
+int Monitor::totalObservers() const
+{
+	int total = 0;
+	for (int count : kindObservers_)
+		total += count;
+	return total;
+}
+
+void Monitor::updateTimer()
 {
-	if (++observers_ > 1)
+	if (exited_ || totalObservers() == 0) {
+		timer_.stop();
 		return;
+	}
+
+	const int interval = visibleObservers_ > 0 ? kTickMs : kHiddenTickMs;
+	if (timer_.interval() != interval)
+		timer_.setInterval(interval);
+	if (!timer_.isActive())
+		timer_.start();
+}
 
-	if (!cpuInfo_)
+void Monitor::addObserver(Kind kind)
+{
+	const int index = static_cast<int>(kind);
+	const bool firstOfKind = kindObservers_[index]++ == 0;
+	// The new item draws itself, so the next change is measured from here
+	published_[index] = false;
+
+	// Counted so the destructor's removeObserver balances, but nothing else
+	if (exited_)
+		return;
+
+	if (kind == Kind::Cpu && !cpuInfo_)
 		cpuInfo_ = os_cpu_usage_info_start();
 
+	if (totalObservers() > 1) {
+		// A kind nobody was showing has not been sampled; read it now rather
+		// than showing a stale value until the next tick.
+		if (firstOfKind && ObsFinishedLoading())
+			tick();
+		return;
+	}
+
 	// Registering a frontend callback during module load is the supported
 	// pattern and is safe. Asking the frontend anything is not: the toolbar is
 	// built from inside obs_init_module, where the frontend API does not exist
@@ -269,7 +314,7 @@ void Monitor::addObserver()
 		eventCallbackAdded_ = true;
 	}
 
-	timer_.start();
+	updateTimer();
 
 	// A status item created after startup has already missed FINISHED_LOADING,
 	// so it catches up here instead of waiting for an event that has been and
@@ -278,19 +323,40 @@ void Monitor::addObserver()
 		syncToRunningOutputs();
 }
 
-void Monitor::removeObserver()
+void Monitor::removeObserver(Kind kind)
 {
-	if (observers_ > 0)
-		--observers_;
-	if (observers_ > 0)
-		return;
-
-	timer_.stop();
+	const int index = static_cast<int>(kind);
+	if (kindObservers_[index] > 0)
+		--kindObservers_[index];
 
+	// A counter that stops being sampled starts again from a clean reading.
 	// The CPU query is kept: destroying and restarting it loses the baseline
 	// it needs, so the first reading after re-adding an item would be wrong.
-	streamRate_.reset();
-	recordRate_.reset();
+	if (!observed(Kind::StreamBitrate))
+		streamRate_.reset();
+	if (!observed(Kind::RecordBitrate))
+		recordRate_.reset();
+	if (!observed(Kind::Message))
+		windowStartMs_ = 0;
+
+	updateTimer();
+}
+
+void Monitor::observerShown()
+{
+	const bool wasHidden = visibleObservers_++ == 0;
+	updateTimer();
+
+	// Whatever is coming back on screen may be up to a slow tick out of date
+	if (wasHidden && ObsFinishedLoading())
+		tick();
+}
+
+void Monitor::observerHidden()
+{
+	if (visibleObservers_ > 0)
+		--visibleObservers_;
+	updateTimer();
 }
 
 void Monitor::OnFrontendEvent(enum obs_frontend_event event, void *data)
@@ -330,7 +396,7 @@ void Monitor::handleFrontendEvent(enum obs_frontend_event event)
 		streamRate_.reset();
 		// The overload window starts fresh with the stream, since skipped
 		// frames from before it began say nothing about it.
-		windowTicks_ = 0;
+		windowStartMs_ = 0;
 		overloaded_ = false;
 		setMessage(MessageId::StreamingStarted);
 		break;
@@ -347,6 +413,7 @@ void Monitor::handleFrontendEvent(enum obs_frontend_event event)
 		// shut-down frontend. Everything that talks to OBS is released here
 		// instead, while there is still an OBS to release it to. Removing a
 		// callback from inside its own dispatch is supported.
+		exited_ = true;
 		timer_.stop();
 		obs_frontend_remove_event_callback(OnFrontendEvent, this);
 		eventCallbackAdded_ = false;
@@ -359,7 +426,7 @@ void Monitor::handleFrontendEvent(enum obs_frontend_event event)
 		return;
 	}
 
-	emit updated();
+	publishChanges();
 }
 
 void Monitor::setMessage(MessageId id)
@@ -385,42 +452,62 @@ void Monitor::syncToRunningOutputs()
 
 void Monitor::tick()
 {
+	STREAMUP_TRACE_SCOPE("ToolbarStatus::Monitor::tick");
+
 	// The timer cannot fire before the Qt event loop runs, but OBS pumps events
 	// during startup, so this is not a guarantee on its own.
-	if (!ObsFinishedLoading())
+	if (!ObsFinishedLoading() || exited_)
 		return;
 
 	const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
 
-	if (cpuInfo_)
+	// Only what some item on the bar shows. The clocks need no sampling: they
+	// are worked out from their own timers when read.
+	if (observed(Kind::Cpu) && cpuInfo_)
 		cpuPercent_ = os_cpu_usage_info_query(cpuInfo_);
 
-	fps_ = obs_get_active_fps();
-	laggedFrames_ = obs_get_lagged_frames();
-	totalFrames_ = obs_get_total_frames();
+	if (observed(Kind::Fps))
+		fps_ = obs_get_active_fps();
 
-	if (video_t *video = obs_get_video()) {
-		skippedFrames_ = video_output_get_skipped_frames(video);
-		encodedFrames_ = video_output_get_total_frames(video);
+	if (observed(Kind::FramesDropped)) {
+		laggedFrames_ = obs_get_lagged_frames();
+		totalFrames_ = obs_get_total_frames();
 	}
 
-	if (obs_output_t *output = obs_frontend_get_streaming_output()) {
-		streamRate_.feed(obs_output_get_total_bytes(output), nowMs);
-		obs_output_release(output);
-	} else {
-		streamRate_.reset();
+	if (observed(Kind::StreamBitrate)) {
+		if (obs_output_t *output = obs_frontend_get_streaming_output()) {
+			streamRate_.feed(obs_output_get_total_bytes(output), nowMs);
+			obs_output_release(output);
+		} else {
+			streamRate_.reset();
+		}
 	}
 
-	if (obs_output_t *output = obs_frontend_get_recording_output()) {
-		recordRate_.feed(obs_output_get_total_bytes(output), nowMs);
-		obs_output_release(output);
-	} else {
-		recordRate_.reset();
+	if (observed(Kind::RecordBitrate)) {
+		if (obs_output_t *output = obs_frontend_get_recording_output()) {
+			recordRate_.feed(obs_output_get_total_bytes(output), nowMs);
+			obs_output_release(output);
+		} else {
+			recordRate_.reset();
+		}
+	}
+
+	// The overload warning is only ever shown by the message item
+	if (observed(Kind::Message)) {
+		if (video_t *video = obs_get_video()) {
+			skippedFrames_ = video_output_get_skipped_frames(video);
+			encodedFrames_ = video_output_get_total_frames(video);
+		}
+		if (windowStartMs_ == 0) {
+			skippedAtWindowStart_ = skippedFrames_;
+			encodedAtWindowStart_ = encodedFrames_;
+			windowStartMs_ = nowMs;
+		}
 	}
 
 	// Encoding overload, judged the way OBS judges it: the share of frames the
 	// encoder could not keep up with over a window, not since OBS started.
-	if (++windowTicks_ >= kOverloadWindowTicks) {
+	if (windowStartMs_ != 0 && nowMs - windowStartMs_ >= kOverloadWindowMs) {
 		const uint32_t skipped = skippedFrames_ >= skippedAtWindowStart_
 						 ? skippedFrames_ - skippedAtWindowStart_
 						 : 0;
@@ -439,13 +526,69 @@ void Monitor::tick()
 		overloaded_ = nowOverloaded;
 		skippedAtWindowStart_ = skippedFrames_;
 		encodedAtWindowStart_ = encodedFrames_;
-		windowTicks_ = 0;
+		windowStartMs_ = nowMs;
 	}
 
 	if (message_ != MessageId::None && messageAge_.isValid() && messageAge_.elapsed() > kMessageHoldMs)
 		message_ = MessageId::None;
 
-	emit updated();
+	publishChanges();
+	emit sampled();
+}
+
+// Everything any form of the reading depends on, at the precision the widest
+// form shows it, plus the alerting state. Equal keys mean every item of that
+// kind would draw exactly what it already shows.
+quint64 Monitor::displayKey(Kind kind) const
+{
+	quint64 key = 0;
+	switch (kind) {
+	case Kind::Cpu:
+		key = static_cast<quint64>(qRound64(cpuPercent_ * 10.0));
+		break;
+	case Kind::Fps:
+		key = static_cast<quint64>(qRound64(fps_ * 100.0));
+		break;
+	case Kind::FramesDropped: {
+		const uint32_t lagged = laggedFrames_ >= laggedBaseline_ ? laggedFrames_ - laggedBaseline_ : 0;
+		const uint32_t total = totalFrames_ >= totalBaseline_ ? totalFrames_ - totalBaseline_ : 0;
+		const quint64 permille =
+			total > 0 ? static_cast<quint64>(qRound64((static_cast<double>(lagged) / total) * 1000.0)) : 0;
+		key = (static_cast<quint64>(lagged) << 16) | permille;
+		break;
+	}
+	case Kind::RecordTime:
+		key = static_cast<quint64>(recordTime_.ms() / 1000);
+		break;
+	case Kind::StreamTime:
+		key = static_cast<quint64>(streamTime_.ms() / 1000);
+		break;
+	case Kind::StreamBitrate:
+		key = static_cast<quint64>(streamRate_.kbps);
+		break;
+	case Kind::RecordBitrate:
+		key = static_cast<quint64>(recordRate_.kbps);
+		break;
+	case Kind::Message:
+		key = static_cast<quint64>(message_);
+		break;
+	}
+	return (key << 1) | (isAlerting(kind) ? 1 : 0);
+}
+
+void Monitor::publishChanges()
+{
+	for (int index = 0; index < kKindCount; ++index) {
+		if (kindObservers_[index] == 0)
+			continue;
+		const Kind kind = static_cast<Kind>(index);
+		const quint64 key = displayKey(kind);
+		if (published_[index] && publishedKeys_[index] == key)
+			continue;
+		published_[index] = true;
+		publishedKeys_[index] = key;
+		emit updated(kind);
+	}
 }
 
 QString Monitor::durationText(qint64 ms, bool showHours) const
@@ -530,6 +673,29 @@ QString Monitor::text(Kind kind, bool compact, bool showHours) const
 	return QString();
 }
 
+double Monitor::value(Kind kind) const
+{
+	switch (kind) {
+	case Kind::Cpu:
+		return cpuPercent_;
+	case Kind::Fps:
+		return fps_;
+	case Kind::FramesDropped:
+		return laggedFrames_ >= laggedBaseline_ ? laggedFrames_ - laggedBaseline_ : 0;
+	case Kind::RecordTime:
+		return static_cast<double>(recordTime_.ms());
+	case Kind::StreamTime:
+		return static_cast<double>(streamTime_.ms());
+	case Kind::StreamBitrate:
+		return streamRate_.kbps;
+	case Kind::RecordBitrate:
+		return recordRate_.kbps;
+	case Kind::Message:
+		break;
+	}
+	return 0.0;
+}
+
 QString Monitor::widestText(Kind kind, bool compact, bool showHours) const
 {
 	switch (kind) {
@@ -587,7 +753,7 @@ void Monitor::resetCounters(Kind kind)
 		return;
 	}
 
-	emit updated();
+	publishChanges();
 }
 
 bool Monitor::isAlerting(Kind kind) const
@@ -629,6 +795,37 @@ constexpr int kItemMarginVerticalPx = 3;
 // number rather than dwarfing it.
 constexpr int kIconPx = 14;
 
+// The readouts StreamHealth keeps a history of. Missed frames is rendering
+// lag, the same counter the readout itself shows.
+bool healthMetricFor(Kind kind, StreamHealth::Metric &out)
+{
+	switch (kind) {
+	case Kind::Cpu:
+		out = StreamHealth::Metric::Cpu;
+		return true;
+	case Kind::FramesDropped:
+		out = StreamHealth::Metric::RenderLagged;
+		return true;
+	case Kind::StreamBitrate:
+		out = StreamHealth::Metric::StreamBitrate;
+		return true;
+	default:
+		return false;
+	}
+}
+
+QString healthValueText(Kind kind, double value)
+{
+	switch (kind) {
+	case Kind::Cpu:
+		return QStringLiteral("%1%").arg(value, 0, 'f', 1);
+	case Kind::StreamBitrate:
+		return QStringLiteral("%1 kb/s").arg(value, 0, 'f', 0);
+	default:
+		return QStringLiteral("%1/s").arg(value, 0, 'f', 1);
+	}
+}
+
 } // namespace
 
 StatusWidget::StatusWidget(Kind kind, bool vertical, bool showIcon, bool showHours, bool preview, QWidget *parent)
@@ -647,7 +844,7 @@ StatusWidget::StatusWidget(Kind kind, bool vertical, bool showIcon, bool showHou
 	setFocusPolicy(Qt::NoFocus);
 
 	// With an icon instead of a word, this is the only thing that says what
-	// the number is.
+	// the number is. Shown through event(), which adds any history.
 	setToolTip(kindDisplayName(kind));
 
 	// Stacked when the bar runs down the side, in a row when it runs across.
@@ -681,8 +878,11 @@ StatusWidget::StatusWidget(Kind kind, bool vertical, bool showIcon, bool showHou
 	value_->setAttribute(Qt::WA_TransparentForMouseEvents);
 	layout->addWidget(value_, 0, vertical_ ? Qt::AlignCenter : Qt::AlignVCenter);
 
-	Monitor::instance().addObserver();
-	connect(&Monitor::instance(), &Monitor::updated, this, &StatusWidget::refresh);
+	Monitor::instance().addObserver(kind_);
+	connect(&Monitor::instance(), &Monitor::updated, this, [this](Kind changed) {
+		if (changed == kind_)
+			refresh();
+	});
 
 	applyPinnedSize();
 	refresh();
@@ -690,7 +890,9 @@ StatusWidget::StatusWidget(Kind kind, bool vertical, bool showIcon, bool showHou
 
 StatusWidget::~StatusWidget()
 {
-	Monitor::instance().removeObserver();
+	if (onScreen_)
+		Monitor::instance().observerHidden();
+	Monitor::instance().removeObserver(kind_);
 }
 
 void StatusWidget::showEvent(QShowEvent *event)
@@ -699,6 +901,22 @@ void StatusWidget::showEvent(QShowEvent *event)
 	// The theme's font is only certain once the widget has been polished, and
 	// the width is measured from it.
 	applyPinnedSize();
+
+	// Spontaneous show and hide events (the window being minimised and
+	// restored) arrive here too, which is what lets the Monitor slow down.
+	if (!onScreen_) {
+		onScreen_ = true;
+		Monitor::instance().observerShown();
+	}
+}
+
+void StatusWidget::hideEvent(QHideEvent *event)
+{
+	QWidget::hideEvent(event);
+	if (onScreen_) {
+		onScreen_ = false;
+		Monitor::instance().observerHidden();
+	}
 }
 
 void StatusWidget::changeEvent(QEvent *event)
@@ -763,6 +981,45 @@ void StatusWidget::contextMenuEvent(QContextMenuEvent *event)
 	event->accept();
 }
 
+bool StatusWidget::event(QEvent *event)
+{
+	if (event->type() != QEvent::ToolTip)
+		return QWidget::event(event);
+
+	QToolTip::showText(static_cast<QHelpEvent *>(event)->globalPos(), toolTipText(), this);
+	return true;
+}
+
+QString StatusWidget::toolTipText() const
+{
+	QString text = kindDisplayName(kind_);
+	StreamHealth::Metric metric;
+	if (!healthMetricFor(kind_, metric))
+		return text;
+
+	static const struct {
+		StreamHealth::Window window;
+		const char *label;
+	} windows[] = {{StreamHealth::Window::TenSeconds, "StreamUP.Toolbar.Status.Stats.10s"},
+		       {StreamHealth::Window::OneMinute, "StreamUP.Toolbar.Status.Stats.1m"},
+		       {StreamHealth::Window::FiveMinutes, "StreamUP.Toolbar.Status.Stats.5m"}};
+
+	// A window with nothing in it (the stream bitrate while offline) is left out
+	for (const auto &entry : windows) {
+		const StreamHealth::Stats stats = StreamHealth::Get(metric, entry.window);
+		if (stats.samples == 0)
+			continue;
+		const QString trend = healthValueText(kind_, stats.trendPerMinute);
+		text += QStringLiteral("\n") + moduleText("StreamUP.Toolbar.Status.Stats.Line")
+							.arg(moduleText(entry.label))
+							.arg(healthValueText(kind_, stats.min))
+							.arg(healthValueText(kind_, stats.mean))
+							.arg(healthValueText(kind_, stats.p95))
+							.arg(stats.trendPerMinute > 0 ? QStringLiteral("+") + trend : trend);
+	}
+	return text;
+}
+
 void StatusWidget::refresh()
 {
 	QString text = Monitor::instance().text(kind_, vertical_, showHours_);
@@ -774,7 +1031,11 @@ void StatusWidget::refresh()
 		text = moduleText(vertical_ ? "StreamUP.Toolbar.Status.Msg.RecordingStarted.Short"
 					    : "StreamUP.Toolbar.Status.Msg.RecordingStarted");
 
-	value_->setText(text);
+	// The Monitor only signals a change, but an item's own form (compact, or
+	// without hours) can read the same across it
+	const bool textChanged = text != value_->text();
+	if (textChanged)
+		value_->setText(text);
 
 	// Messages are transient. Every other readout always has a value, but this
 	// one is empty most of the time, and an icon sitting over nothing is dead
@@ -785,7 +1046,8 @@ void StatusWidget::refresh()
 
 	// Catches the value outgrowing its slot, which for a clock happens exactly
 	// once, when it passes an hour.
-	applyPinnedSize();
+	if (textChanged)
+		applyPinnedSize();
 
 	const bool alerting = Monitor::instance().isAlerting(kind_);
 	if (alerting == alerting_)
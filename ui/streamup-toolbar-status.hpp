@@ -10,7 +10,8 @@
 // the documentation says so.
 //
 // One Monitor serves every status item on the bar: one CPU query object, one
-// timer, one sample of each counter per tick. Items are views onto it.
+// timer, one sample of each counter per tick. Items are views onto it, and
+// only the counters some item actually shows are sampled.
 
 #include <QElapsedTimer>
 #include <QLabel>
@@ -59,23 +60,35 @@ bool kindIsDuration(Kind kind);
 // of what is happening now, so there is nothing held to clear.
 bool kindIsResettable(Kind kind);
 
-// Samples everything the status items show, once a second, for all of them.
+// Samples what the status items show, once a second, for all of them.
 class Monitor : public QObject {
 	Q_OBJECT
 
 public:
 	static Monitor &instance();
 
-	// Items call these so the timer and the CPU query only exist while
-	// something is actually on the bar to show them.
-	void addObserver();
-	void removeObserver();
+	// Items call these with their kind, so the timer only runs while something
+	// is on the bar and each counter is only read while an item shows it.
+	void addObserver(Kind kind);
+	void removeObserver(Kind kind);
+
+	// Items report being shown and hidden, which includes the window being
+	// minimised. With none on screen the timer slows right down: readings stay
+	// roughly current for when they come back, and an overload still raises
+	// its message, but nothing is redrawn every second for nobody.
+	void observerShown();
+	void observerHidden();
 
 	// The current reading, value only. What it is a reading of is carried by
 	// the icon beside it. compact is the side-docked form, which has to fit a
 	// bar only as wide as a button.
 	QString text(Kind kind, bool compact, bool showHours) const;
 
+	// The current reading as a number in the readout's own unit: percent,
+	// frames per second, frames, milliseconds or kb/s. Zero for the message,
+	// which only has text.
+	double value(Kind kind) const;
+
 	// The widest reading this kind can produce, used to pin the item's width.
 	// Without this every item reflows the whole run once a second and the bar
 	// visibly jitters while you stream.
@@ -91,13 +104,28 @@ public:
 	void resetCounters(Kind kind);
 
 signals:
-	void updated();
+	// Emitted for a kind only when what it displays has changed, in any of its
+	// forms, or when its alerting state has.
+	void updated(StreamUP::ToolbarStatus::Kind kind);
+
+	// Emitted once at the end of every sample, after any updated(), so
+	// something following several kinds can act on a whole tick at once.
+	void sampled();
 
 private:
 	Monitor();
 	~Monitor() override;
 
+	static constexpr int kKindCount = static_cast<int>(Kind::Message) + 1;
+
+	bool observed(Kind kind) const { return kindObservers_[static_cast<int>(kind)] > 0; }
+	int totalObservers() const;
+	void updateTimer();
 	void tick();
+	// Compares each observed kind's display key against the last one sent and
+	// emits updated() for those that moved.
+	void publishChanges();
+	quint64 displayKey(Kind kind) const;
 	void syncToRunningOutputs();
 	void handleFrontendEvent(enum obs_frontend_event event);
 	static void OnFrontendEvent(enum obs_frontend_event event, void *data);
@@ -145,10 +173,16 @@ private:
 	void setMessage(MessageId id);
 	QString messageText(MessageId id, bool compact) const;
 
-	int observers_ = 0;
+	int kindObservers_[kKindCount] = {};
+	int visibleObservers_ = 0;
+	quint64 publishedKeys_[kKindCount] = {};
+	bool published_[kKindCount] = {};
 	QTimer timer_;
 	os_cpu_usage_info_t *cpuInfo_ = nullptr;
 	bool eventCallbackAdded_ = false;
+	// Set at OBS_FRONTEND_EVENT_EXIT. Items are still shown, hidden and
+	// destroyed after it, and none of that may restart the timer.
+	bool exited_ = false;
 
 	double cpuPercent_ = 0.0;
 	double fps_ = 0.0;
@@ -161,10 +195,10 @@ private:
 	uint32_t skippedFrames_ = 0;
 	uint32_t encodedFrames_ = 0;
 	// The window the overload warning is judged over, so one bad second on a
-	// scene change does not light it up.
+	// scene change does not light it up. Zero start means no window is open.
 	uint32_t skippedAtWindowStart_ = 0;
 	uint32_t encodedAtWindowStart_ = 0;
-	int windowTicks_ = 0;
+	qint64 windowStartMs_ = 0;
 	bool overloaded_ = false;
 
 	Elapsed recordTime_;
@@ -199,14 +233,20 @@ public:
 protected:
 	// The theme sets the font, and it is not final until the widget has been
 	// polished, so the pinned width is taken once it is.
+	// Both also tell the Monitor whether this item is on screen.
 	void showEvent(QShowEvent *event) override;
+	void hideEvent(QHideEvent *event) override;
 	void changeEvent(QEvent *event) override;
 	// Right click offers to reset the counting readouts. Anything else is
 	// passed up so the toolbar's own menu still opens from a readout.
 	void contextMenuEvent(QContextMenuEvent *event) override;
+	// The tooltip is built when it is asked for: the readouts with a history
+	// add its last 10 seconds, minute and five minutes under their name.
+	bool event(QEvent *event) override;
 
 private:
 	void applyPinnedSize();
+	QString toolTipText() const;
 
 	Kind kind_;
 	bool vertical_;
@@ -214,6 +254,8 @@ private:
 	bool showHours_;
 	bool preview_ = false;
 	bool alerting_ = false;
+	// Whether this item is counted as on screen by the Monitor
+	bool onScreen_ = false;
 
 	// Current pinned width of the value. Only ever grows, so a clock passing an
 	// hour widens its slot once and nothing shrinks back a second later.
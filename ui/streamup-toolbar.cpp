@@ -4,6 +4,7 @@
 #include "dock/streamup-dock.hpp"
 #include "../video-capture-popup.hpp"
 #include "ui-helpers.hpp"
+#include "icon-cache.hpp"
 #include "settings-manager.hpp"
 #include "streamup-toolbar-builder.hpp"
 #include "streamup-toolbar-response-popover.hpp"
@@ -600,15 +601,11 @@ QString StreamUPToolbar::getThemedIconPath(const QString& iconName)
 
 QIcon StreamUPToolbar::getCachedIcon(const QString& iconName)
 {
-	// Always use the reliable UI helpers approach instead of caching
-	// This ensures consistent theming behavior between test and GitHub builds
+	// The path still follows the current theme on every call; the shared icon
+	// cache keys its images by SVG content, so a theme switch only swaps which
+	// pre-rendered set is handed out.
 	QString iconPath = StreamUP::UIHelpers::GetThemedIconPath(iconName);
-
-	// Debug logging to see what's happening
-	StreamUP::DebugLogger::LogDebugFormat("Toolbar", "Icon Debug", "Icon '%s' resolved to path: %s",
-		iconName.toUtf8().constData(), iconPath.toUtf8().constData());
-
-	return QIcon(iconPath);
+	return StreamUP::IconCache::Get(iconPath, iconSize());
 }
 
 void StreamUPToolbar::clearIconCache()
@@ -1070,7 +1067,7 @@ void StreamUPToolbar::updateToolbarSizeConstraints()
 
 StreamUP::SettingsManager::ToolbarAlignment StreamUPToolbar::currentAlignment() const
 {
-	return StreamUP::SettingsManager::GetCurrentSettings().toolbarAlignment;
+	return StreamUP::SettingsManager::GetSettingsSnapshot()->toolbarAlignment;
 }
 
 void StreamUPToolbar::refreshAlignment()
@@ -0,0 +1,83 @@
+#include "write-behind.hpp"
+
+#include <utility>
+
+namespace StreamUP {
+
+WriteBehind::WriteBehind(std::chrono::milliseconds settleDelay, Take take)
+	: settleDelay(settleDelay),
+	  take(std::move(take))
+{
+}
+
+WriteBehind::~WriteBehind()
+{
+	Stop();
+}
+
+bool WriteBehind::Queue(const std::function<void()> &store)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (stopped)
+		return false;
+
+	store();
+	pending = true;
+	if (!worker.joinable())
+		worker = std::thread(&WriteBehind::loop, this);
+	wake.notify_one();
+	return true;
+}
+
+void WriteBehind::Flush()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	if (!worker.joinable())
+		return;
+	++flushWaiters;
+	wake.notify_one();
+	idle.wait(lock, [this] { return !pending && !busy; });
+	--flushWaiters;
+}
+
+void WriteBehind::Stop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	stopped = true;
+	if (!worker.joinable())
+		return;
+	stopping = true;
+	wake.notify_one();
+	lock.unlock();
+
+	// The worker writes what is queued before it returns
+	worker.join();
+}
+
+void WriteBehind::loop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		wake.wait(lock, [this] { return stopping || pending; });
+		if (!pending && stopping)
+			return;
+
+		// Let the burst settle unless someone is waiting on it
+		wake.wait_for(lock, settleDelay, [this] { return flushWaiters > 0 || stopping; });
+
+		Work work = take();
+		pending = false;
+		busy = true;
+		lock.unlock();
+
+		if (work)
+			work();
+
+		lock.lock();
+		busy = false;
+		if (!pending)
+			idle.notify_all();
+	}
+}
+
+} // namespace StreamUP
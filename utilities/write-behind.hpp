@@ -0,0 +1,70 @@
+#ifndef STREAMUP_WRITE_BEHIND_HPP
+#define STREAMUP_WRITE_BEHIND_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace StreamUP {
+
+/**
+ * One worker thread that writes queued state to disk after a burst of changes
+ * has settled, for callers that save far more often than the file needs
+ * rewriting.
+ *
+ * The caller owns what is queued. Queue() runs a function under the writer's
+ * lock to record a write, typically replacing one still waiting. The worker
+ * waits out the settle delay, then calls the `take` function given at
+ * construction, also under the lock, which moves everything queued out and
+ * returns the work that writes it. That work runs with the lock released.
+ *
+ * Flush() waits until everything queued so far is written and cuts the settle
+ * delay short while it waits. Stop() writes what is queued and ends the
+ * worker. After that Queue() refuses and the caller writes inline.
+ *
+ * Queue, Flush and Stop are safe from any thread.
+ */
+class WriteBehind {
+public:
+	using Work = std::function<void()>;
+	using Take = std::function<Work()>;
+
+	WriteBehind(std::chrono::milliseconds settleDelay, Take take);
+	~WriteBehind();
+
+	WriteBehind(const WriteBehind &) = delete;
+	WriteBehind &operator=(const WriteBehind &) = delete;
+
+	/** Record a write with `store`, run under the lock. False, without running it, after Stop(). */
+	bool Queue(const std::function<void()> &store);
+
+	/** Wait until every write queued so far has finished. */
+	void Flush();
+
+	/** Write what is queued and stop the worker. Safe to call more than once. */
+	void Stop();
+
+private:
+	void loop();
+
+	const std::chrono::milliseconds settleDelay;
+	const Take take;
+
+	std::mutex mutex;
+	std::condition_variable wake; // worker: a write queued, a flush or a stop
+	std::condition_variable idle; // Flush(): nothing queued or in flight
+	std::thread worker;
+	bool pending = false;
+	bool busy = false;
+	// Counted rather than a flag, so the last waiter leaving clears it and a
+	// flush that found nothing to wait for cannot skip the next settle
+	int flushWaiters = 0;
+	bool stopping = false;
+	bool stopped = false;
+};
+
+} // namespace StreamUP
+
+#endif // STREAMUP_WRITE_BEHIND_HPP
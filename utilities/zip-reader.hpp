@@ -2,14 +2,17 @@
 #define STREAMUP_ZIP_READER_HPP
 
 #include <QByteArray>
+#include <QByteArrayView>
 #include <QFile>
-#include <QHash>
 #include <QString>
 #include <QStringList>
+#include <vector>
 
 namespace StreamUP {
 namespace Zip {
 
+struct DeepVerifyResult;
+
 /**
  * Minimal ZIP reader, the counterpart to Zip::Writer. Reads the central
  * directory up front, then extracts entries on demand (stored or deflated,
@@ -19,15 +22,21 @@ namespace Zip {
  * restore of a backup with collected media does not need the file to fit in
  * RAM. Every extraction is CRC-checked: a restore is the moment a corrupt
  * archive must be caught, not the moment it is discovered.
+ *
+ * The archive is memory-mapped and each entry is kept as a small record of
+ * offsets into the mapping, with its name left as raw UTF-8 until someone asks
+ * for it. A media-collected backup can hold 100k+ entries, and inspecting one
+ * should not mean building a QString and a hash node for every file in it.
  */
 class Reader {
 public:
 	struct Entry {
-		QString name;
 		quint64 compressedSize = 0;
 		quint64 uncompressedSize = 0;
 		quint64 localHeaderOffset = 0;
+		quint64 nameOffset = 0; // into the central directory view
 		quint32 crc = 0;
+		quint16 nameLength = 0;
 		quint16 method = 0;
 	};
 
@@ -37,9 +46,23 @@ public:
 	bool open(const QString &archivePath);
 	void close();
 
-	/** Every entry name in the archive, in central directory order. */
+	/**
+	 * Entries in central directory order. Iterate with entryCount() and
+	 * entryNameBytes(), which hands back a view into the mapping rather than a
+	 * copy; decode with entryName() only when the text is actually needed.
+	 */
+	int entryCount() const { return static_cast<int>(entries.size()); }
+	const Entry &entryAt(int i) const { return entries[static_cast<size_t>(i)]; }
+	QByteArrayView entryNameBytes(int i) const;
+	QString entryName(int i) const { return QString::fromUtf8(entryNameBytes(i)); }
+
+	/** Index of an entry by its UTF-8 name, or -1. */
+	int indexOf(QByteArrayView name) const;
+	int indexOf(const QString &name) const { return indexOf(QByteArrayView(name.toUtf8())); }
+
+	/** Every entry name in the archive, in central directory order. Copies; prefer the views above. */
 	QStringList entryNames() const;
-	bool contains(const QString &name) const { return index.contains(name); }
+	bool contains(const QString &name) const { return indexOf(name) >= 0; }
 	const Entry *entry(const QString &name) const;
 
 	/** Read a whole entry into memory. Use for the manifest and other small files. */
@@ -47,19 +70,70 @@ public:
 
 	/** Extract an entry to an absolute path, creating parent directories. */
 	bool extractTo(const QString &name, const QString &destinationPath);
+	bool extractTo(int index, const QString &destinationPath);
 
 	QString lastError() const { return error; }
 
 private:
+	friend DeepVerifyResult VerifyArchiveDeep(const QString &archivePath, int workerCount);
+
 	bool fail(const QString &reason);
 	bool readCentralDirectory();
+	void buildIndex();
+
+	/**
+	 * Inflate one entry from `in` and check its CRC, writing the data to `out`
+	 * when given. Takes the handle explicitly so deep verification can run one
+	 * per worker; extraction passes the reader's own.
+	 */
+	static bool streamEntry(QFile &in, const Entry &e, QByteArrayView name, QIODevice *out, QString *error,
+				quint64 *inflated = nullptr);
 
 	QFile file;
-	QList<Entry> entries;
-	QHash<QString, int> index;
+
+	// The whole archive when it maps, otherwise just the central directory
+	// read into `fallback`. Either way `view` starts at file offset viewOffset.
+	uchar *mapped = nullptr;
+	QByteArray fallback;
+	const char *view = nullptr;
+	qint64 viewOffset = 0;
+	qint64 viewSize = 0;
+
+	std::vector<Entry> entries;
+
+	// Open-addressing (linear probe) table of entry indices keyed on the name
+	// bytes, -1 for an empty slot. Sized to a power of two at least twice the
+	// entry count, so probes stay short and nothing is allocated per entry.
+	std::vector<qint32> indexSlots;
+
+	QString error;
+};
+
+/** Outcome of a deep verification pass. */
+struct DeepVerifyResult {
+	bool success = false;
+	int entriesChecked = 0;
+	int workers = 0;
+	qint64 bytesInflated = 0;
+	qint64 elapsedMs = 0;
+	QString firstCorruptEntry; // lowest central directory index that failed, empty when clean
 	QString error;
+
+	double megabytesPerSecond() const
+	{
+		return elapsedMs > 0 ? (bytesInflated / (1024.0 * 1024.0)) / (elapsedMs / 1000.0) : 0.0;
+	}
 };
 
+/**
+ * Deep counterpart to VerifyArchive: inflate every entry and check its CRC, the
+ * same work a restore does but without writing anything. Entries are shared out
+ * across a small pool of workers, each with its own file handle, so one large
+ * media file does not hold up the rest. Opt-in because it reads the whole
+ * archive; workerCount <= 0 picks a count from the machine.
+ */
+DeepVerifyResult VerifyArchiveDeep(const QString &archivePath, int workerCount = 0);
+
 } // namespace Zip
 } // namespace StreamUP
 